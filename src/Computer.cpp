@@ -1,6 +1,25 @@
 
+#include <algorithm>
+#include <fstream>
+#include <iterator>
 #include "Computer.h"
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CPU6502_MMAP_STATES
+#endif
+
+constexpr word Computer::STATE_VERSION;
+constexpr int Computer::CANCEL_SLICE;
+
+namespace {
+    const byte STATE_MAGIC[4] = {'6', '5', '0', '2'};
+    const std::size_t STATE_HEADER = 13; /// Magic, version and registers
+}
+
 Computer::Computer(word resetVector) : memory() {
     memory.writeWord(resetVector, CPU::RESET_ADRESS);
     this->cpu = CPU(memory);
@@ -16,7 +35,84 @@ void Computer::resetPC() {
 }
 
 int Computer::run(int cpuCycles) {
-    return cpu.execute(cpuCycles, memory);
+    return execute(cpuCycles).cycles;
+}
+
+CPU::Result Computer::execute(int cpuCycles) {
+    CPU::Budget budget;
+    budget.cycles = cpuCycles;
+    return execute(budget);
+}
+
+CPU::Result Computer::execute(const CPU::Budget &budget) {
+    const int cpuCycles = budget.cycles;
+    int executed = 0;
+    std::uint64_t instructions = 0;
+    CPU::Result stopped{CPU::Stop::Budget, 0, cpu.PC};
+    while (executed < cpuCycles && instructions < budget.instructions) {
+        scheduler.runDue(clock);
+        if (cancelRequested.exchange(false)) {
+            stopped = {CPU::Stop::Cancelled, 0, cpu.PC};
+            break;
+        }
+        if (nmiPending || (irqLine && !cpu.flag.I)) {
+            if (budget.exact && cpuCycles - executed < CPU::INTERRUPT_CYCLES) break;
+            const int taken = cpu.interrupt(nmiPending ? CPU::NMI_ADRESS : CPU::IRQ_ADRESS, memory);
+            nmiPending = false;
+            executed += taken;
+            clock += taken;
+            continue;
+        }
+        // Up to the next event, or the instruction clearing I while a masked IRQ waits
+        std::uint64_t cycles = std::min(cpuCycles - executed, CANCEL_SLICE);
+        cycles = std::min(cycles, scheduler.next() - clock);
+        // Only the last cycles of the budget stop exactly, the others end at the boundary past an event as usual
+        CPU::Budget chunk;
+        chunk.cycles = (int) cycles;
+        chunk.instructions = budget.instructions == UINT64_MAX ? UINT64_MAX : budget.instructions - instructions;
+        chunk.exact = budget.exact && chunk.cycles == cpuCycles - executed;
+        // Devices may acknowledge the IRQ during the run, the slice yields to it if I was cleared
+        const bool waiting = irqLine;
+        cpu.yieldOnUnmask = waiting;
+        stopped = runEngine(chunk);
+        cpu.yieldOnUnmask = false;
+        executed += stopped.cycles;
+        instructions += stopped.instructions;
+        clock += stopped.cycles;
+        // Short of the chunk: stopped or out of instructions, or the next instruction doesn't fit exactly
+        // (unless I was cleared for the IRQ waiting)
+        if (stopped.stop != CPU::Stop::Budget) break;
+        if (stopped.cycles < chunk.cycles && !(waiting && !cpu.flag.I)) break;
+    }
+    scheduler.runDue(clock);
+    CPU::Result result{stopped.stop, executed, stopped.stop == CPU::Stop::Budget ? cpu.PC : stopped.pc};
+    result.instructions = instructions;
+    return result;
+}
+
+void Computer::irq(bool asserted) {
+    irqLine = asserted;
+}
+
+void Computer::nmi() {
+    nmiPending = true;
+}
+
+void Computer::cancel() {
+    cancelRequested = true;
+}
+
+CPU::Result Computer::runEngine(const CPU::Budget &budget) {
+    if (budget.exact || budget.instructions != UINT64_MAX) return cpu.execute(budget, memory);
+    const int cpuCycles = budget.cycles;
+    switch (engine) {
+        case Engine::Decoded: return decodeCache.execute(cpu, cpuCycles, memory);
+        case Engine::Blocks: return blockCache.execute(cpu, cpuCycles, memory);
+        case Engine::Jit: return jit.execute(cpu, cpuCycles, memory);
+        case Engine::Tiered: return tiered.execute(cpu, cpuCycles, memory);
+        case Engine::Interpreter:
+        default: return cpu.execute(cpuCycles, memory);
+    }
 }
 
 void Computer::loadProgram(const byte *bytes, dword noBytes) {
@@ -27,3 +123,93 @@ void Computer::loadProgram(const byte *bytes, dword noBytes) {
         memory[resetVector + (i - 2)] = bytes[i];
     }
 }
+
+std::vector<byte> Computer::saveHeader() const {
+    const byte header[STATE_HEADER] = {STATE_MAGIC[0], STATE_MAGIC[1], STATE_MAGIC[2], STATE_MAGIC[3],
+                                       (byte) STATE_VERSION, (byte) (STATE_VERSION >> 8), (byte) cpu.PC, (byte) (cpu.PC >> 8),
+                                       cpu.SP, cpu.A, cpu.X, cpu.Y, cpu.status};
+    return std::vector<byte>(header, header + STATE_HEADER);
+}
+
+void Computer::loadHeader(const byte *header) {
+    cpu.PC = header[6] | (header[7] << 8);
+    cpu.SP = header[8];
+    cpu.A = header[9];
+    cpu.X = header[10];
+    cpu.Y = header[11];
+    cpu.status = header[12];
+}
+
+std::vector<byte> Computer::saveState() const {
+    std::vector<byte> state = saveHeader();
+    memory.save(state);
+    return state;
+}
+
+bool Computer::saveState(const std::string &path) const {
+    const std::vector<byte> state = saveState();
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(state.data()), (std::streamsize) state.size());
+    return (bool) file;
+}
+
+bool Computer::loadState(const byte *state, std::size_t size, std::shared_ptr<const void> storage) {
+    if (size < STATE_HEADER || !std::equal(STATE_MAGIC, STATE_MAGIC + sizeof STATE_MAGIC, state)) return false;
+    const word version = state[4] | (state[5] << 8);
+    if (version != STATE_VERSION) return false;
+    std::shared_ptr<const Memory::Image> image =
+            Memory::Image::view(state + STATE_HEADER, size - STATE_HEADER, std::move(storage));
+    if (!image) return false;
+
+    memory.load(std::move(image));
+    loadHeader(state);
+    return true;
+}
+
+bool Computer::loadState(const std::vector<byte> &state) {
+    std::shared_ptr<const std::vector<byte>> copy = std::make_shared<const std::vector<byte>>(state);
+    return loadState(copy->data(), copy->size(), copy);
+}
+
+bool Computer::loadState(const std::string &path) {
+#ifdef CPU6502_MMAP_STATES
+    const int file = open(path.c_str(), O_RDONLY);
+    if (file < 0) return false;
+    struct stat info;
+    if (fstat(file, &info) != 0 || info.st_size == 0) {
+        close(file);
+        return false;
+    }
+    const std::size_t size = info.st_size;
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (mapping == MAP_FAILED) return false;
+    std::shared_ptr<const void> storage(mapping, [size](void* bytes) { munmap(bytes, size); });
+    return loadState(static_cast<const byte*>(mapping), size, std::move(storage));
+#else
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    const std::vector<byte> state((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return loadState(state);
+#endif
+}
+
+Computer::Snapshot Computer::snapshot(const Snapshot *previous) const {
+    Snapshot snapshot;
+    snapshot.header = saveHeader();
+    snapshot.memory = memory.snapshot(previous ? previous->memory : nullptr);
+    snapshot.clock = clock;
+    snapshot.irqLine = irqLine;
+    snapshot.nmiPending = nmiPending;
+    snapshot.scheduler = scheduler;
+    return snapshot;
+}
+
+void Computer::restore(const Snapshot &snapshot) {
+    memory.load(snapshot.memory);
+    loadHeader(snapshot.header.data());
+    clock = snapshot.clock;
+    irqLine = snapshot.irqLine;
+    nmiPending = snapshot.nmiPending;
+    scheduler = snapshot.scheduler;
+}
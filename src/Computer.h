@@ -2,13 +2,45 @@
 #ifndef CPU6502_COMPUTER_H
 #define CPU6502_COMPUTER_H
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
 #include "memory/Memory.h"
 #include "cpu/CPU.h"
+#include "cpu/DecodeCache.h"
+#include "cpu/BlockCache.h"
+#include "cpu/Jit.h"
+#include "cpu/TieredEngine.h"
+#include "events/Scheduler.h"
+
+/// Default execution engine of every Computer (Interpreter, Decoded, Blocks, Jit or Tiered), overridable at compile time.
+#ifndef CPU6502_DEFAULT_ENGINE
+#define CPU6502_DEFAULT_ENGINE Tiered
+#endif
 
 class Computer {
 public:
+    /// @brief Execution engines behind run()
+    enum class Engine {
+        Interpreter, /// CPU::execute, with the cpu's dispatch
+        Decoded,     /// Pre-decoded instruction cache
+        Blocks,      /// Chained basic block cache
+        Jit,         /// Hot blocks compiled to x86-64 (block cache on other hosts)
+        Tiered,      /// Interpreter, block cache or Jit depending on how hot the code is
+    };
+
     Memory memory;
     CPU cpu;
+    Engine engine = Engine::CPU6502_DEFAULT_ENGINE; /// Engine used by run()
+    DecodeCache decodeCache;
+    BlockCache blockCache{decodeCache};
+    Jit jit{blockCache};
+    TieredEngine tiered{blockCache, jit};
+    std::uint64_t clock = 0; /// Cycles run since construction, only goes back when a Snapshot is restored
+    Scheduler scheduler;     /// Device events, run() fires them at the first instruction boundary at or past their time
 
     /// @brief Constructor.
     explicit Computer(word resetVector = 0x1000);
@@ -22,8 +54,91 @@ public:
     /// @brief Loads Program Given Onto Memory.
     void loadProgram(const byte* bytes, dword noBytes);
 
-    /// @brief Runs Program.
+    /** @brief Runs Program.
+     *  The engine runs up to the next scheduled event in one go, then the events due fire and pending
+     *  interrupts are taken (7 cycles each, counted in the cycles returned) before it carries on.
+     *  Stops early on opcodes without an implementation and on cancel(), without throwing.
+     *
+     *  @return Why it stopped, Cycles Executed and where (see CPU::execute)
+     */
+    CPU::Result execute(int cpuCycles);
+
+    /** @brief Runs Program within the budget given, like execute(int).
+     *  Instruction counts and exact stops are checked once per instruction on the cpu's budgeted execute
+     *  (interrupt sequences aren't instructions), plain cycle budgets run on the engine.
+     */
+    CPU::Result execute(const CPU::Budget& budget);
+
+    /// @brief Runs Program, execute() without the stop reason.
     int run(int cpuCycles);
+
+    /// @brief Makes the execute() running (or the next one) stop as Cancelled within CANCEL_SLICE cycles, from any thread.
+    void cancel();
+
+    /// Most cycles run between two checks of cancel()
+    static constexpr int CANCEL_SLICE = 0x10000;
+
+    /// @brief Sets the level of the IRQ line, taken between instructions for as long as it's asserted and I is clear.
+    void irq(bool asserted);
+
+    /// @brief Signals an NMI, taken once before the next instruction.
+    void nmi();
+
+    /** @brief Serializes the machine state: cpu registers and non-zero memory pages.
+     *  Little endian layout, version STATE_VERSION:
+     *  "6502" magic, version (2 bytes), PC (2 bytes), SP, A, X, Y, status, then Memory::save's pages.
+     *  Devices, scheduled events, interrupt lines, clock, engine and caches aren't part of it.
+     */
+    std::vector<byte> saveState() const;
+
+    /// @brief Writes saveState() to the file, false on failure.
+    bool saveState(const std::string& path) const;
+
+    /** @brief Restores a saveState(), false (leaving the computer untouched) if it isn't a valid one.
+     *  The memory pages are read in place from state, kept alive by storage, and copied on first write.
+     */
+    bool loadState(const byte* state, std::size_t size, std::shared_ptr<const void> storage);
+
+    /// @brief Restores a saveState() from a copy of it.
+    bool loadState(const std::vector<byte>& state);
+
+    /// @brief Restores a saveState() file, mapped into memory where possible so pages are never copied until written.
+    bool loadState(const std::string& path);
+
+    /// Version of the saveState() format
+    static constexpr word STATE_VERSION = 1;
+
+    /** @brief Machine state kept in memory to go back to: what saveState() keeps, plus the clock, the interrupt
+     *  lines and the scheduled events it leaves out. Devices aren't part of it, events that fired after it was taken
+     *  fire again once it is restored (against the devices as they are then).
+     */
+    struct Snapshot {
+        std::vector<byte> header;                    /// saveState()'s header: magic, version and registers
+        std::shared_ptr<const Memory::Image> memory; /// Shares the pages that didn't change with the snapshot it was taken after
+        std::uint64_t clock = 0;
+        bool irqLine = false;
+        bool nmiPending = false;
+        Scheduler scheduler;
+    };
+
+    /// @brief Snapshot of the machine as it is, sharing the memory pages of previous (if any) that didn't change.
+    Snapshot snapshot(const Snapshot* previous) const;
+
+    /// @brief Puts the machine back in the state of the snapshot, clock included (marks every memory page dirty).
+    void restore(const Snapshot& snapshot);
+private:
+    bool irqLine = false;
+    bool nmiPending = false;
+    std::atomic<bool> cancelRequested{false};
+
+    /// @brief Runs the selected engine.
+    CPU::Result runEngine(const CPU::Budget& budget);
+
+    /// @brief saveState()'s header: magic, version and registers.
+    std::vector<byte> saveHeader() const;
+
+    /// @brief Sets the registers from a saveState() header already checked.
+    void loadHeader(const byte* header);
 };
 
 
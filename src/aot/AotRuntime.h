@@ -0,0 +1,49 @@
+
+#ifndef CPU6502_AOTRUNTIME_H
+#define CPU6502_AOTRUNTIME_H
+
+#include "../cpu/CPU.h"
+#include "../cpu/Opcodes.h"
+#include "../cpu/Operations.h"
+#include "../memory/Memory.h"
+#include "../types.h"
+
+/** @brief Helpers the code generated by StaticRecompiler is written with, along with the operations it
+ *  shares with CPU::execute (Operations.h). Cycle costs are charged by the generated code.
+ *  The flags are written eagerly, so the status register is up to date with and without lazy flags.
+ */
+
+/// @brief Sets N and Z from the value assigned.
+inline void aotAssign(CPU& cpu, byte value) {
+    cpu.status = (cpu.status & ~(CPU::FLAG_N | CPU::FLAG_Z)) | assignmentFlags(value);
+}
+
+/// @brief Indexed address, charging a cycle when a page boundary is crossed.
+inline word aotIndexed(word address, byte offset, int& cycles) {
+    word final = address + offset;
+    if ((final & 0x0100) != (address & 0x0100)) cycles--;
+    return final;
+}
+
+inline void aotPush(CPU& cpu, Memory& memory, byte value) {
+    memory.write(cpu._SPaddress, value);
+    cpu.SP--;
+}
+
+inline void aotPushWord(CPU& cpu, Memory& memory, word value) {
+    memory.writeWord(value, cpu._SPaddress - 1);
+    cpu.SP -= 2;
+}
+
+inline byte aotPull(CPU& cpu, const Memory& memory) {
+    cpu.SP++;
+    return memory[cpu._SPaddress];
+}
+
+inline word aotPullWord(CPU& cpu, const Memory& memory) {
+    cpu.SP += 2;
+    return memory.readWord(cpu._SPaddress - 1);
+}
+
+
+#endif //CPU6502_AOTRUNTIME_H
@@ -0,0 +1,267 @@
+#include "StaticRecompiler.h"
+#include <algorithm>
+#include <cstdio>
+#include <set>
+#include "../cpu/CPU.h"
+#include "../cpu/Opcodes.h"
+#include "../cpu/Operations.h"
+#include "../cpu/Disassembler.h"
+
+namespace {
+    std::string hex(dword value, int digits) {
+        char text[8];
+        snprintf(text, sizeof text, "0x%0*X", digits, value);
+        return text;
+    }
+
+    std::string label(word address) {
+        char text[16];
+        snprintf(text, sizeof text, "block%04X", address);
+        return text;
+    }
+
+    /// @brief Address accessed by the operand, charging page crossings when penalty is set.
+    std::string addressOf(AddressingMode mode, word operand, bool penalty) {
+        using M = AddressingMode;
+        const std::string zp = hex(operand & 0xFF, 2), abs = hex(operand, 4);
+        switch (mode) {
+            case M::ZeroPage:  return zp;
+            case M::ZeroPageX: return "(byte) (" + zp + " + cpu.X)";
+            case M::ZeroPageY: return "(byte) (" + zp + " + cpu.Y)";
+            case M::Absolute:  return abs;
+            case M::AbsoluteX: return penalty ? "aotIndexed(" + abs + ", cpu.X, cycles)" : "(word) (" + abs + " + cpu.X)";
+            case M::AbsoluteY: return penalty ? "aotIndexed(" + abs + ", cpu.Y, cycles)" : "(word) (" + abs + " + cpu.Y)";
+            case M::IndirectX: return "rom.readWord((byte) (" + zp + " + cpu.X))";
+            case M::IndirectY: return penalty ? "aotIndexed(rom.readWord(" + zp + "), cpu.Y, cycles)"
+                                              : "(word) (rom.readWord(" + zp + ") + cpu.Y)";
+            default: return abs;
+        }
+    }
+
+    std::string valueOf(const OpcodeInfo& info, word operand) {
+        if (info.mode == AddressingMode::Immediate) return hex(operand & 0xFF, 2);
+        return "rom[" + addressOf(info.mode, operand, info.pageCrossCycles > 0) + "]";
+    }
+
+    /// @brief Operation as written in C++ (Operation::Adc).
+    std::string operationOf(const OpcodeInfo& info) {
+        std::string name = info.mnemonic;
+        std::transform(name.begin() + 1, name.end(), name.begin() + 1, [](char c) { return (char) (c - 'A' + 'a'); });
+        return "Operation::" + name;
+    }
+
+    std::string registerOf(Register reg) {
+        switch (reg) {
+            case Register::X: return "cpu.X";
+            case Register::Y: return "cpu.Y";
+            case Register::SP: return "cpu.SP";
+            default: return "cpu.A";
+        }
+    }
+
+    /// @brief Condition under which the branch given is taken.
+    std::string branchCondition(const OpcodeInfo& info) {
+        return "branchTaken(" + operationOf(info) + ", (cpu.status & " + hex(info.flagsRead, 2) + ") != 0)";
+    }
+
+    /// @brief Statements of an instruction that doesn't change the flow, written with the helpers of Operations.h.
+    std::string statements(const OpcodeInfo& info, byte opcode, word operand) {
+        using O = Operation;
+        const std::string operation = operationOf(info);
+        switch (info.operation) {
+            case O::Lda: case O::Ldx: case O::Ldy: {
+                const std::string target = registerOf(targetOf(info.operation));
+                return target + " = " + valueOf(info, operand) + "; aotAssign(cpu, " + target + ");";
+            }
+            case O::Sta: case O::Stx: case O::Sty:
+                return "memory.write(" + addressOf(info.mode, operand, false) + ", " + registerOf(sourceOf(info.operation)) + ");";
+            case O::And: case O::Eor: case O::Ora: case O::Adc:
+                return "cpu.A = accumulate(" + operation + ", cpu.A, " + valueOf(info, operand) + ", cpu.status); aotAssign(cpu, cpu.A);";
+            case O::Bit: return "bitTest(cpu.A, " + valueOf(info, operand) + ", cpu.status);";
+            case O::Inc: case O::Dec:
+                return "{ const word address = " + addressOf(info.mode, operand, false) + "; const byte value = step("
+                       + operation + ", rom[address]); memory.write(address, value); aotAssign(cpu, value); }";
+            case O::Inx: case O::Iny: case O::Dex: case O::Dey: {
+                const std::string target = registerOf(targetOf(info.operation));
+                return target + " = step(" + operation + ", " + target + "); aotAssign(cpu, " + target + ");";
+            }
+            case O::Tax: case O::Txa: case O::Tay: case O::Tya: case O::Tsx: case O::Txs: {
+                const std::string target = registerOf(targetOf(info.operation));
+                const std::string assign = target + " = " + registerOf(sourceOf(info.operation)) + ";";
+                return info.flagsWritten ? assign + " aotAssign(cpu, " + target + ");" : assign;
+            }
+            case O::Clc: case O::Cld: case O::Cli: case O::Clv: case O::Sec: case O::Sed: case O::Sei:
+                return "cpu.status = changeFlag(opcodeTable[" + hex(opcode, 2) + "], cpu.status);";
+            case O::Pha: return "aotPush(cpu, memory, cpu.A);";
+            case O::Php: return "aotPush(cpu, memory, pushedStatus(cpu.status));";
+            case O::Pla: return "cpu.A = aotPull(cpu, rom);";
+            case O::Plp: return "cpu.status = pulledStatus(cpu.status, aotPull(cpu, rom));";
+            default: return "";
+        }
+    }
+}
+
+StaticRecompiler::StaticRecompiler(const byte *image, dword noBytes) {
+    if (image == nullptr || noBytes < 2) return;
+    origin = image[0] + ((word) image[1] << 8);
+    limit = std::min<dword>(origin + (noBytes - 2), 0x10000);
+    for (dword address = origin; address < limit; address++) {
+        memory[address] = image[2 + address - origin];
+    }
+    discover();
+}
+
+const std::vector<StaticRecompiler::Block> &StaticRecompiler::blocks() const {
+    return discovered;
+}
+
+bool StaticRecompiler::inImage(word address, byte length) const {
+    return address >= origin && address + length <= limit;
+}
+
+void StaticRecompiler::discover() {
+    const Memory& image = memory;
+    std::set<word> leaders;
+    std::vector<word> pending;
+    std::vector<bool> seen(0x10000, false);
+    auto enter = [&](word address) {
+        if (!inImage(address, 1)) return;
+        leaders.insert(address);
+        pending.push_back(address);
+    };
+
+    // Recursive traversal, the targets of indirect jumps are left to the interpreter
+    enter(origin);
+    while (!pending.empty()) {
+        word address = pending.back();
+        pending.pop_back();
+        while (!seen[address]) {
+            const byte opcode = image[address];
+            const OpcodeInfo& info = opcodeTable[opcode];
+            const byte length = instructionLength(info.mode);
+            if (!info.isLegal() || !inImage(address, length)) break;
+            seen[address] = true;
+            const word next = address + length;
+            if (info.mode == AddressingMode::Relative) {
+                enter(next + (sbyte) image[address + 1]);
+                enter(next);
+                break;
+            }
+            if (opcode == CPU::jmpAbs || opcode == CPU::jsrAbs) {
+                enter(image.readWord(address + 1));
+                if (opcode == CPU::jsrAbs) enter(next);
+                break;
+            }
+            if (info.changesFlow) break;
+            address = next;
+        }
+    }
+
+    // Blocks run from every leader up to the first flow change or the next leader
+    for (word start : leaders) {
+        Block block;
+        block.start = start;
+        word address = start;
+        for (;;) {
+            const OpcodeInfo& info = opcodeTable[image[address]];
+            const byte length = instructionLength(info.mode);
+            if (!info.isLegal() || !inImage(address, length)) break;
+            block.instructions.push_back(address);
+            block.worstCycles += info.cycles + info.pageCrossCycles;
+            address += length;
+            if (info.changesFlow || leaders.count(address)) break;
+        }
+        if (block.instructions.empty()) continue;
+        block.end = address;
+        const OpcodeInfo& last = opcodeTable[image[block.instructions.back()]];
+        block.worstCycles -= last.cycles + last.pageCrossCycles;
+        discovered.push_back(block);
+    }
+}
+
+std::string StaticRecompiler::translate(const Block &block) const {
+    const Memory& image = memory;
+    std::string body;
+    bool loops = false;
+    // Jumps back to the start of the block loop within it while the budget allows the whole block
+    auto jumpTo = [&](word target) {
+        if (target == block.start) {
+            loops = true;
+            return "if (cycles > " + std::to_string(block.worstCycles) + ") goto entry; cpu.PC = " + hex(target, 4) + "; return;";
+        }
+        return "cpu.PC = " + hex(target, 4) + "; return;";
+    };
+
+    for (word address : block.instructions) {
+        const byte opcode = image[address];
+        const OpcodeInfo& info = opcodeTable[opcode];
+        const word next = address + instructionLength(info.mode);
+        const word operand = info.mode == AddressingMode::Implied ? 0
+                           : instructionLength(info.mode) == 2 ? image[address + 1] : image.readWord(address + 1);
+        std::string code = "cycles -= " + std::to_string(info.cycles) + ";";
+        if (info.mode == AddressingMode::Relative) {
+            const word target = next + (sbyte) operand;
+            const int taken = 1 + (((target & 0x0100) != (next & 0x0100)) ? 1 : 0);
+            code += " if (" + branchCondition(info) + ") { cycles -= " + std::to_string(taken) + "; "
+                    + jumpTo(target) + " } " + jumpTo(next);
+        } else if (opcode == CPU::jmpAbs) {
+            code += " " + jumpTo(operand);
+        } else if (opcode == CPU::jmpInd) {
+            code += " cpu.PC = rom.readWord(" + hex(operand, 4) + "); return;";
+        } else if (opcode == CPU::jsrAbs) {
+            code += " aotPushWord(cpu, memory, " + hex((word) (next - 1), 4) + "); " + jumpTo(operand);
+        } else if (opcode == CPU::rtsImp) {
+            code += " cpu.PC = aotPullWord(cpu, rom) + 1; return;";
+        } else if (opcode == CPU::rtiImp) {
+            code += " cpu.status = pulledStatus(cpu.status, aotPull(cpu, rom)); cpu.PC = aotPullWord(cpu, rom); return;";
+        } else {
+            const std::string effect = statements(info, opcode, operand);
+            if (!effect.empty()) code += " " + effect;
+        }
+        body += "    " + code + " // $" + hex(address, 4).substr(2) + ": " + disassemble(image, address) + "\n";
+    }
+    if (!opcodeTable[image[block.instructions.back()]].changesFlow) {
+        body += "    cpu.PC = " + hex(block.end, 4) + ";\n";
+    }
+
+    // Blocks without memory operands leave the parameter unnamed, so the output compiles warning clean
+    const bool readsMemory = body.find("rom") != std::string::npos;
+    const bool usesMemory = readsMemory || body.find("memory") != std::string::npos;
+    std::string function = "void " + label(block.start) + "(CPU& cpu, int& cycles, Memory&"
+                           + (usesMemory ? " memory" : "") + ") {\n";
+    if (readsMemory) function += "    const Memory& rom = memory;\n";
+    if (loops) function += "entry:\n";
+    return function + body + "}\n";
+}
+
+std::string StaticRecompiler::translate() const {
+    std::string source;
+    char header[128];
+    snprintf(header, sizeof header, "// Generated by cpu6502-aot from %u bytes at $%04X, do not edit.\n",
+             limit - origin, origin);
+    source += header;
+    source += "#include \"" + runtimeHeader + "\"\n\n";
+    source += "namespace {\n\n";
+    for (const Block& block : discovered) {
+        source += translate(block) + "\n";
+    }
+    source += "}\n\n";
+    source += "CPU::Result " + functionName + "(CPU& cpu, int cycles, Memory& memory) {\n";
+    source += "    int remaining = cycles;\n";
+    source += "    while (remaining > 0) {\n";
+    source += "        switch (cpu.PC) {\n";
+    for (const Block& block : discovered) {
+        source += "            case " + hex(block.start, 4) + ": if (remaining > " + std::to_string(block.worstCycles)
+                  + ") { " + label(block.start) + "(cpu, remaining, memory); continue; } break;\n";
+    }
+    source += "            default: break;\n";
+    source += "        }\n";
+    source += "        // Not discovered ahead of time, or the block could outlast the budget\n";
+    source += "        const CPU::Result step = cpu.execute(1, memory);\n";
+    source += "        remaining -= step.cycles;\n";
+    source += "        if (step.stop != CPU::Stop::Budget) return {step.stop, cycles - remaining, step.pc};\n";
+    source += "    }\n";
+    source += "    return {CPU::Stop::Budget, cycles - remaining, cpu.PC};\n";
+    source += "}\n";
+    return source;
+}
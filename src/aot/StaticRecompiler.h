@@ -0,0 +1,53 @@
+
+#ifndef CPU6502_STATICRECOMPILER_H
+#define CPU6502_STATICRECOMPILER_H
+
+#include <string>
+#include <vector>
+#include "../memory/Memory.h"
+#include "../types.h"
+
+/** @brief Ahead of time recompiler translating a program image into C++ source.
+ *  The image is in the format Computer::loadProgram takes (reset vector followed by the bytes). Code is
+ *  discovered from the reset vector by following branches, jumps and calls, and every block found becomes
+ *  a C++ function with the semantics and cycle costs of CPU::execute. The generated run function
+ *  dispatches on PC and falls back to CPU::execute for targets that weren't discovered (indirect jumps,
+ *  code outside the image) and for blocks that could outlast the budget.
+ *  The image is treated as ROM: code that writes over its own instructions isn't supported.
+ */
+class StaticRecompiler {
+public:
+    struct Block {
+        word start;
+        word end;                       /// Address past the last instruction
+        int worstCycles = 0;            /// Most cycles the block takes before its last instruction
+        std::vector<word> instructions; /// Address of every instruction
+    };
+
+    std::string functionName = "runRecompiled"; /// Name of the generated run function
+    std::string runtimeHeader = "AotRuntime.h"; /// Include path of AotRuntime.h from the generated file
+
+    /// @brief Loads the image and discovers its code from the reset vector.
+    StaticRecompiler(const byte* image, dword noBytes);
+
+    /// @brief Blocks discovered, sorted by address.
+    const std::vector<Block>& blocks() const;
+
+    /** @brief Generates the C++ translation unit.
+     *  It defines `CPU::Result functionName(CPU& cpu, int cycles, Memory& memory)` with the contract of
+     *  CPU::execute, to be run on a memory the same image was loaded into.
+     */
+    std::string translate() const;
+private:
+    Memory memory;
+    word origin = 0;
+    dword limit = 0; /// Address past the end of the image
+    std::vector<Block> discovered;
+
+    bool inImage(word address, byte length) const;
+    void discover();
+    std::string translate(const Block& block) const;
+};
+
+
+#endif //CPU6502_STATICRECOMPILER_H
@@ -0,0 +1,38 @@
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+#include "StaticRecompiler.h"
+
+/** @brief cpu6502-aot <image> <output.cpp> [function name] [runtime header]
+ *  Recompiles a program image (reset vector followed by the bytes, as Computer::loadProgram takes)
+ *  into a C++ source file to be built along with the emulator.
+ */
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <image> <output.cpp> [function name] [runtime header]" << std::endl;
+        return 1;
+    }
+    std::ifstream input(argv[1], std::ios::binary);
+    if (!input) {
+        std::cerr << "Can't read " << argv[1] << std::endl;
+        return 1;
+    }
+    const std::vector<char> bytes((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    if (bytes.size() < 2) {
+        std::cerr << argv[1] << " has no reset vector" << std::endl;
+        return 1;
+    }
+
+    StaticRecompiler recompiler(reinterpret_cast<const byte*>(bytes.data()), bytes.size());
+    if (argc > 3) recompiler.functionName = argv[3];
+    if (argc > 4) recompiler.runtimeHeader = argv[4];
+    std::ofstream output(argv[2], std::ios::binary);
+    output << recompiler.translate();
+    if (!output) {
+        std::cerr << "Can't write " << argv[2] << std::endl;
+        return 1;
+    }
+    std::cout << recompiler.blocks().size() << " blocks recompiled to " << argv[2] << std::endl;
+    return 0;
+}
@@ -0,0 +1,55 @@
+#include "BatchRunner.h"
+
+BatchRunner::BatchRunner(unsigned threads) : pool(threads) {
+    for (unsigned worker = 0; worker < pool.size(); worker++) {
+        computers.emplace_back(new Computer());
+    }
+}
+
+unsigned BatchRunner::size() const {
+    return pool.size();
+}
+
+std::vector<BatchRunner::Result> BatchRunner::run(const std::vector<Job> &jobs) {
+    std::vector<Result> results(jobs.size());
+    for (std::unique_ptr<Computer>& computer : computers) {
+        computer->engine = engine;
+    }
+    pool.run(jobs.size(), [&](unsigned worker, std::size_t index) {
+        results[index] = run(jobs[index], *computers[worker]);
+    });
+    return results;
+}
+
+BatchRunner::Result BatchRunner::run(const Job &job, Computer &computer) {
+    // Same memory as a new Computer, whichever job ran on it before
+    computer.reset();
+    computer.memory.writeWord(0x0000, 0xFFFA);
+    computer.memory.writeWord(0x1000, CPU::RESET_ADRESS); // Computer's default reset vector
+    computer.memory.writeWord(0x0000, 0xFFFE);
+    computer.loadProgram(job.image, job.noBytes);
+
+    CPU& cpu = computer.cpu;
+    cpu.PC = job.resetPC ? computer.memory.readWord(CPU::RESET_ADRESS) : job.registers.PC;
+    cpu.SP = job.registers.SP;
+    cpu.A = job.registers.A;
+    cpu.X = job.registers.X;
+    cpu.Y = job.registers.Y;
+    cpu.status = job.registers.status & CPU::STATUS_MASK;
+
+    Result result;
+    const CPU::Result run = computer.execute(job.cycles);
+    result.cycles = run.cycles;
+    result.failed = run.stop != CPU::Stop::Budget;
+    result.registers = {cpu.PC, cpu.SP, cpu.A, cpu.X, cpu.Y, cpu.status};
+    result.digest = digest(computer.memory);
+    return result;
+}
+
+std::uint64_t BatchRunner::digest(const Memory &memory) {
+    std::uint64_t hash = 0xCBF29CE484222325u;
+    for (dword address = 0; address <= 0xFFFF; address++) {
+        hash = (hash ^ memory[address]) * 0x100000001B3u;
+    }
+    return hash;
+}
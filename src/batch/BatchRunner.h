@@ -0,0 +1,65 @@
+
+#ifndef CPU6502_BATCHRUNNER_H
+#define CPU6502_BATCHRUNNER_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "WorkStealingPool.h"
+#include "../Computer.h"
+#include "../memory/Memory.h"
+#include "../types.h"
+
+/** @brief Runs many independent programs across every core.
+ *  Each worker thread owns one Computer and runs the jobs it takes on it from a fresh memory, so nothing
+ *  mutable is shared while a job runs and the results don't depend on how the jobs were scheduled.
+ */
+class BatchRunner {
+public:
+    struct Registers {
+        word PC = 0;
+        byte SP = 0xFF;
+        byte A = 0x00;
+        byte X = 0x00;
+        byte Y = 0x00;
+        byte status = 0x00;
+    };
+
+    struct Job {
+        const byte* image = nullptr; /// Computer::loadProgram format, owned by the caller until run() returns
+        dword noBytes = 0;
+        Registers registers;         /// Initial registers
+        bool resetPC = true;         /// Start at the reset vector of the image instead of registers.PC
+        int cycles = 0;              /// Cycle budget
+    };
+
+    struct Result {
+        Registers registers;         /// Final registers
+        int cycles = 0;              /// Cycles executed
+        std::uint64_t digest = 0;    /// Digest of the final memory (see digest())
+        bool failed = false;         /// Stopped on an opcode without an implementation (see CPU::Stop)
+    };
+
+    Computer::Engine engine = Computer::Engine::CPU6502_DEFAULT_ENGINE; /// Engine every job runs on
+
+    /// @brief Starts the workers given (0: one per hardware thread).
+    explicit BatchRunner(unsigned threads = 0);
+
+    /// @brief Number of worker threads.
+    unsigned size() const;
+
+    /// @brief Runs every job, the results are in the order of the jobs.
+    std::vector<Result> run(const std::vector<Job>& jobs);
+
+    /// @brief Runs a job on the computer given, as run() does on each worker.
+    static Result run(const Job& job, Computer& computer);
+
+    /// @brief FNV-1a digest of the whole memory.
+    static std::uint64_t digest(const Memory& memory);
+private:
+    WorkStealingPool pool;
+    std::vector<std::unique_ptr<Computer>> computers; /// One per worker
+};
+
+
+#endif //CPU6502_BATCHRUNNER_H
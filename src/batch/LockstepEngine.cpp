@@ -0,0 +1,399 @@
+#include "LockstepEngine.h"
+#include <algorithm>
+#include <cstring>
+#include "../cpu/Opcodes.h"
+#include "../cpu/Operations.h"
+
+#ifdef CPU6502_LOCKSTEP_AVX512
+// GCC 12 warns about the undefined vectors its own intrinsics start from
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#include <immintrin.h>
+#pragma GCC diagnostic pop
+#endif
+
+namespace {
+    constexpr dword LANE_BYTES = 0x10000;
+}
+
+bool LockstepEngine::isSupported() {
+#ifdef CPU6502_LOCKSTEP_AVX512
+    return !CPU::STATS && !CPU::TRACE && __builtin_cpu_supports("avx512f");
+#else
+    return false;
+#endif
+}
+
+bool LockstepEngine::fitsLane(const Computer &computer) {
+    if (computer.cpu.staticCycles) return false;
+    for (dword page = 0; page < 0x100; page++) {
+        if (computer.memory.isMapped(page)) return false;
+    }
+    return true;
+}
+
+std::vector<CPU::Result> LockstepEngine::execute(const std::vector<Computer*> &computers, int cycles) {
+    std::vector<CPU::Result> results(computers.size(), CPU::Result{CPU::Stop::Budget, 0, 0});
+    // The computers that can't run as lanes run on their cpu
+    std::vector<Computer*> lanes;
+    std::vector<CPU::Result*> laneResults;
+    const bool vectors = isSupported();
+    for (std::size_t index = 0; index < computers.size(); index++) {
+        Computer& computer = *computers[index];
+        if (vectors && fitsLane(computer)) {
+            lanes.push_back(&computer);
+            laneResults.push_back(&results[index]);
+        } else {
+            results[index] = computer.cpu.execute(cycles, computer.memory);
+        }
+    }
+    for (std::size_t first = 0; first < lanes.size(); first += LANES) {
+        load(&lanes[first], std::min<std::size_t>(LANES, lanes.size() - first), cycles);
+        run();
+        store(&lanes[first], &laneResults[first], cycles);
+    }
+    return results;
+}
+
+void LockstepEngine::load(Computer* const* computers, unsigned lanes, int cycles) {
+    count = lanes;
+    image.resize(LANES * LANE_BYTES + 4);
+    for (unsigned lane = 0; lane < LANES; lane++) {
+        // Unused lanes have no cycles, they never run
+        const bool used = lane < lanes;
+        const CPU& cpu = computers[used ? lane : 0]->cpu;
+        PC[lane] = cpu.PC;
+        A[lane] = cpu.A;
+        X[lane] = cpu.X;
+        Y[lane] = cpu.Y;
+        SP[lane] = cpu.SP;
+        P[lane] = cpu.status;
+        remaining[lane] = used ? cycles : 0;
+        stop[lane] = CPU::Stop::Budget;
+        stopPC[lane] = 0;
+        std::fill(written[lane], written[lane] + 4, 0);
+        if (!used) continue;
+        byte* bytes = &image[lane * LANE_BYTES];
+        for (dword page = 0; page < 0x100; page++) computers[lane]->memory.readPage(page, bytes + page * 0x100);
+    }
+    for (dword page = 0; page < 0x100; page++) {
+        shared[page] = true;
+        for (unsigned lane = 1; lane < lanes && shared[page]; lane++) {
+            shared[page] = std::memcmp(&image[page * 0x100], &image[lane * LANE_BYTES + page * 0x100], 0x100) == 0;
+        }
+    }
+}
+
+void LockstepEngine::store(Computer* const* computers, CPU::Result* const* results, int cycles) {
+    for (unsigned lane = 0; lane < count; lane++) {
+        CPU& cpu = computers[lane]->cpu;
+        cpu.PC = PC[lane];
+        cpu.A = A[lane];
+        cpu.X = X[lane];
+        cpu.Y = Y[lane];
+        cpu.SP = SP[lane];
+        cpu.status = P[lane];
+        CPU::Result& result = *results[lane];
+        result.stop = stop[lane];
+        result.cycles = cycles - remaining[lane];
+        result.pc = stop[lane] == CPU::Stop::Budget ? cpu.PC : stopPC[lane];
+        const byte* bytes = &image[lane * LANE_BYTES];
+        for (dword page = 0; page < 0x100; page++) {
+            if (written[lane][page >> 6] >> (page & 63) & 1) computers[lane]->memory.writePage(page, bytes + page * 0x100);
+        }
+    }
+}
+
+void LockstepEngine::write(unsigned lanes, const std::int32_t *addresses, const std::int32_t *values) {
+    for (unsigned lane = 0; lane < LANES; lane++) {
+        if (!(lanes >> lane & 1)) continue;
+        const word address = addresses[lane];
+        image[lane * LANE_BYTES + address] = values[lane];
+        written[lane][address >> 14] |= 1ull << (address >> 8 & 63);
+        shared[address >> 8] = false;
+    }
+}
+
+#ifdef CPU6502_LOCKSTEP_AVX512
+
+namespace {
+    using Lanes = __mmask16;
+
+    CPU6502_AVX512_FUNCTION inline __m512i splat(int value) {
+        return _mm512_set1_epi32(value);
+    }
+
+    /// @brief Bytes at the addresses of the lanes given (0 in the others), offsets being where each lane's memory starts.
+    CPU6502_AVX512_FUNCTION inline __m512i gatherByte(Lanes lanes, __m512i offsets, __m512i addresses, const byte* image) {
+        const __m512i bytes = _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), lanes,
+                                                          _mm512_add_epi32(offsets, addresses), image, 1);
+        return _mm512_and_epi32(bytes, splat(0xFF));
+    }
+
+    /// @brief Words at the addresses of the lanes given, as Memory::readWord reads them ($FFFF wraps to $0000).
+    CPU6502_AVX512_FUNCTION inline __m512i gatherWord(Lanes lanes, __m512i offsets, __m512i addresses, const byte* image) {
+        const __m512i bytes = _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), lanes,
+                                                          _mm512_add_epi32(offsets, addresses), image, 1);
+        const Lanes wrapping = _mm512_mask_cmpeq_epi32_mask(lanes, addresses, splat(0xFFFF));
+        if (!wrapping) return _mm512_and_epi32(bytes, splat(0xFFFF));
+        const __m512i high = gatherByte(wrapping, offsets, _mm512_setzero_si512(), image);
+        return _mm512_mask_or_epi32(_mm512_and_epi32(bytes, splat(0xFFFF)), wrapping,
+                                    _mm512_and_epi32(bytes, splat(0xFF)), _mm512_slli_epi32(high, 8));
+    }
+
+    /// @brief Status with N and Z set from the values assigned.
+    CPU6502_AVX512_FUNCTION inline __m512i assign(__m512i status, __m512i values) {
+        const __m512i flags = _mm512_or_epi32(_mm512_andnot_epi32(splat(CPU::FLAG_N | CPU::FLAG_Z), status),
+                                              _mm512_and_epi32(values, splat(CPU::FLAG_N)));
+        return _mm512_mask_or_epi32(flags, _mm512_cmpeq_epi32_mask(values, _mm512_setzero_si512()), flags,
+                                    splat(CPU::FLAG_Z));
+    }
+
+    /// @brief Lowest of the values in the lanes given.
+    CPU6502_AVX512_FUNCTION inline dword lowest(Lanes lanes, __m512i values) {
+        __m512i low = _mm512_mask_mov_epi32(splat(-1), lanes, values);
+        low = _mm512_min_epu32(low, _mm512_shuffle_i32x4(low, low, 0x4E));
+        low = _mm512_min_epu32(low, _mm512_shuffle_i32x4(low, low, 0xB1));
+        low = _mm512_min_epu32(low, _mm512_shuffle_epi32(low, _MM_PERM_BADC));
+        low = _mm512_min_epu32(low, _mm512_shuffle_epi32(low, _MM_PERM_CDAB));
+        return (dword) _mm_cvtsi128_si32(_mm512_castsi512_si128(low));
+    }
+}
+
+CPU6502_AVX512_FUNCTION void LockstepEngine::run() {
+    using M = AddressingMode;
+    using O = Operation;
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i offsets = _mm512_slli_epi32(_mm512_set_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0), 16);
+    const byte* memory = image.data();
+    __m512i pc = _mm512_loadu_si512(PC);
+    __m512i a = _mm512_loadu_si512(A);
+    __m512i x = _mm512_loadu_si512(X);
+    __m512i y = _mm512_loadu_si512(Y);
+    __m512i sp = _mm512_loadu_si512(SP);
+    __m512i p = _mm512_loadu_si512(P);
+    __m512i left = _mm512_loadu_si512(remaining);
+    Lanes running = (Lanes) ((1u << count) - 1);
+    alignas(64) std::int32_t addresses[LANES];
+    alignas(64) std::int32_t values[LANES];
+
+    for (;;) {
+        const Lanes active = _mm512_mask_cmpgt_epi32_mask(running, left, zero);
+        if (!active) break;
+        // Lowest PC first, so lanes that left a loop early wait for the others at its exit
+        const word at = lowest(active, pc);
+        Lanes group = _mm512_mask_cmpeq_epi32_mask(active, pc, splat(at));
+        const byte* code = memory + __builtin_ctz(group) * LANE_BYTES;
+        const byte opcode = code[at];
+        const OpcodeInfo& info = opcodeTable[opcode];
+        const byte length = instructionLength(info.mode);
+        const byte lo = code[(word) (at + 1)];
+        const word operand = lo | (code[(word) (at + 2)] << 8);
+        // Lanes whose memory holds another instruction there run it at a later step
+        if (!shared[at >> 8] || !shared[(word) (at + length - 1) >> 8]) {
+            const dword mask = length == 1 ? 0xFF : length == 2 ? 0xFFFF : 0xFFFFFF;
+            __m512i fetched;
+            if (at <= 0xFFFC) {
+                fetched = _mm512_mask_i32gather_epi32(zero, group, _mm512_add_epi32(offsets, splat(at)), memory, 1);
+            } else {
+                fetched = _mm512_or_epi32(gatherByte(group, offsets, splat(at), memory),
+                          _mm512_or_epi32(_mm512_slli_epi32(gatherByte(group, offsets, splat((word) (at + 1)), memory), 8),
+                                          _mm512_slli_epi32(gatherByte(group, offsets, splat((word) (at + 2)), memory), 16)));
+            }
+            group = _mm512_mask_cmpeq_epi32_mask(group, _mm512_and_epi32(fetched, splat(mask)),
+                                                 splat((opcode | operand << 8) & mask));
+        }
+        counters.steps++;
+        counters.laneSteps += __builtin_popcount(group);
+
+        if (info.operation == O::Illegal) {
+            // Stopped before the opcode is executed, as CPU::stopOnOpcode leaves it
+            const bool jam = (opcode & 0x0F) == 0x02 && (opcode < 0x80 || (opcode & 0x10));
+            const CPU::Stop reason = opcode == 0x00 ? CPU::Stop::Breakpoint : jam ? CPU::Stop::Halt : CPU::Stop::IllegalOpcode;
+            for (unsigned lane = 0; lane < LANES; lane++) {
+                if (!(group >> lane & 1)) continue;
+                stop[lane] = reason;
+                stopPC[lane] = at;
+            }
+            pc = _mm512_mask_mov_epi32(pc, group, splat((word) (at + 1)));
+            running &= ~group;
+            continue;
+        }
+
+        const word next = at + length;
+        __m512i cost = splat(info.cycles);
+        __m512i target = splat(next);
+        __m512i address = zero;
+        __m512i base = zero;
+        switch (info.mode) {
+            case M::ZeroPage: address = splat(lo); break;
+            case M::ZeroPageX: address = _mm512_and_epi32(_mm512_add_epi32(splat(lo), x), splat(0xFF)); break;
+            case M::ZeroPageY: address = _mm512_and_epi32(_mm512_add_epi32(splat(lo), y), splat(0xFF)); break;
+            case M::Absolute: address = splat(operand); break;
+            case M::AbsoluteX:
+            case M::AbsoluteY:
+                base = splat(operand);
+                address = _mm512_and_epi32(_mm512_add_epi32(base, info.mode == M::AbsoluteX ? x : y), splat(0xFFFF));
+                break;
+            case M::Indirect: address = gatherWord(group, offsets, splat(operand), memory); break;
+            case M::IndirectX:
+                address = gatherWord(group, offsets, _mm512_and_epi32(_mm512_add_epi32(splat(lo), x), splat(0xFF)), memory);
+                break;
+            case M::IndirectY:
+                base = gatherWord(group, offsets, splat(lo), memory);
+                address = _mm512_and_epi32(_mm512_add_epi32(base, y), splat(0xFFFF));
+                break;
+            default: break;
+        }
+        // Loads and read-modify-writes take a cycle more when the index crosses a page, stores every time
+        if (info.pageCrossCycles && info.mode != M::Relative) {
+            const Lanes crossed = _mm512_test_epi32_mask(_mm512_xor_epi32(address, base), splat(0x0100));
+            cost = _mm512_mask_add_epi32(cost, crossed, cost, splat(1));
+        }
+
+        __m512i value = zero;
+        switch (info.operation) {
+            case O::Lda: case O::Ldx: case O::Ldy: case O::And: case O::Eor: case O::Ora: case O::Adc: case O::Bit:
+            case O::Inc: case O::Dec:
+                value = info.mode == M::Immediate ? splat(lo) : gatherByte(group, offsets, address, memory);
+                break;
+            default: break;
+        }
+
+        switch (info.operation) {
+            // LOADS AND STORES
+            case O::Lda: a = _mm512_mask_mov_epi32(a, group, value); p = _mm512_mask_mov_epi32(p, group, assign(p, value)); break;
+            case O::Ldx: x = _mm512_mask_mov_epi32(x, group, value); p = _mm512_mask_mov_epi32(p, group, assign(p, value)); break;
+            case O::Ldy: y = _mm512_mask_mov_epi32(y, group, value); p = _mm512_mask_mov_epi32(p, group, assign(p, value)); break;
+            case O::Sta: case O::Stx: case O::Sty:
+                _mm512_store_si512(addresses, address);
+                _mm512_store_si512(values, info.operation == O::Sta ? a : info.operation == O::Stx ? x : y);
+                write(group, addresses, values);
+                break;
+            // ACCUMULATOR AND BIT
+            case O::And: case O::Eor: case O::Ora: {
+                const __m512i result = info.operation == O::And ? _mm512_and_epi32(a, value)
+                                     : info.operation == O::Eor ? _mm512_xor_epi32(a, value) : _mm512_or_epi32(a, value);
+                a = _mm512_mask_mov_epi32(a, group, result);
+                p = _mm512_mask_mov_epi32(p, group, assign(p, result));
+            } break;
+            case O::Adc: {
+                const __m512i sum = _mm512_add_epi32(_mm512_add_epi32(a, value), _mm512_and_epi32(p, splat(CPU::FLAG_C)));
+                const __m512i result = _mm512_and_epi32(sum, splat(0xFF));
+                // V: both operands have the same sign and the result another
+                const __m512i overflow = _mm512_and_epi32(_mm512_and_epi32(_mm512_xor_epi32(a, result),
+                                                                           _mm512_xor_epi32(value, result)), splat(0x80));
+                __m512i status = _mm512_andnot_epi32(splat(CPU::FLAG_C | CPU::FLAG_V), p);
+                status = _mm512_or_epi32(status, _mm512_or_epi32(_mm512_srli_epi32(sum, 8), _mm512_srli_epi32(overflow, 1)));
+                a = _mm512_mask_mov_epi32(a, group, result);
+                p = _mm512_mask_mov_epi32(p, group, assign(status, result));
+            } break;
+            case O::Bit: {
+                __m512i status = _mm512_andnot_epi32(splat(CPU::FLAG_N | CPU::FLAG_V | CPU::FLAG_Z), p);
+                status = _mm512_or_epi32(status, _mm512_and_epi32(value, splat(CPU::FLAG_N | CPU::FLAG_V)));
+                status = _mm512_mask_or_epi32(status, _mm512_testn_epi32_mask(a, value), status, splat(CPU::FLAG_Z));
+                p = _mm512_mask_mov_epi32(p, group, status);
+            } break;
+            // TRANSFER INSTRUCTIONS
+            case O::Tax: x = _mm512_mask_mov_epi32(x, group, a); p = _mm512_mask_mov_epi32(p, group, assign(p, a)); break;
+            case O::Txa: a = _mm512_mask_mov_epi32(a, group, x); p = _mm512_mask_mov_epi32(p, group, assign(p, x)); break;
+            case O::Tay: y = _mm512_mask_mov_epi32(y, group, a); p = _mm512_mask_mov_epi32(p, group, assign(p, a)); break;
+            case O::Tya: a = _mm512_mask_mov_epi32(a, group, y); p = _mm512_mask_mov_epi32(p, group, assign(p, y)); break;
+            case O::Tsx: x = _mm512_mask_mov_epi32(x, group, sp); p = _mm512_mask_mov_epi32(p, group, assign(p, sp)); break;
+            case O::Txs: sp = _mm512_mask_mov_epi32(sp, group, x); break;
+            // STACK INSTRUCTIONS
+            case O::Pha: case O::Php:
+                _mm512_store_si512(addresses, _mm512_or_epi32(sp, splat(0x0100)));
+                _mm512_store_si512(values, info.operation == O::Pha ? a : _mm512_or_epi32(p, splat(pushedStatus(0))));
+                write(group, addresses, values);
+                sp = _mm512_mask_and_epi32(sp, group, _mm512_sub_epi32(sp, splat(1)), splat(0xFF));
+                break;
+            case O::Pla: case O::Plp: {
+                sp = _mm512_mask_and_epi32(sp, group, _mm512_add_epi32(sp, splat(1)), splat(0xFF));
+                const __m512i pulled = gatherByte(group, offsets, _mm512_or_epi32(sp, splat(0x0100)), memory);
+                if (info.operation == O::Pla) {
+                    a = _mm512_mask_mov_epi32(a, group, pulled);
+                } else {
+                    p = _mm512_mask_ternarylogic_epi32(p, group, pulled, splat(0x30), 0xE4);
+                }
+            } break;
+            // INCREMENT AND DECREMENT INSTRUCTIONS
+            case O::Inc: case O::Dec: {
+                const __m512i result = _mm512_and_epi32(_mm512_add_epi32(value, splat(info.operation == O::Inc ? 1 : -1)),
+                                                        splat(0xFF));
+                _mm512_store_si512(addresses, address);
+                _mm512_store_si512(values, result);
+                write(group, addresses, values);
+                p = _mm512_mask_mov_epi32(p, group, assign(p, result));
+            } break;
+            case O::Inx: case O::Dex: {
+                const __m512i result = _mm512_and_epi32(_mm512_add_epi32(x, splat(info.operation == O::Inx ? 1 : -1)), splat(0xFF));
+                x = _mm512_mask_mov_epi32(x, group, result);
+                p = _mm512_mask_mov_epi32(p, group, assign(p, result));
+            } break;
+            case O::Iny: case O::Dey: {
+                const __m512i result = _mm512_and_epi32(_mm512_add_epi32(y, splat(info.operation == O::Iny ? 1 : -1)), splat(0xFF));
+                y = _mm512_mask_mov_epi32(y, group, result);
+                p = _mm512_mask_mov_epi32(p, group, assign(p, result));
+            } break;
+            // FLAG INSTRUCTIONS
+            case O::Clc: case O::Cld: case O::Cli: case O::Clv: case O::Sec: case O::Sed: case O::Sei:
+                p = setsFlag(info.operation) ? _mm512_mask_or_epi32(p, group, p, splat(info.flagsWritten))
+                                             : _mm512_mask_andnot_epi32(p, group, splat(info.flagsWritten), p);
+                break;
+            // BRANCH INSTRUCTIONS
+            case O::Bcc: case O::Bcs: case O::Beq: case O::Bmi: case O::Bne: case O::Bpl: case O::Bvc: case O::Bvs: {
+                const Lanes set = _mm512_mask_test_epi32_mask(group, p, splat(info.flagsRead));
+                const Lanes taken = branchesWhenSet(info.operation) ? set : (Lanes) (group & ~set);
+                const word branch = next + (sbyte) lo;
+                target = _mm512_mask_mov_epi32(target, taken, splat(branch));
+                cost = _mm512_mask_add_epi32(cost, taken, cost, splat(1 + (((branch ^ next) & 0x0100) != 0)));
+            } break;
+            // JUMP AND CALLS INSTRUCTIONS
+            case O::Jmp: target = info.mode == M::Indirect ? address : splat(operand); break;
+            case O::Jsr: {
+                // Same bytes as CPU::stackPushWord, the low one below the stack page when SP is $00
+                const __m512i top = _mm512_or_epi32(sp, splat(0x0100));
+                _mm512_store_si512(addresses, _mm512_sub_epi32(top, splat(1)));
+                _mm512_store_si512(values, splat((word) (next - 1)));
+                write(group, addresses, values);
+                _mm512_store_si512(addresses, top);
+                _mm512_store_si512(values, splat((word) (next - 1) >> 8));
+                write(group, addresses, values);
+                sp = _mm512_mask_and_epi32(sp, group, _mm512_sub_epi32(sp, splat(2)), splat(0xFF));
+                target = splat(operand);
+            } break;
+            case O::Rts: {
+                sp = _mm512_mask_and_epi32(sp, group, _mm512_add_epi32(sp, splat(2)), splat(0xFF));
+                const __m512i pulled = gatherWord(group, offsets, _mm512_sub_epi32(_mm512_or_epi32(sp, splat(0x0100)), splat(1)), memory);
+                target = _mm512_and_epi32(_mm512_add_epi32(pulled, splat(1)), splat(0xFFFF));
+            } break;
+            case O::Rti: {
+                sp = _mm512_mask_and_epi32(sp, group, _mm512_add_epi32(sp, splat(1)), splat(0xFF));
+                const __m512i pulled = gatherByte(group, offsets, _mm512_or_epi32(sp, splat(0x0100)), memory);
+                p = _mm512_mask_ternarylogic_epi32(p, group, pulled, splat(0x30), 0xE4);
+                sp = _mm512_mask_and_epi32(sp, group, _mm512_add_epi32(sp, splat(2)), splat(0xFF));
+                target = gatherWord(group, offsets, _mm512_sub_epi32(_mm512_or_epi32(sp, splat(0x0100)), splat(1)), memory);
+            } break;
+            case O::Nop:
+            default: break;
+        }
+        pc = _mm512_mask_mov_epi32(pc, group, target);
+        left = _mm512_mask_sub_epi32(left, group, left, cost);
+    }
+
+    _mm512_storeu_si512(PC, pc);
+    _mm512_storeu_si512(A, a);
+    _mm512_storeu_si512(X, x);
+    _mm512_storeu_si512(Y, y);
+    _mm512_storeu_si512(SP, sp);
+    _mm512_storeu_si512(P, p);
+    _mm512_storeu_si512(remaining, left);
+}
+
+#else
+
+void LockstepEngine::run() {}
+
+#endif
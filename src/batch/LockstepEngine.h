@@ -0,0 +1,73 @@
+
+#ifndef CPU6502_LOCKSTEPENGINE_H
+#define CPU6502_LOCKSTEPENGINE_H
+
+#include <cstdint>
+#include <vector>
+#include "../Computer.h"
+#include "../cpu/CPU.h"
+#include "../types.h"
+
+/// The lanes only run as vectors on x86-64 compilers with AVX-512 intrinsics, elsewhere every computer runs on its cpu.
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define CPU6502_LOCKSTEP_AVX512
+#define CPU6502_AVX512_FUNCTION __attribute__((target("avx512f")))
+#else
+#define CPU6502_AVX512_FUNCTION
+#endif
+
+/** @brief Runs many computers executing the same code in lockstep, as the 16 lanes of AVX-512 vectors.
+ *  The registers of up to LANES computers are kept as structure of arrays, and their memories are copied into
+ *  one flat image (64KiB per lane) that operands and opcodes are gathered from. Every step picks the lowest PC
+ *  among the lanes with budget left and runs that instruction once for the lanes sharing it and its bytes under
+ *  a lane mask; lanes that branched apart are regrouped at the next step, and the lowest PC first order brings
+ *  them back together after a loop. Only the pages written are copied back to the computers.
+ *  Results and cycle totals are those of CPU::execute on each computer. The computers run one after the other
+ *  on their cpu when the host has no AVX-512, in stats and trace builds, with static cycles or mapped devices.
+ */
+class LockstepEngine {
+public:
+    static constexpr unsigned LANES = 16;
+
+    struct Counters {
+        std::uint64_t steps = 0;     /// Instructions run for a group of lanes
+        std::uint64_t laneSteps = 0; /// Instructions run summed over the lanes (laneSteps / steps: lanes per step)
+    };
+
+    Counters counters;
+
+    /// @brief Whether the lanes run as vectors on this host, and in this build (vectors don't count stats or trace).
+    static bool isSupported();
+
+    /// @brief Runs every computer's cpu for the cycles given, LANES at a time, results in the order of the computers.
+    std::vector<CPU::Result> execute(const std::vector<Computer*>& computers, int cycles);
+private:
+    std::vector<byte> image;             /// Memory of every lane, lane after lane (and room for gathering 4 bytes at $FFFF)
+    std::uint64_t written[LANES][4];     /// Pages every lane wrote to, as bits
+    bool shared[0x100];                  /// Pages holding the same bytes in every lane, not written since
+    std::int32_t PC[LANES];
+    std::int32_t A[LANES];
+    std::int32_t X[LANES];
+    std::int32_t Y[LANES];
+    std::int32_t SP[LANES];
+    std::int32_t P[LANES];
+    std::int32_t remaining[LANES];
+    CPU::Stop stop[LANES];
+    word stopPC[LANES];
+    unsigned count = 0;
+
+    /// @brief Whether a computer can run as a lane.
+    static bool fitsLane(const Computer& computer);
+
+    void load(Computer* const* computers, unsigned lanes, int cycles);
+    void store(Computer* const* computers, CPU::Result* const* results, int cycles);
+
+    /// @brief Runs the lanes until every one stopped or ran out of cycles (only called when isSupported()).
+    CPU6502_AVX512_FUNCTION void run();
+
+    /// @brief Stores the byte of each lane in the mask to its address (both in the low bits of the values given).
+    void write(unsigned lanes, const std::int32_t* addresses, const std::int32_t* values);
+};
+
+
+#endif //CPU6502_LOCKSTEPENGINE_H
@@ -0,0 +1,88 @@
+#include "WorkStealingPool.h"
+#include <algorithm>
+
+WorkStealingPool::WorkStealingPool(unsigned threads) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned worker = 0; worker < threads; worker++) {
+        queues.emplace_back(new Queue);
+    }
+    for (unsigned worker = 0; worker < threads; worker++) {
+        this->threads.emplace_back(&WorkStealingPool::work, this, worker);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& thread : threads) thread.join();
+}
+
+unsigned WorkStealingPool::size() const {
+    return threads.size();
+}
+
+void WorkStealingPool::run(std::size_t count, const Task& task) {
+    if (count == 0) return;
+    // Published before any index is queued: a worker still draining the previous batch may pick them up
+    this->task = &task;
+    pending = count;
+    const std::size_t workers = queues.size();
+    for (std::size_t worker = 0; worker < workers; worker++) {
+        std::lock_guard<std::mutex> lock(queues[worker]->mutex);
+        for (std::size_t index = count * worker / workers; index < count * (worker + 1) / workers; index++) {
+            queues[worker]->indices.push_back(index);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        batch++;
+    }
+    wake.notify_all();
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return pending == 0; });
+}
+
+void WorkStealingPool::work(unsigned worker) {
+    unsigned seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || batch != seen; });
+            if (stopping) return;
+            seen = batch;
+        }
+        std::size_t index;
+        while (next(worker, index)) {
+            (*task)(worker, index);
+            if (--pending == 0) {
+                std::lock_guard<std::mutex> lock(mutex);
+                done.notify_all();
+            }
+        }
+    }
+}
+
+bool WorkStealingPool::next(unsigned worker, std::size_t &index) {
+    {
+        Queue& own = *queues[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.indices.empty()) {
+            index = own.indices.back();
+            own.indices.pop_back();
+            return true;
+        }
+    }
+    for (std::size_t offset = 1; offset < queues.size(); offset++) {
+        Queue& victim = *queues[(worker + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.indices.empty()) {
+            index = victim.indices.front();
+            victim.indices.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,56 @@
+
+#ifndef CPU6502_WORKSTEALINGPOOL_H
+#define CPU6502_WORKSTEALINGPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/** @brief Fixed set of threads running batches of indexed tasks.
+ *  Each batch is split into one contiguous range per worker. A worker takes tasks from the back of its own
+ *  queue and, once it runs dry, steals from the front of the others, so uneven tasks still keep every
+ *  thread busy. Queues are only touched between tasks, never while one runs.
+ */
+class WorkStealingPool {
+public:
+    using Task = std::function<void(unsigned worker, std::size_t index)>;
+
+    /// @brief Starts the threads given (0: one per hardware thread).
+    explicit WorkStealingPool(unsigned threads = 0);
+    ~WorkStealingPool();
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /// @brief Number of worker threads.
+    unsigned size() const;
+
+    /// @brief Runs task(worker, index) for every index below count, returns once they all ran.
+    void run(std::size_t count, const Task& task);
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::size_t> indices;
+    };
+
+    std::vector<std::thread> threads;
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const Task* task = nullptr;
+    std::atomic<std::size_t> pending{0};
+    unsigned batch = 0;
+    bool stopping = false;
+
+    void work(unsigned worker);
+    bool next(unsigned worker, std::size_t& index);
+};
+
+
+#endif //CPU6502_WORKSTEALINGPOOL_H
@@ -0,0 +1,96 @@
+#include "BlockCache.h"
+#include "Opcodes.h"
+
+BlockCache::BlockCache(DecodeCache &decodeCache) : decodeCache(decodeCache) {}
+
+BlockCache::Block &BlockCache::lookup(word address, Memory &memory) {
+    std::unique_ptr<Block>& block = blocks[address];
+    if (!block) block.reset(new Block());
+    else if (isValid(*block, memory)) return *block;
+    // Blocks are translated again in place, chained pointers to them stay valid
+    translate(*block, address, memory);
+    return *block;
+}
+
+bool BlockCache::isValid(const Block &block, Memory &memory) {
+    return decodeCache.refresh(block.firstPage, memory) == block.generations[0]
+        && decodeCache.refresh(block.lastPage, memory) == block.generations[1];
+}
+
+void BlockCache::translate(Block &block, word address, Memory &memory) {
+    block.start = address;
+    block.firstPage = address >> 8;
+    block.worstCycles = 0;
+    block.ops.clear();
+    block.next[0] = block.next[1] = nullptr;
+    int worstBeforeLast = 0;
+    while (true) {
+        const DecodeCache::Entry& entry = decodeCache.lookup(address, memory);
+        // Read through a const reference, so translating doesn't mark the page dirty
+        const byte opcode = static_cast<const Memory&>(memory)[address];
+        const OpcodeInfo& info = opcodeTable[opcode];
+        block.ops.push_back({entry.handler, entry.operand, opcode, entry.cycles, info.writesMemory});
+        block.worstCycles = worstBeforeLast;
+        worstBeforeLast += info.cycles + info.pageCrossCycles;
+        address += entry.length;
+        if (info.changesFlow || !info.isLegal() || block.ops.size() == MAX_BLOCK_INSTRUCTIONS) break;
+        // Clearing I may end the run for a waiting IRQ (see CPU::yieldOnUnmask), nothing runs past it
+        if (info.flagsWritten & CPU::FLAG_I) break;
+        // Keep blocks within two pages
+        if ((byte) (((word) (address + 2) >> 8) - block.firstPage) > 1) break;
+    }
+    block.end = address;
+    block.lastPage = (word) (address - 1) >> 8;
+    block.generations[0] = decodeCache.refresh(block.firstPage, memory);
+    block.generations[1] = decodeCache.refresh(block.lastPage, memory);
+}
+
+BlockCache::Block &BlockCache::successor(Block *previous, word address, Memory &memory) {
+    if (previous) {
+        for (Block* next : previous->next) {
+            if (next && next->start == address && isValid(*next, memory)) return *next;
+        }
+    }
+    Block& block = lookup(address, memory);
+    // Chain it to the block it was reached from
+    if (previous) previous->next[previous->next[0] != nullptr] = &block;
+    return block;
+}
+
+void BlockCache::clear() {
+    blocks.clear();
+}
+
+dword BlockCache::size() const {
+    return blocks.size();
+}
+
+bool BlockCache::run(const Block &block, CPU &cpu, CPU::DecodedCycles &cycles, Memory &memory) {
+    // Budget checks are only needed when the block could outlast the budget
+    const bool checkBudget = cycles <= block.worstCycles;
+    bool completed = true;
+    for (const MicroOp& op : block.ops) {
+        if (checkBudget && cycles <= 0) break;
+        cycles.remaining -= op.cycles;
+        cycles.operand = op.operand;
+        cpu.PC++;
+        op.handler(cpu, cycles, memory);
+        if (op.writesMemory && (memory.isPageDirty(block.firstPage) || memory.isPageDirty(block.lastPage))) {
+            completed = false;
+            break;
+        }
+    }
+    cpu.materializeFlags();
+    return completed;
+}
+
+CPU::Result BlockCache::execute(CPU &cpu, int budget, Memory &memory) {
+    CPU::DecodedCycles cycles(budget);
+    int cyclesExpected = cycles;
+    Block* previous = nullptr;
+    while (cycles > 0) {
+        Block& block = successor(previous, cpu.PC, memory);
+        previous = run(block, cpu, cycles, memory) ? &block : nullptr;
+    }
+    return cpu.finish(cyclesExpected, cycles);
+}
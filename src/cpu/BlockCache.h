@@ -0,0 +1,79 @@
+
+#ifndef CPU6502_BLOCKCACHE_H
+#define CPU6502_BLOCKCACHE_H
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "CPU.h"
+#include "DecodeCache.h"
+#include "../memory/Memory.h"
+#include "../types.h"
+
+/** @brief Cache of basic blocks translated into micro-op arrays.
+ *  A block runs from its entry address up to the first branch, jump, call, return or write of I. Blocks are linked to
+ *  the successors they exit to, so hot loops go from block to block without a lookup, and the cycle budget
+ *  is only checked when a block is entered. Built on a DecodeCache, which tells when the pages of a block
+ *  were written.
+ */
+class BlockCache {
+public:
+    static constexpr dword MAX_BLOCK_INSTRUCTIONS = 32;
+
+    struct MicroOp {
+        CPU::InstructionHandler<CPU::DecodedCycles> handler;
+        word operand;
+        byte opcode;
+        byte cycles; /// Base cycles (opcode table)
+        bool writesMemory;
+    };
+
+    struct Block {
+        word start;
+        word end;                /// Address following the last instruction
+        byte firstPage, lastPage;
+        dword generations[2];    /// DecodeCache generations of firstPage and lastPage when translated
+        int worstCycles;         /// Most cycles taken before the last micro-op starts
+        std::vector<MicroOp> ops;
+        Block* next[2] = {nullptr, nullptr}; /// Chained successors
+    };
+
+    explicit BlockCache(DecodeCache& decodeCache);
+
+    /// @brief Block starting at the address given, translated on the first visit or when its pages were written.
+    Block& lookup(word address, Memory& memory);
+
+    /** @brief Block to run at the address given once the previous one (nullptr if none) finished.
+     *  Follows the links of the previous block, or looks the block up and links it.
+     */
+    Block& successor(Block* previous, word address, Memory& memory);
+
+    /// @brief Drops every block.
+    void clear();
+
+    /// @brief Number of blocks translated and still valid.
+    dword size() const;
+
+    /** @brief Execute the number of cycles given a block at a time.
+     *  Blocks that could exceed the budget run one micro-op at a time,
+     *  so the results and cycle totals are the same as CPU::execute.
+     *
+     *  @return Why it stopped, Cycles Executed and where
+     */
+    CPU::Result execute(CPU& cpu, int cycles, Memory& memory);
+
+    /** @brief Runs the block given (PC must be at its start).
+     *
+     *  @return false when the block stopped early because it wrote to its own pages
+     */
+    static bool run(const Block& block, CPU& cpu, CPU::DecodedCycles& cycles, Memory& memory);
+private:
+    DecodeCache& decodeCache;
+    std::unordered_map<word, std::unique_ptr<Block>> blocks;
+
+    bool isValid(const Block& block, Memory& memory);
+    void translate(Block& block, word address, Memory& memory);
+};
+
+
+#endif //CPU6502_BLOCKCACHE_H
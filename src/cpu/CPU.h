@@ -2,20 +2,213 @@
 #ifndef CPU6502_CPU_H
 #define CPU6502_CPU_H
 
+#include <array>
+#include <climits>
+#include <cstdint>
+#include <utility>
 #include "../memory/Memory.h"
 #include "../types.h"
+#include "Stats.h"
+#include "../trace/TraceRecorder.h"
 
 // https://www.masswerk.at/6502/6502_instruction_set.html
 
-class CPU {
+enum class Register : byte;
+
+/// Default dispatch engine of every CPU (Switch, Table or Threaded), overridable at compile time.
+#ifndef CPU6502_DEFAULT_DISPATCH
+#define CPU6502_DEFAULT_DISPATCH Switch
+#endif
+
+/// Default cycle accounting of every CPU (true: static per instruction costs), overridable at compile time.
+#ifndef CPU6502_DEFAULT_STATIC_CYCLES
+#define CPU6502_DEFAULT_STATIC_CYCLES false
+#endif
+
+// Stats and trace builds only see what the cpu's instruction handlers run: the Jit generates no native code in them
+// (see Jit::isSupported), and programs recompiled ahead of time are neither counted nor traced.
+
+/// Gather execution statistics and profile subroutines into CPU::stats and CPU::profiler (see StatsPolicy), set at compile time.
+/// Off, the cpu has neither member and counts nothing.
+#ifndef CPU6502_STATS
+#define CPU6502_STATS false
+#endif
+
+/// Trace every instruction, write and interrupt into CPU::tracer when one is set (see TracePolicy), set at compile time.
+/// Off, the cpu has no tracer to set.
+#ifndef CPU6502_TRACE
+#define CPU6502_TRACE false
+#endif
+
+/// Default idle loop fast forwarding of every CPU (JMP *, polling and counting loops), overridable at compile time.
+/// Off in stats and trace builds, the iterations it skips wouldn't be counted or traced.
+#ifndef CPU6502_DEFAULT_IDLE_SKIP
+#define CPU6502_DEFAULT_IDLE_SKIP !(CPU6502_STATS || CPU6502_TRACE)
+#endif
+
+/// Evaluate N and Z only when they're read instead of after every instruction, set at compile time.
+#ifndef CPU6502_LAZY_FLAGS
+#define CPU6502_LAZY_FLAGS false
+#endif
+
+/// Forces inlining of the instruction bodies into every dispatch engine.
+#if defined(__GNUC__) || defined(__clang__)
+#define CPU6502_ALWAYS_INLINE inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define CPU6502_ALWAYS_INLINE __forceinline
+#else
+#define CPU6502_ALWAYS_INLINE inline
+#endif
+
+class CPU : public StatsPolicy<CPU6502_STATS>, public TracePolicy<CPU6502_TRACE> {
+public:
+    /** @brief Cycle counter of the static accounting mode.
+     *  Per access decrements are no-ops: each instruction's base cost is charged once
+     *  from the opcode table and only page crossings and taken branches are added on top.
+     */
+    struct StaticCycles {
+        int remaining;
+
+        explicit StaticCycles(int cycles) : remaining(cycles) {}
+        operator int() const { return remaining; }
+        void operator--(int) {}
+        StaticCycles& operator-=(int) { return *this; }
+    };
+
+    /** @brief Cycle counter of pre-decoded instructions.
+     *  Static accounting whose operand fetches return the operand decoded ahead of time.
+     */
+    struct DecodedCycles : StaticCycles {
+        word operand = 0;
+
+        explicit DecodedCycles(int cycles) : StaticCycles(cycles) {}
+    };
+
+    /// @brief Handler executing one already fetched opcode.
+    template<class Cycles>
+    using InstructionHandler = void (*)(CPU& cpu, Cycles& cycles, Memory& memory);
+
+    /// @brief Why execute() returned
+    enum class Stop : byte {
+        Budget,        /// Ran the cycles given
+        IllegalOpcode, /// Reached an opcode it doesn't implement
+        Breakpoint,    /// Reached a BRK
+        Halt,          /// Reached a JAM opcode, which locks the real cpu up
+        Cancelled,     /// Computer::cancel() was called
+    };
+
+    /// @brief Outcome of execute(), which never throws.
+    struct Result {
+        Stop stop;
+        int cycles; /// Cycles executed
+        word pc;    /// Instruction it stopped at (the next one to run after Budget and Cancelled)
+        std::uint64_t instructions = 0; /// Instructions executed, only counted by the budgeted execute()
+    };
+
+    /// @brief Limits of the budgeted execute(), whichever is reached first
+    struct Budget {
+        int cycles = INT_MAX;                    /// Cycles to run, overshooting by part of an instruction unless exact
+        std::uint64_t instructions = UINT64_MAX; /// Most instructions to run
+        bool exact = false;                      /// Never start an instruction the cycles left can't pay for
+        bool untilFlowChange = false;            /// Stop after the first branch, jump, call or return
+    };
+private:
+    byte lastResult = 0;       /// Value N and Z are pending from (lazy flags)
+    bool flagsPending = false; /// N and Z in status are stale
+    Stop stopReason = Stop::Budget; /// Set by stop() until the engine returns
+    int stopRemaining = 0;          /// Cycles left when stop() was called
+    word stopPC = 0;                /// Instruction that called stop()
+    int yieldRemaining = 0;         /// Cycles left when yield() ended the run
+
     static bool isNeg(byte value);
     static bool isZero(byte value);
-    static word addOffsetWithPageBoundary(word address, byte offset, int& cycles);
-    static word addRelativeOffsetWithPageBoundary(word address, sbyte offset, int& cycles);
+    template<class Cycles>
+    static word addOffsetWithPageBoundary(word address, byte offset, Cycles& cycles);
+    template<class Cycles>
+    static word addRelativeOffsetWithPageBoundary(word address, sbyte offset, Cycles& cycles);
     void setAssignmentFlags(byte reg);
+    bool zeroFlag() const;
+    /// @brief Status with N and Z up to date, pending or not (traced).
+    byte currentStatus() const;
+    friend class TracePolicy<true>;
+    bool negativeFlag() const;
+
+    /// @brief Charges the cost of fetching the opcode given (whole instruction cost for StaticCycles).
+    static void opcodeCycles(int& cycles, byte opcode);
+    static void opcodeCycles(StaticCycles& cycles, byte opcode);
+
+    /// @brief Gives back the cost opcodeCycles charged for an instruction that isn't executed.
+    static void refundOpcode(int& cycles, byte opcode);
+    static void refundOpcode(StaticCycles& cycles, byte opcode);
+
+    /// @brief Stops on an opcode without an implementation (not executed, PC left past it as fetched).
+    template<class Cycles>
+    void stopOnOpcode(byte opcode, Cycles& cycles);
+
+    /// @brief Charges a dynamic cycle (page boundary crossed, branch taken).
+    static void penaltyCycle(int& cycles);
+    static void penaltyCycle(StaticCycles& cycles);
+
+    /// @brief Charges the cycles of idle loop iterations skipped at once.
+    static void skipCycles(int& cycles, int skipped);
+    static void skipCycles(StaticCycles& cycles, int skipped);
+
+    /// @brief Skips up to most iterations of the cost given, leaving the last cycles to run as usual.
+    /// @return Iterations skipped
+    template<class Cycles>
+    static int skipIterations(Cycles& cycles, int cost, int most);
+
+    /// @brief Ends the run after an instruction that may have cleared I, if it did and yieldOnUnmask is set.
+    template<class Cycles>
+    void yieldIfUnmasked(Cycles& cycles);
+
+    /// @brief Fast forwards a JMP to itself.
+    template<class Cycles>
+    void skipIdleJump(Cycles& cycles);
+
+    /// @brief Fast forwards the loop a taken branch just went back to, when it's idle (see idleSkip).
+    template<class Cycles>
+    void skipIdleLoop(Cycles& cycles, const Memory& memory, sbyte offset);
+
+    /// @brief Register given (A for Register::None).
+    byte& registerOf(Register reg);
+
+    /// @brief Effective address of the opcode's operand, as its addressing mode in the opcode table gives it.
+    template<byte opcode, class Cycles>
+    word operandAddress(Cycles& cycles, const Memory& memory);
+
+    /// @brief Value of the opcode's operand, immediate or read from its effective address.
+    template<byte opcode, class Cycles>
+    byte readOperand(Cycles& cycles, const Memory& memory);
+
+    /// @brief Executes an already fetched opcode, generated from its addressing mode and operation in the opcode table.
+    template<byte opcode, class Cycles>
+    void executeOpcode(Cycles& cycles, Memory& memory);
+
+    /// @brief Executes an already fetched instruction (shared by every dispatch engine).
+    template<class Cycles>
+    void executeInstruction(byte instruction, Cycles& cycles, Memory& memory);
+
+    /// @brief Table entry for a single opcode.
+    template<byte opcode, class Cycles>
+    static void instructionHandler(CPU& cpu, Cycles& cycles, Memory& memory);
+
+    template<class Cycles, std::size_t... opcodes>
+    static constexpr std::array<InstructionHandler<Cycles>, 0x100> makeInstructionTable(std::index_sequence<opcodes...>);
+
+    /// @brief Runs the engine selected by dispatch with the cycle counter given.
+    template<class Cycles>
+    Result executeWith(int cycles, Memory& memory);
+
+    /// @brief Budgeted execute() with the cycle counter given.
+    template<class Cycles>
+    Result executeBudget(const Budget& budget, Memory& memory);
 public:
     static const byte STATUS_MASK = 0b11011111;
+    static const word NMI_ADRESS = 0xFFFA;
     static const word RESET_ADRESS = 0xFFFC;
+    static const word IRQ_ADRESS = 0xFFFE;
+    static const byte INTERRUPT_CYCLES = 7;
     static const byte FLAG_C = 0b00000001;
     static const byte FLAG_Z = 0b00000010;
     static const byte FLAG_I = 0b00000100;
@@ -181,9 +374,35 @@ public:
         jmpInd = 0x6C,
         jsrAbs = 0x20,
         rtsImp = 0x60,
+        rtiImp = 0x40,
         // No Operation
         nop = 0xEA,
     };
+
+    /// @brief Instruction dispatch engines
+    enum class Dispatch {
+        Switch, /// One switch statement over every opcode
+        Table,  /// Indirect call through a 256-entry handler table
+        Threaded, /// Computed goto, every opcode jumps straight to the next one (switch when unsupported)
+    };
+    Dispatch dispatch = Dispatch::CPU6502_DEFAULT_DISPATCH; /// Engine used by execute()
+    bool staticCycles = CPU6502_DEFAULT_STATIC_CYCLES; /// Charge instruction costs once from the opcode table
+    /** Fast forward idle loops in execute() and the engines of Computer: JMP *, branches to themselves, polling loops
+     *  (LDA/LDX/LDY/BIT of RAM then a branch back to it) and DEX/DEY/INX/INY + BNE delay loops (in closed form).
+     *  Whole iterations are skipped at once and the last ones run as usual, so registers, memory and cycles end up
+     *  the same. The Jit leaves the blocks that may be idle loops to the block cache.
+     */
+    bool idleSkip = CPU6502_DEFAULT_IDLE_SKIP;
+    /// End execute() after a CLI, PLP or RTI that clears I, set by Computer while an IRQ waits for I to clear
+    bool yieldOnUnmask = false;
+    static constexpr bool LAZY_FLAGS = CPU6502_LAZY_FLAGS;
+    static constexpr bool STATS = CPU6502_STATS;
+    static constexpr bool TRACE = CPU6502_TRACE;
+
+    /// @brief Handlers indexed by opcode, generated from the opcode table.
+    template<class Cycles>
+    static const std::array<InstructionHandler<Cycles>, 0x100> instructionTable;
+
     /// @brief Default Constructor
     CPU();
 
@@ -196,80 +415,156 @@ public:
     /// @brief Resets the PC to the reset vector.
     void resetPC(const Memory& memory);
 
-    /** @brief Execute the number of cycles given.
+    /** @brief Execute the number of cycles given, or until an instruction stops it.
+     *  Opcodes without an implementation stop it (BRK as a Breakpoint, JAM as a Halt) without being executed:
+     *  their cycles aren't counted and PC is left past them, the Result has their address.
+     *
+     *  @return Why it stopped, Cycles Executed and where
+     */
+    Result execute(int cycles, Memory& memory);
+
+    /** @brief Execute within the budget given, checking it once per instruction.
+     *  Runs on the switch whatever the dispatch, and without idle loop skipping when instructions are counted.
+     *
+     *  @return Why it stopped, Cycles and Instructions Executed and where
+     */
+    Result execute(const Budget& budget, Memory& memory);
+
+    /** @brief Cycles the instruction at PC takes, page crossings and taken branches included.
+     *  Reads its opcode and operands ahead of executing it.
+     */
+    int instructionCycles(const Memory& memory) const;
+
+    /** @brief Ends the engine running, from an instruction handler or an engine loop: the cycles left
+     *  are dropped so its loop exits, and it returns the reason and pc given with the cycles executed so far.
+     */
+    void stop(Stop reason, word pc, int& cycles);
+    void stop(Stop reason, word pc, StaticCycles& cycles);
+
+    /** @brief Ends the engine running after the current instruction as if its budget ran out there: the cycles left
+     *  are dropped so its loop exits, and it returns Budget with the cycles executed so far.
+     */
+    void yield(int& cycles);
+    void yield(StaticCycles& cycles);
+
+    /// @brief Result of an engine that started with the budget given and has the cycles given left (see stop()).
+    Result finish(int budget, int remaining);
+
+    /** @brief Runs the interrupt sequence through the vector given (NMI_ADRESS or IRQ_ADRESS):
+     *  pushes PC and status (B clear), sets I and jumps to the handler.
+     *
+     *  @return Cycles taken
+     */
+    int interrupt(word vector, Memory& memory);
+
+    /** @brief Writes N and Z into status when they're pending (lazy flags).
+     *  Every engine calls it before returning, so status is always up to date outside of them.
+     */
+    void materializeFlags();
+
+    /** @brief Execute the number of cycles given using the switch dispatch.
+     *
+     *  @return Why it stopped, Cycles Executed and where
+     */
+    template<class Cycles>
+    Result executeSwitch(int cycles, Memory& memory);
+
+    /** @brief Execute the number of cycles given using the handler table dispatch.
+     *
+     *  @return Why it stopped, Cycles Executed and where
+     */
+    template<class Cycles>
+    Result executeTable(int cycles, Memory& memory);
+
+    /** @brief Execute the number of cycles given using threaded dispatch (computed goto).
+     *  Falls back to the switch on compilers without labels as values.
      *
-     *  @return Cycles Executed
+     *  @return Why it stopped, Cycles Executed and where
      */
-    int execute(int cycles, Memory& memory);
+    template<class Cycles>
+    Result executeThreaded(int cycles, Memory& memory);
 
     /** @brief Fetch Instruction from Program Counter Address
      * - used for instruction fetching
      *
      * Consumes 1 cycle
      */
-    Instruction fetchInstruction(int& cycles, const Memory& memory);
+    template<class Cycles>
+    Instruction fetchInstruction(Cycles& cycles, const Memory& memory);
 
     /** @brief Fetch Byte from Program Counter Address
      *  - used for instruction data fetching
      *
      *  Consumes 1 cycle
      */
-    byte fetchByte(int& cycles, const Memory& memory);
+    template<class Cycles>
+    byte fetchByte(Cycles& cycles, const Memory& memory);
+    byte fetchByte(DecodedCycles& cycles, const Memory& memory);
 
     /** @brief Fetch Word from Program Counter Address
      *  - used for instruction data fetching
      *
      *  Consumes 2 cycles
      */
-    word fetchWord(int& cycles, const Memory& memory);
+    template<class Cycles>
+    word fetchWord(Cycles& cycles, const Memory& memory);
+    word fetchWord(DecodedCycles& cycles, const Memory& memory);
 
     /** @brief Read Byte from Full Address
      *
      *  Consumes 1 cycle
      */
-    static byte readByte(int& cycles, const Memory& memory, word address);
+    template<class Cycles>
+    static byte readByte(Cycles& cycles, const Memory& memory, word address);
 
     /** @brief Read Word from Full Address
      *
      *  Consumes 2 cycles
      */
-    static word readWord(int& cycles, const Memory& memory, word address);
+    template<class Cycles>
+    static word readWord(Cycles& cycles, const Memory& memory, word address);
 
     /** @brief Write Byte to Full Address
      *
      *  Consumes 1 cycle
      */
-    static void writeByte(byte value, int &cycles, Memory &memory, word address);
+    template<class Cycles>
+    void writeByte(byte value, Cycles& cycles, Memory &memory, word address);
 
     /** @brief Write Word to Full Address
      *
      *  Consumes 2 cycles
      */
-    static void writeWord(word value, int &cycles, Memory &memory, word address);
+    template<class Cycles>
+    void writeWord(word value, Cycles& cycles, Memory &memory, word address);
 
     /** @brief Pushes byte given onto the Stack and decrements Stack Pointer
      *
      *  Consumes 1 cycle
      */
-    void stackPushByte(byte value, int &cycles, Memory &memory);
+    template<class Cycles>
+    void stackPushByte(byte value, Cycles& cycles, Memory &memory);
 
     /** @brief Pushes word given onto the Stack and decrements Stack Pointer accordingly
      *
      *  Consumes 2 cycle
      */
-    void stackPushWord(word value, int &cycles, Memory &memory);
+    template<class Cycles>
+    void stackPushWord(word value, Cycles& cycles, Memory &memory);
 
     /** @brief Pulls byte given from the Stack and increments Stack Pointer
      *
      *  Consumes 1 cycle
      */
-    byte stackPullByte(int &cycles, Memory &memory);
+    template<class Cycles>
+    byte stackPullByte(Cycles& cycles, const Memory &memory);
 
     /** @brief Pulls word given from the Stack and increments Stack Pointer accordingly
      *
      *  Consumes 2 cycle
      */
-    word stackPullWord(int &cycles, Memory &memory);
+    template<class Cycles>
+    word stackPullWord(Cycles& cycles, const Memory &memory);
 
     /** @brief Copies Address to Program Counter
      */
@@ -280,28 +575,32 @@ public:
      *  Consumes 1 cycle
      *  @return Address
      */
-    word zeroPageAddress(int& cycles, const Memory& memory);
+    template<class Cycles>
+    word zeroPageAddress(Cycles& cycles, const Memory& memory);
 
     /** @brief Addressing Mode - Zero Page Address with Offset
      *
      *  Consumes 2 cycles
      *  @return Address
      */
-    word zeroPageAddress(int& cycles, const Memory& memory, byte offset);
+    template<class Cycles>
+    word zeroPageAddress(Cycles& cycles, const Memory& memory, byte offset);
 
     /** @brief Addressing Mode - Absolute Address
      *
      *  Consumes 2 cycles
      *  @return Address
      */
-    word absoluteAddress(int& cycles, const Memory& memory);
+    template<class Cycles>
+    word absoluteAddress(Cycles& cycles, const Memory& memory);
 
     /** @brief Addressing Mode - Absolute Address with Offset
      *
      *  Consumes 2 or 3 cycles
      *  @return Address
      */
-    word absoluteAddress(int& cycles, const Memory& memory, byte offset);
+    template<class Cycles>
+    word absoluteAddress(Cycles& cycles, const Memory& memory, byte offset);
 
     /** @brief Addressing Mode - Absolute Address with Offset Fixed Cycles
      *  Obs: Always consume the "Page Boundary Crossing" Cycle
@@ -309,28 +608,32 @@ public:
      *  Consumes 3 cycles
      *  @return Address
      */
-    word absoluteAddressFixed(int& cycles, const Memory& memory, byte offset);
+    template<class Cycles>
+    word absoluteAddressFixed(Cycles& cycles, const Memory& memory, byte offset);
 
     /** @brief Addressing Mode - Indirect Address
      *
      *  Consumes 4 cycles
      *  @return Address
      */
-    word indirectAddress(int& cycles, const Memory& memory);
+    template<class Cycles>
+    word indirectAddress(Cycles& cycles, const Memory& memory);
 
     /** @brief Addressing Mode - Pre-Indexed Indirect Address
      *
      *  Consumes 4 cycles
      *  @return Address
      */
-    word indirectPreAddress(int& cycles, const Memory& memory, byte offset);
+    template<class Cycles>
+    word indirectPreAddress(Cycles& cycles, const Memory& memory, byte offset);
 
     /** @brief Addressing Mode - Post-Indexed Indirect Address
      *
      *  Consumes 4 or 5 cycles
      *  @return Address
      */
-    word indirectPostAddress(int& cycles, const Memory& memory, byte offset);
+    template<class Cycles>
+    word indirectPostAddress(Cycles& cycles, const Memory& memory, byte offset);
 
     /** @brief Addressing Mode - Post-Indexed Indirect Address Fixed Cycles
      *  Obs: Always consume the "Page Boundary Crossing" Cycle
@@ -338,7 +641,8 @@ public:
      *  Consumes 5 cycles
      *  @return Address
      */
-    word indirectPostAddressFixed(int& cycles, const Memory& memory, byte offset);
+    template<class Cycles>
+    word indirectPostAddressFixed(Cycles& cycles, const Memory& memory, byte offset);
 };
 
 
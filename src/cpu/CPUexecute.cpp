@@ -1,579 +1,691 @@
 
-#include <iostream>
+#include <algorithm>
+#include <climits>
 #include "CPU.h"
+#include "Opcodes.h"
+#include "Operations.h"
 
-int CPU::execute(int cycles, Memory &memory) {
+bool CPU::isNeg(byte value) {
+    return (value & FLAG_N) == FLAG_N;
+}
+
+bool CPU::isZero(byte value) {
+    return value == 0;
+}
+
+void CPU::setAssignmentFlags(byte reg) {
+    if (LAZY_FLAGS) {
+        lastResult = reg;
+        flagsPending = true;
+        return;
+    }
+    flag.Z = isZero(reg);
+    flag.N = isNeg(reg);
+}
+
+bool CPU::zeroFlag() const {
+    return LAZY_FLAGS && flagsPending ? isZero(lastResult) : flag.Z;
+}
+
+bool CPU::negativeFlag() const {
+    return LAZY_FLAGS && flagsPending ? isNeg(lastResult) : flag.N;
+}
+
+byte CPU::currentStatus() const {
+    if (!LAZY_FLAGS || !flagsPending) return status;
+    return (status & ~(FLAG_N | FLAG_Z)) | (isNeg(lastResult) ? FLAG_N : 0) | (isZero(lastResult) ? FLAG_Z : 0);
+}
+
+void CPU::materializeFlags() {
+    if (!LAZY_FLAGS || !flagsPending) return;
+    flag.Z = isZero(lastResult);
+    flag.N = isNeg(lastResult);
+    flagsPending = false;
+}
+
+void CPU::opcodeCycles(int &cycles, byte) {
+    cycles--;
+}
+
+void CPU::opcodeCycles(StaticCycles &cycles, byte opcode) {
+    cycles.remaining -= opcodeTable[opcode].cycles;
+}
+
+void CPU::refundOpcode(int &cycles, byte) {
+    cycles++;
+}
+
+void CPU::refundOpcode(StaticCycles &cycles, byte opcode) {
+    cycles.remaining += opcodeTable[opcode].cycles;
+}
+
+template<class Cycles>
+void CPU::stopOnOpcode(byte opcode, Cycles &cycles) {
+    refundOpcode(cycles, opcode);
+    // The JAM opcodes are the x2 column but for the immediate NOPs ($82, $C2, $E2) and LDX #
+    const bool jam = (opcode & 0x0F) == 0x02 && (opcode < 0x80 || (opcode & 0x10));
+    stop(opcode == 0x00 ? Stop::Breakpoint : jam ? Stop::Halt : Stop::IllegalOpcode, PC - 1, cycles);
+}
+
+void CPU::stop(Stop reason, word pc, int &cycles) {
+    stopReason = reason;
+    stopPC = pc;
+    stopRemaining = cycles;
+    cycles = 0;
+}
+
+void CPU::stop(Stop reason, word pc, StaticCycles &cycles) {
+    stopReason = reason;
+    stopPC = pc;
+    stopRemaining = cycles.remaining;
+    cycles.remaining = 0;
+}
+
+void CPU::yield(int &cycles) {
+    yieldRemaining += cycles;
+    cycles = 0;
+}
+
+void CPU::yield(StaticCycles &cycles) {
+    yieldRemaining += cycles.remaining;
+    cycles.remaining = 0;
+}
+
+CPU::Result CPU::finish(int budget, int remaining) {
+    const Stop reason = stopReason;
+    // Cycles dropped by yield() weren't run, those charged after it (rest of a block) were
+    const int yielded = yieldRemaining;
+    stopReason = Stop::Budget;
+    yieldRemaining = 0;
+    if (reason == Stop::Budget) return {reason, budget - remaining - yielded, PC};
+    return {reason, budget - stopRemaining - yielded, stopPC};
+}
+
+template<class Cycles>
+void CPU::yieldIfUnmasked(Cycles &cycles) {
+    if (yieldOnUnmask && !flag.I) yield(cycles);
+}
+
+void CPU::penaltyCycle(int &cycles) {
+    cycles--;
+}
+
+void CPU::skipCycles(int &cycles, int skipped) {
+    cycles -= skipped;
+}
+
+void CPU::skipCycles(StaticCycles &cycles, int skipped) {
+    cycles.remaining -= skipped;
+}
+
+template<class Cycles>
+int CPU::skipIterations(Cycles &cycles, int cost, int most) {
+    const int remaining = cycles;
+    if (remaining <= cost || most <= 0) return 0;
+    const int skipped = std::min((remaining - 1) / cost, most);
+    skipCycles(cycles, skipped * cost);
+    return skipped;
+}
+
+template<class Cycles>
+void CPU::skipIdleJump(Cycles &cycles) {
+    if (idleSkip) skipIterations(cycles, opcodeTable[jmpAbs].cycles, INT_MAX);
+}
+
+template<class Cycles>
+void CPU::skipIdleLoop(Cycles &cycles, const Memory &memory, sbyte offset) {
+    if (!idleSkip) return;
+    const word target = PC;
+    const word branch = target - offset - 2;
+    const byte condition = memory[branch];
+    const int branchCost = opcodeTable[condition].cycles + 1 + ((target & 0xFF00) != ((branch + 2) & 0xFF00));
+    if (offset == -2) {
+        // Branch to itself, nothing changes the flag it tests
+        skipIterations(cycles, branchCost, INT_MAX);
+        return;
+    }
+    const byte body = memory[target];
+    const OpcodeInfo& info = opcodeTable[body];
+    if (target + instructionLength(info.mode) != branch) return;
+    const int cost = info.cycles + branchCost;
+    switch (body) {
+        // Counting loops, taken until the register wraps to zero
+        case dexImp: case deyImp: case inxImp: case inyImp: {
+            if (condition != bneRel) break;
+            byte& counter = body == dexImp || body == inxImp ? X : Y;
+            const bool down = body == dexImp || body == deyImp;
+            const int skipped = skipIterations(cycles, cost, down ? counter - 1 : 0xFF - counter);
+            if (skipped == 0) break;
+            counter = down ? counter - skipped : counter + skipped;
+            setAssignmentFlags(counter);
+        } break;
+        // Polling loops, the same value is read and branched on forever (unless a device can change it)
+        case ldaZpg: case ldxZpg: case ldyZpg: case bitZpg:
+        case ldaAbs: case ldxAbs: case ldyAbs: case bitAbs: {
+            const word address = info.mode == AddressingMode::ZeroPage ? memory[(word) (target + 1)]
+                                                                       : memory.readWord(target + 1);
+            if (memory.isMapped(address >> 8)) break;
+            const byte value = memory[address];
+            const bool isBit = body == bitZpg || body == bitAbs;
+            const bool zero = isZero(isBit ? A & value : value);
+            const bool overflow = isBit ? (value & 0x40) != 0 : flag.V;
+            bool taken = false;
+            switch (condition) {
+                case bccRel: taken = !flag.C; break;
+                case bcsRel: taken = flag.C; break;
+                case beqRel: taken = zero; break;
+                case bneRel: taken = !zero; break;
+                case bmiRel: taken = isNeg(value); break;
+                case bplRel: taken = !isNeg(value); break;
+                case bvcRel: taken = !overflow; break;
+                case bvsRel: taken = overflow; break;
+                default: break;
+            }
+            if (!taken || skipIterations(cycles, cost, INT_MAX) == 0) break;
+            // Left as the last iteration skipped leaves it, the loop may have been entered at its branch
+            switch (body) {
+                case ldaZpg: case ldaAbs: A = value; setAssignmentFlags(A); break;
+                case ldxZpg: case ldxAbs: X = value; setAssignmentFlags(X); break;
+                case ldyZpg: case ldyAbs: Y = value; setAssignmentFlags(Y); break;
+                default:
+                    flagsPending = false;
+                    flag.Z = zero;
+                    flag.N = isNeg(value);
+                    flag.V = overflow;
+                    break;
+            }
+        } break;
+        default: break;
+    }
+}
+
+void CPU::penaltyCycle(StaticCycles &cycles) {
+    cycles.remaining--;
+}
+
+template<class Cycles>
+word CPU::addOffsetWithPageBoundary(word address, byte offset, Cycles &cycles) {
+    word final = address + offset;
+    // Page Boundary Crossing
+    if ((final & 0x0100) != (address & 0x0100)) penaltyCycle(cycles);
+    return final;
+}
+
+template<class Cycles>
+word CPU::addRelativeOffsetWithPageBoundary(word address, sbyte offset, Cycles &cycles) {
+    word final = address + offset;
+    // Page Boundary Crossing
+    if ((final & 0x0100) != (address & 0x0100)) penaltyCycle(cycles);
+    return final;
+}
+
+template<class Cycles>
+CPU::Instruction CPU::fetchInstruction(Cycles &cycles, const Memory &memory) {
+    byte opcode = memory[PC++];
+    opcodeCycles(cycles, opcode);
+    return (Instruction) opcode;
+}
+
+template<class Cycles>
+byte CPU::fetchByte(Cycles &cycles, const Memory &memory) {
+    cycles--;
+    return memory[PC++];
+}
+
+template<class Cycles>
+word CPU::fetchWord(Cycles &cycles, const Memory &memory) {
+    word data = memory.readWord(PC);
+    cycles -= 2;
+    PC += 2;
+    return data;
+}
+
+byte CPU::fetchByte(DecodedCycles &cycles, const Memory &) {
+    PC++;
+    return (byte) cycles.operand;
+}
+
+word CPU::fetchWord(DecodedCycles &cycles, const Memory &) {
+    PC += 2;
+    return cycles.operand;
+}
+
+template<class Cycles>
+byte CPU::readByte(Cycles &cycles, const Memory &memory, word address) {
+    cycles--;
+    return memory[address];
+}
+
+template<class Cycles>
+word CPU::readWord(Cycles &cycles, const Memory &memory, word address) {
+    cycles -= 2;
+    return memory.readWord(address);
+}
+
+template<class Cycles>
+void CPU::writeByte(byte value, Cycles &cycles, Memory &memory, word address) {
+    memory.write(address, value);
+    traceWrite(address, value);
+    cycles--;
+}
+
+template<class Cycles>
+void CPU::writeWord(word value, Cycles &cycles, Memory &memory, word address) {
+    memory.writeWord(value, address);
+    traceWrite(address, (byte) value);
+    traceWrite((word) (address + 1), (byte) (value >> 8));
+    cycles -= 2;
+}
+
+template<class Cycles>
+void CPU::stackPushByte(byte value, Cycles &cycles, Memory &memory) {
+    memory.write(_SPaddress, value);
+    traceWrite(_SPaddress, value);
+    cycles--; SP--;
+    countPush(SP);
+}
+
+template<class Cycles>
+void CPU::stackPushWord(word value, Cycles &cycles, Memory &memory) {
+    memory.writeWord(value, _SPaddress - 1);
+    traceWrite(_SPaddress - 1, (byte) value);
+    traceWrite(_SPaddress, (byte) (value >> 8));
+    cycles -= 2; SP -= 2;
+    countPush(SP);
+}
+
+template<class Cycles>
+byte CPU::stackPullByte(Cycles &cycles, const Memory &memory) {
+    cycles--; SP++;
+    return memory[_SPaddress];
+}
+
+template<class Cycles>
+word CPU::stackPullWord(Cycles &cycles, const Memory &memory) {
+    cycles -= 2; SP += 2;
+    return memory.readWord(_SPaddress - 1);
+}
+
+template<class Cycles>
+word CPU::zeroPageAddress(Cycles &cycles, const Memory &memory) {
+    return fetchByte(cycles, memory);
+}
+
+template<class Cycles>
+word CPU::zeroPageAddress(Cycles &cycles, const Memory &memory, byte offset) {
+    cycles--;
+    return (byte) (fetchByte(cycles, memory) + offset);
+}
+
+template<class Cycles>
+word CPU::absoluteAddress(Cycles &cycles, const Memory &memory) {
+    return fetchWord(cycles, memory);
+}
+
+template<class Cycles>
+word CPU::absoluteAddress(Cycles &cycles, const Memory &memory, byte offset) {
+    word data = fetchWord(cycles, memory);
+    countPageCrossing(data, offset);
+    return addOffsetWithPageBoundary(data, offset, cycles);
+}
+
+template<class Cycles>
+word CPU::absoluteAddressFixed(Cycles &cycles, const Memory &memory, byte offset) {
+    cycles--;
+    return fetchWord(cycles, memory) + offset;
+}
+
+template<class Cycles>
+word CPU::indirectAddress(Cycles &cycles, const Memory &memory) {
+    return readWord(cycles, memory, fetchWord(cycles, memory));
+}
+
+template<class Cycles>
+word CPU::indirectPreAddress(Cycles &cycles, const Memory &memory, byte offset) {
+    cycles--;
+    return readWord(cycles, memory, (byte) (fetchByte(cycles, memory) + offset));
+}
+
+template<class Cycles>
+word CPU::indirectPostAddress(Cycles &cycles, const Memory &memory, byte offset) {
+    word data = readWord(cycles, memory, fetchByte(cycles,memory));
+    countPageCrossing(data, offset);
+    return addOffsetWithPageBoundary(data, offset, cycles);
+}
+
+template<class Cycles>
+word CPU::indirectPostAddressFixed(Cycles &cycles, const Memory &memory, byte offset) {
+    cycles--;
+    return readWord(cycles, memory, fetchByte(cycles,memory)) + offset;
+}
+
+/// Expands M(hi, lo) for every opcode from $00 to $FF, hi and lo being its hex digits.
+#define CPU6502_OPCODE_ROW(M, hi) M(hi, 0) M(hi, 1) M(hi, 2) M(hi, 3) M(hi, 4) M(hi, 5) M(hi, 6) M(hi, 7) \
+                                  M(hi, 8) M(hi, 9) M(hi, A) M(hi, B) M(hi, C) M(hi, D) M(hi, E) M(hi, F)
+#define CPU6502_FOR_EACH_OPCODE(M) \
+    CPU6502_OPCODE_ROW(M, 0) CPU6502_OPCODE_ROW(M, 1) CPU6502_OPCODE_ROW(M, 2) CPU6502_OPCODE_ROW(M, 3) \
+    CPU6502_OPCODE_ROW(M, 4) CPU6502_OPCODE_ROW(M, 5) CPU6502_OPCODE_ROW(M, 6) CPU6502_OPCODE_ROW(M, 7) \
+    CPU6502_OPCODE_ROW(M, 8) CPU6502_OPCODE_ROW(M, 9) CPU6502_OPCODE_ROW(M, A) CPU6502_OPCODE_ROW(M, B) \
+    CPU6502_OPCODE_ROW(M, C) CPU6502_OPCODE_ROW(M, D) CPU6502_OPCODE_ROW(M, E) CPU6502_OPCODE_ROW(M, F)
+
+CPU6502_ALWAYS_INLINE byte &CPU::registerOf(Register reg) {
+    switch (reg) {
+        case Register::X: return X;
+        case Register::Y: return Y;
+        case Register::SP: return SP;
+        default: return A;
+    }
+}
+
+template<byte opcode, class Cycles>
+CPU6502_ALWAYS_INLINE word CPU::operandAddress(Cycles &cycles, const Memory &memory) {
+    constexpr OpcodeInfo info = opcodeTable[opcode];
+    // Stores and read-modify-writes take the page boundary crossing cycle every time
+    constexpr bool fixed = info.pageCrossCycles == 0;
+    switch (info.mode) {
+        case AddressingMode::ZeroPage: return zeroPageAddress(cycles, memory);
+        case AddressingMode::ZeroPageX: return zeroPageAddress(cycles, memory, X);
+        case AddressingMode::ZeroPageY: return zeroPageAddress(cycles, memory, Y);
+        case AddressingMode::AbsoluteX:
+            return fixed ? absoluteAddressFixed(cycles, memory, X) : absoluteAddress(cycles, memory, X);
+        case AddressingMode::AbsoluteY:
+            return fixed ? absoluteAddressFixed(cycles, memory, Y) : absoluteAddress(cycles, memory, Y);
+        case AddressingMode::Indirect: return indirectAddress(cycles, memory);
+        case AddressingMode::IndirectX: return indirectPreAddress(cycles, memory, X);
+        case AddressingMode::IndirectY:
+            return fixed ? indirectPostAddressFixed(cycles, memory, Y) : indirectPostAddress(cycles, memory, Y);
+        case AddressingMode::Absolute:
+        default: return absoluteAddress(cycles, memory);
+    }
+}
+
+template<byte opcode, class Cycles>
+CPU6502_ALWAYS_INLINE byte CPU::readOperand(Cycles &cycles, const Memory &memory) {
+    if (opcodeTable[opcode].mode == AddressingMode::Immediate) return fetchByte(cycles, memory);
+    word address = operandAddress<opcode>(cycles, memory);
+    return readByte(cycles, memory, address);
+}
+
+template<byte opcode, class Cycles>
+CPU6502_ALWAYS_INLINE void CPU::executeOpcode(Cycles &cycles, Memory &memory) {
+    using O = Operation;
+    constexpr OpcodeInfo info = opcodeTable[opcode];
+    countOpcode(opcode);
+    traceInstruction(*this, opcode);
+    switch (info.operation) {
+        // LOADS AND STORES
+        case O::Lda: case O::Ldx: case O::Ldy: {
+            byte& target = registerOf(targetOf(info.operation));
+            target = readOperand<opcode>(cycles, memory);
+            setAssignmentFlags(target);
+        } break;
+        case O::Sta: case O::Stx: case O::Sty: {
+            word address = operandAddress<opcode>(cycles, memory);
+            writeByte(registerOf(sourceOf(info.operation)), cycles, memory, address);
+        } break;
+        // ACCUMULATOR AND BIT
+        case O::And: case O::Eor: case O::Ora: case O::Adc: {
+            byte value = readOperand<opcode>(cycles, memory);
+            A = accumulate(info.operation, A, value, status);
+            setAssignmentFlags(A);
+        } break;
+        case O::Bit: {
+            byte value = readOperand<opcode>(cycles, memory);
+            flagsPending = false;
+            bitTest(A, value, status);
+        } break;
+        // TRANSFER INSTRUCTIONS
+        case O::Tax: case O::Txa: case O::Tay: case O::Tya: case O::Tsx: case O::Txs: {
+            byte& target = registerOf(targetOf(info.operation));
+            target = registerOf(sourceOf(info.operation)); cycles--;
+            if (info.flagsWritten) setAssignmentFlags(target);
+        } break;
+        // STACK INSTRUCTIONS
+        case O::Pha: {
+            stackPushByte(A, cycles, memory);
+            cycles--;
+        } break;
+        case O::Php: {
+            materializeFlags();
+            stackPushByte(pushedStatus(status), cycles, memory);
+            cycles--;
+        } break;
+        case O::Pla: {
+            A = stackPullByte(cycles, memory);
+            cycles -= 2;
+        } break;
+        case O::Plp: {
+            flagsPending = false;
+            byte pulled = stackPullByte(cycles, memory);
+            status = pulledStatus(status, pulled);
+            cycles -= 2;
+            yieldIfUnmasked(cycles);
+        } break;
+        // INCREMENT AND DECREMENT INSTRUCTIONS
+        case O::Inc: case O::Dec: {
+            word address = operandAddress<opcode>(cycles, memory);
+            byte value = step(info.operation, readByte(cycles, memory, address)); cycles--;
+            writeByte(value, cycles, memory, address);
+            setAssignmentFlags(value);
+        } break;
+        case O::Inx: case O::Iny: case O::Dex: case O::Dey: {
+            byte& target = registerOf(targetOf(info.operation));
+            target = step(info.operation, target); cycles--;
+            setAssignmentFlags(target);
+        } break;
+        // FLAG INSTRUCTIONS
+        case O::Clc: case O::Cld: case O::Cli: case O::Clv: case O::Sec: case O::Sed: case O::Sei: {
+            status = changeFlag(info, status); cycles--;
+            if (info.operation == O::Cli) yieldIfUnmasked(cycles);
+        } break;
+        // BRANCH INSTRUCTIONS
+        case O::Bcc: case O::Bcs: case O::Beq: case O::Bmi: case O::Bne: case O::Bpl: case O::Bvc: case O::Bvs: {
+            byte offset = fetchByte(cycles, memory);
+            const bool set = info.flagsRead == FLAG_Z ? zeroFlag()
+                           : info.flagsRead == FLAG_N ? negativeFlag() : (status & info.flagsRead) != 0;
+            if (!branchTaken(info.operation, set)) break;
+            penaltyCycle(cycles);
+            countBranch(PC, (sbyte) offset);
+            PC = addRelativeOffsetWithPageBoundary(PC, (sbyte) offset, cycles);
+            if ((sbyte) offset < -1 && (sbyte) offset >= -5) skipIdleLoop(cycles, memory, (sbyte) offset);
+        } break;
+        // JUMP AND CALLS INSTRUCTIONS
+        case O::Jmp: {
+            word address = operandAddress<opcode>(cycles, memory);
+            if (info.mode == AddressingMode::Absolute && address == (word) (PC - 3)) skipIdleJump(cycles);
+            jumpTo(address);
+        } break;
+        case O::Jsr: {
+            word address = operandAddress<opcode>(cycles, memory);
+            countCall(address, SP);
+            stackPushWord(PC - 1, cycles, memory);
+            jumpTo(address); cycles--;
+        } break;
+        case O::Rts: {
+            word address = stackPullWord(cycles, memory);
+            countReturn(SP);
+            jumpTo(address + 1); cycles -= 3;
+        } break;
+        case O::Rti: {
+            flagsPending = false;
+            byte pulled = stackPullByte(cycles, memory);
+            status = pulledStatus(status, pulled);
+            jumpTo(stackPullWord(cycles, memory)); cycles -= 2;
+            countReturn(SP);
+            yieldIfUnmasked(cycles);
+        } break;
+        case O::Nop: cycles--; break;
+        case O::Illegal:
+        default: stopOnOpcode(opcode, cycles); break;
+    }
+}
+
+template<class Cycles>
+CPU6502_ALWAYS_INLINE void CPU::executeInstruction(byte instruction, Cycles &cycles, Memory &memory) {
+    switch (instruction) {
+#define CPU6502_OPCODE_CASE(hi, lo) case 0x##hi##lo: executeOpcode<0x##hi##lo>(cycles, memory); break;
+        CPU6502_FOR_EACH_OPCODE(CPU6502_OPCODE_CASE)
+#undef CPU6502_OPCODE_CASE
+    }
+}
+
+template<byte opcode, class Cycles>
+void CPU::instructionHandler(CPU &cpu, Cycles &cycles, Memory &memory) {
+    cpu.executeOpcode<opcode>(cycles, memory);
+}
+
+template<class Cycles, std::size_t... opcodes>
+constexpr std::array<CPU::InstructionHandler<Cycles>, 0x100> CPU::makeInstructionTable(std::index_sequence<opcodes...>) {
+    return {{ &instructionHandler<opcodes, Cycles>... }};
+}
+
+template<class Cycles>
+const std::array<CPU::InstructionHandler<Cycles>, 0x100> CPU::instructionTable =
+        makeInstructionTable<Cycles>(std::make_index_sequence<0x100>());
+
+CPU::Result CPU::execute(int cycles, Memory &memory) {
+    if (staticCycles) return executeWith<StaticCycles>(cycles, memory);
+    return executeWith<int>(cycles, memory);
+}
+
+int CPU::interrupt(word vector, Memory &memory) {
+    materializeFlags();
+    traceInterrupt(*this);
+    int cycles = INTERRUPT_CYCLES;
+    stackPushWord(PC, cycles, memory);
+    stackPushByte((status | 0b00100000) & ~FLAG_B, cycles, memory);
+    flag.I = 1;
+    jumpTo(memory.readWord(vector));
+    countInterrupt(PC, (byte) (SP + 3), INTERRUPT_CYCLES);
+    return INTERRUPT_CYCLES;
+}
+
+CPU::Result CPU::execute(const Budget &budget, Memory &memory) {
+    if (staticCycles) return executeBudget<StaticCycles>(budget, memory);
+    return executeBudget<int>(budget, memory);
+}
+
+template<class Cycles>
+CPU::Result CPU::executeBudget(const Budget &budget, Memory &memory) {
+    // Skipped idle loop iterations would go uncounted
+    const bool skip = idleSkip;
+    idleSkip = skip && budget.instructions == UINT64_MAX;
+    Cycles cycles(budget.cycles);
+    std::uint64_t instructions = 0;
+    while (cycles > 0 && instructions < budget.instructions) {
+        if (budget.exact && instructionCycles(memory) > cycles) break;
+        Instruction instruction = fetchInstruction(cycles, memory);
+        executeInstruction(instruction, cycles, memory);
+        instructions++;
+        if (budget.untilFlowChange && opcodeTable[instruction].changesFlow) break;
+    }
+    idleSkip = skip;
+    materializeFlags();
+    Result result = finish(budget.cycles, cycles);
+    result.instructions = instructions - (result.stop != Stop::Budget);
+    return result;
+}
+
+int CPU::instructionCycles(const Memory &memory) const {
+    const byte opcode = memory[PC];
+    const OpcodeInfo& info = opcodeTable[opcode];
+    const byte lo = memory[(word) (PC + 1)];
+    word base, address;
+    switch (info.mode) {
+        case AddressingMode::AbsoluteX:
+        case AddressingMode::AbsoluteY:
+            base = lo | (memory[(word) (PC + 2)] << 8);
+            address = base + (info.mode == AddressingMode::AbsoluteX ? X : Y);
+            break;
+        case AddressingMode::IndirectY:
+            base = memory.readWord(lo);
+            address = base + Y;
+            break;
+        case AddressingMode::Relative: {
+            // Bits 7-6 pick the flag (N, V, C, Z) and bit 5 the value that takes the branch
+            static const byte flags[4] = {FLAG_N, FLAG_V, FLAG_C, FLAG_Z};
+            const byte flagged = flags[opcode >> 6];
+            const bool set = flagged == FLAG_Z ? zeroFlag() : flagged == FLAG_N ? negativeFlag() : (status & flagged) != 0;
+            if (set != ((opcode & 0x20) != 0)) return info.cycles;
+            base = PC + 2;
+            address = base + (sbyte) lo;
+            return info.cycles + 1 + (((base ^ address) & 0x0100) ? info.pageCrossCycles : 0);
+        }
+        default: return info.cycles;
+    }
+    return info.cycles + (((base ^ address) & 0x0100) ? info.pageCrossCycles : 0);
+}
+
+template<class Cycles>
+CPU::Result CPU::executeWith(int cycles, Memory &memory) {
+    switch (dispatch) {
+        case Dispatch::Table: return executeTable<Cycles>(cycles, memory);
+        case Dispatch::Threaded: return executeThreaded<Cycles>(cycles, memory);
+        case Dispatch::Switch:
+        default: return executeSwitch<Cycles>(cycles, memory);
+    }
+}
+
+template<class Cycles>
+CPU::Result CPU::executeSwitch(int budget, Memory &memory) {
+    Cycles cycles(budget);
     int cyclesExpected = cycles;
     while (cycles > 0) {
         Instruction instruction = fetchInstruction(cycles, memory);
-        switch (instruction) {
-            // LOAD INSTRUCTIONS
-            case ldaImm: {
-                A = fetchByte(cycles, memory);
-                setAssignmentFlags(A);
-            } break;
-            case ldxImm: {
-                X = fetchByte(cycles, memory);
-                setAssignmentFlags(X);
-            } break;
-            case ldyImm: {
-                Y = fetchByte(cycles, memory);
-                setAssignmentFlags(Y);
-            } break;
-            case ldaZpg: {
-                word address = zeroPageAddress(cycles, memory);
-                A = readByte(cycles, memory, address);
-                setAssignmentFlags(A);
-            } break;
-            case ldxZpg: {
-                word address = zeroPageAddress(cycles, memory);
-                X = readByte(cycles, memory, address);
-                setAssignmentFlags(X);
-            } break;
-            case ldyZpg: {
-                word address = zeroPageAddress(cycles, memory);
-                Y = readByte(cycles, memory, address);
-                setAssignmentFlags(Y);
-            } break;
-            case ldaZpX: {
-                word address = zeroPageAddress(cycles, memory, X);
-                A = readByte(cycles, memory, address);
-                setAssignmentFlags(A);
-            } break;
-            case ldxZpY: {
-                word address = zeroPageAddress(cycles, memory, Y);
-                X = readByte(cycles, memory, address);
-                setAssignmentFlags(X);
-            } break;
-            case ldyZpX: {
-                word address = zeroPageAddress(cycles, memory, X);
-                Y = readByte(cycles, memory, address);
-                setAssignmentFlags(Y);
-            } break;
-            case ldaAbs: {
-                word address = absoluteAddress(cycles, memory);
-                A = readByte(cycles, memory, address);
-                setAssignmentFlags(A);
-            } break;
-            case ldxAbs: {
-                word address = absoluteAddress(cycles, memory);
-                X = readByte(cycles, memory, address);
-                setAssignmentFlags(X);
-            } break;
-            case ldyAbs: {
-                word address = absoluteAddress(cycles, memory);
-                Y = readByte(cycles, memory, address);
-                setAssignmentFlags(Y);
-            } break;
-            case ldaAbX: {
-                word address = absoluteAddress(cycles, memory, X);
-                A = readByte(cycles, memory, address);
-                setAssignmentFlags(A);
-            } break;
-            case ldaAbY: {
-                word address = absoluteAddress(cycles, memory, Y);
-                A = readByte(cycles, memory, address);
-                setAssignmentFlags(A);
-            } break;
-            case ldxAbY: {
-                word address = absoluteAddress(cycles, memory, Y);
-                X = readByte(cycles, memory, address);
-                setAssignmentFlags(X);
-            } break;
-            case ldyAbX: {
-                word address = absoluteAddress(cycles, memory, X);
-                Y = readByte(cycles, memory, address);
-                setAssignmentFlags(Y);
-            } break;
-            case ldaIdX: {
-                word address = indirectPreAddress(cycles, memory, X);
-                A = readByte(cycles, memory, address);
-                setAssignmentFlags(A);
-            } break;
-            case ldaIdY: {
-                word address = indirectPostAddress(cycles, memory, Y);
-                A = readByte(cycles, memory, address);
-                setAssignmentFlags(A);
-            } break;
-            // STORE INSTRUCTIONS
-            case staZpg: {
-                word address = zeroPageAddress(cycles, memory);
-                writeByte(A, cycles, memory, address);
-            } break;
-            case stxZpg: {
-                word address = zeroPageAddress(cycles, memory);
-                writeByte(X, cycles, memory, address);
-            } break;
-            case styZpg: {
-                word address = zeroPageAddress(cycles, memory);
-                writeByte(Y, cycles, memory, address);
-            } break;
-            case staZpX: {
-                word address = zeroPageAddress(cycles, memory, X);
-                writeByte(A, cycles, memory, address);
-            } break;
-            case stxZpY: {
-                word address = zeroPageAddress(cycles, memory, Y);
-                writeByte(X, cycles, memory, address);
-            } break;
-            case styZpX: {
-                word address = zeroPageAddress(cycles, memory, X);
-                writeByte(Y, cycles, memory, address);
-            } break;
-            case staAbs: {
-                word address = absoluteAddress(cycles, memory);
-                writeByte(A, cycles, memory, address);
-            } break;
-            case stxAbs: {
-                word address = absoluteAddress(cycles, memory);
-                writeByte(X, cycles, memory, address);
-            } break;
-            case styAbs: {
-                word address = absoluteAddress(cycles, memory);
-                writeByte(Y, cycles, memory, address);
-            } break;
-            case staAbX: {
-                word address = absoluteAddressFixed(cycles, memory, X);
-                writeByte(A, cycles, memory, address);
-            } break;
-            case staAbY: {
-                word address = absoluteAddressFixed(cycles, memory, Y);
-                writeByte(A, cycles, memory, address);
-            } break;
-            case staIdX: {
-                word address = indirectPreAddress(cycles, memory, X);
-                writeByte(A, cycles, memory, address);
-            } break;
-            case staIdY: {
-                word address = indirectPostAddressFixed(cycles, memory, Y);
-                writeByte(A, cycles, memory, address);
-            } break;
-            // AND
-            case andImm: {
-                A &= fetchByte(cycles, memory);
-                setAssignmentFlags(A);
-            } break;
-            case andZpg: {
-                word address = zeroPageAddress(cycles, memory);
-                A &= readByte(cycles, memory, address);
-                setAssignmentFlags(A);
-            } break;
-            case andZpX: {
-                word address = zeroPageAddress(cycles, memory, X);
-                A &= readByte(cycles, memory, address);
-                setAssignmentFlags(A);
-            } break;
-            case andAbs: {
-                word address = absoluteAddress(cycles, memory);
-                A &= readByte(cycles, memory, address);
-                setAssignmentFlags(A);
-            } break;
-            case andAbX: {
-                word address = absoluteAddress(cycles, memory, X);
-                A &= readByte(cycles, memory, address);
-                setAssignmentFlags(A);
-            } break;
-            case andAbY: {
-                word address = absoluteAddress(cycles, memory, Y);
-                A &= readByte(cycles, memory, address);
-                setAssignmentFlags(A);
-            } break;
-            case andIdX: {
-                word address = indirectPreAddress(cycles, memory, X);
-                A &= readByte(cycles, memory, address);
-                setAssignmentFlags(A);
-            } break;
-            case andIdY: {
-                word address = indirectPostAddress(cycles, memory, Y);
-                A &= readByte(cycles, memory, address);
-                setAssignmentFlags(A);
-            } break;
-            // EOR
-            case eorImm: {
-                A ^= fetchByte(cycles, memory);
-                setAssignmentFlags(A);
-            } break;
-            case eorZpg: {
-                word address = zeroPageAddress(cycles, memory);
-                A ^= readByte(cycles, memory, address);
-                setAssignmentFlags(A);
-            } break;
-            case eorZpX: {
-                word address = zeroPageAddress(cycles, memory, X);
-                A ^= readByte(cycles, memory, address);
-                setAssignmentFlags(A);
-            } break;
-            case eorAbs: {
-                word address = absoluteAddress(cycles, memory);
-                A ^= readByte(cycles, memory, address);
-                setAssignmentFlags(A);
-            } break;
-            case eorAbX: {
-                word address = absoluteAddress(cycles, memory, X);
-                A ^= readByte(cycles, memory, address);
-                setAssignmentFlags(A);
-            } break;
-            case eorAbY: {
-                word address = absoluteAddress(cycles, memory, Y);
-                A ^= readByte(cycles, memory, address);
-                setAssignmentFlags(A);
-            } break;
-            case eorIdX: {
-                word address = indirectPreAddress(cycles, memory, X);
-                A ^= readByte(cycles, memory, address);
-                setAssignmentFlags(A);
-            } break;
-            case eorIdY: {
-                word address = indirectPostAddress(cycles, memory, Y);
-                A ^= readByte(cycles, memory, address);
-                setAssignmentFlags(A);
-            } break;
-            // ORA
-            case oraImm: {
-                A |= fetchByte(cycles, memory);
-                setAssignmentFlags(A);
-            } break;
-            case oraZpg: {
-                word address = zeroPageAddress(cycles, memory);
-                A |= readByte(cycles, memory, address);
-                setAssignmentFlags(A);
-            } break;
-            case oraZpX: {
-                word address = zeroPageAddress(cycles, memory, X);
-                A |= readByte(cycles, memory, address);
-                setAssignmentFlags(A);
-            } break;
-            case oraAbs: {
-                word address = absoluteAddress(cycles, memory);
-                A |= readByte(cycles, memory, address);
-                setAssignmentFlags(A);
-            } break;
-            case oraAbX: {
-                word address = absoluteAddress(cycles, memory, X);
-                A |= readByte(cycles, memory, address);
-                setAssignmentFlags(A);
-            } break;
-            case oraAbY: {
-                word address = absoluteAddress(cycles, memory, Y);
-                A |= readByte(cycles, memory, address);
-                setAssignmentFlags(A);
-            } break;
-            case oraIdX: {
-                word address = indirectPreAddress(cycles, memory, X);
-                A |= readByte(cycles, memory, address);
-                setAssignmentFlags(A);
-            } break;
-            case oraIdY: {
-                word address = indirectPostAddress(cycles, memory, Y);
-                A |= readByte(cycles, memory, address);
-                setAssignmentFlags(A);
-            } break;
-            // BIT
-            case bitZpg: {
-                word address = zeroPageAddress(cycles, memory);
-                byte value = readByte(cycles, memory, address);
-                flag.Z = isZero(A & value);
-                flag.N = isNeg(value);
-                flag.V = (value & 0x40) == 0x40; // 6th bit
-            } break;
-            case bitAbs: {
-                word address = absoluteAddress(cycles, memory);
-                byte value = readByte(cycles, memory, address);
-                flag.Z = isZero(A & value);
-                flag.N = isNeg(value);
-                flag.V = (value & 0x40) == 0x40; // 6th bit
-            } break;
-            // TRANSFER INSTRUCTIONS
-            case taxImp: {
-                X = A; cycles--;
-                setAssignmentFlags(X);
-            } break;
-            case txaImp: {
-                A = X; cycles--;
-                setAssignmentFlags(A);
-            } break;
-            case tayImp: {
-                Y = A; cycles--;
-                setAssignmentFlags(Y);
-            } break;
-            case tyaImp: {
-                A = Y; cycles--;
-                setAssignmentFlags(A);
-            } break;
-            case tsxImp: {
-                X = SP; cycles--;
-                setAssignmentFlags(X);
-            } break;
-            case txsImp: {
-                SP = X; cycles--;
-            } break;
-            // STACK INSTRUCTIONS
-            case phaImp: {
-                stackPushByte(A, cycles, memory);
-                cycles--;
-            } break;
-            case phpImp: {
-                stackPushByte(status | 0b00110000, cycles, memory);
-                cycles--;
-            } break;
-            case plaImp: {
-                A = stackPullByte(cycles, memory);
-                cycles -= 2;
-            } break;
-            case plpImp: {
-                status = (status & 0b00110000) | (stackPullByte(cycles, memory) & 0b11001111);
-                cycles -= 2;
-            } break;
-            // INCREMENT INSTRUCTIONS
-            case incZpg: {
-                word address = zeroPageAddress(cycles, memory);
-                byte value = readByte(cycles, memory, address);
-                value++; cycles--;
-                writeByte(value, cycles, memory, address);
-                setAssignmentFlags(value);
-            } break;
-            case incZpX: {
-                word address = zeroPageAddress(cycles, memory, X);
-                byte value = readByte(cycles, memory, address);
-                value++; cycles--;
-                writeByte(value, cycles, memory, address);
-                setAssignmentFlags(value);
-            } break;
-            case incAbs: {
-                word address = absoluteAddress(cycles, memory);
-                byte value = readByte(cycles, memory, address);
-                value++; cycles--;
-                writeByte(value, cycles, memory, address);
-                setAssignmentFlags(value);
-            } break;
-            case incAbX: {
-                word address = absoluteAddressFixed(cycles, memory, X);
-                byte value = readByte(cycles, memory, address);
-                value++; cycles--;
-                writeByte(value, cycles, memory, address);
-                setAssignmentFlags(value);
-            } break;
-            case inxImp: {
-                X++; cycles--;
-                setAssignmentFlags(X);
-            } break;
-            case inyImp: {
-                Y++; cycles--;
-                setAssignmentFlags(Y);
-            } break;
-            // DECREMENT INSTRUCTIONS
-            case decZpg: {
-                word address = zeroPageAddress(cycles, memory);
-                byte value = readByte(cycles, memory, address);
-                value--; cycles--;
-                writeByte(value, cycles, memory, address);
-                setAssignmentFlags(value);
-            } break;
-            case decZpX: {
-                word address = zeroPageAddress(cycles, memory, X);
-                byte value = readByte(cycles, memory, address);
-                value--; cycles--;
-                writeByte(value, cycles, memory, address);
-                setAssignmentFlags(value);
-            } break;
-            case decAbs: {
-                word address = absoluteAddress(cycles, memory);
-                byte value = readByte(cycles, memory, address);
-                value--; cycles--;
-                writeByte(value, cycles, memory, address);
-                setAssignmentFlags(value);
-            } break;
-            case decAbX: {
-                word address = absoluteAddressFixed(cycles, memory, X);
-                byte value = readByte(cycles, memory, address);
-                value--; cycles--;
-                writeByte(value, cycles, memory, address);
-                setAssignmentFlags(value);
-            } break;
-            case dexImp: {
-                X--; cycles--;
-                setAssignmentFlags(X);
-            } break;
-            case deyImp: {
-                Y--; cycles--;
-                setAssignmentFlags(Y);
-            } break;
-            // ARITHMETIC INSTRUCTIONS
-            case adcImm: {
-                byte value = fetchByte(cycles, memory);
-                byte result = A + value;
-                bool flagC = result < A;
-                if (flag.C) { result++; if (result == 0) flagC = true; }
-                flag.C = flagC;
-                bool sign = isNeg(A);
-                flag.V = (sign == isNeg(value)) && (sign != isNeg(result));
-                A = result; setAssignmentFlags(A);
-            } break;
-            case adcZpg: {
-                word address = zeroPageAddress(cycles, memory);
-                byte value = readByte(cycles, memory, address);
-                byte result = A + value;
-                bool flagC = result < A;
-                if (flag.C) { result++; if (result == 0) flagC = true; }
-                flag.C = flagC;
-                bool sign = isNeg(A);
-                flag.V = (sign == isNeg(value)) && (sign != isNeg(result));
-                A = result; setAssignmentFlags(A);
-            } break;
-            case adcZpX: {
-                word address = zeroPageAddress(cycles, memory, X);
-                byte value = readByte(cycles, memory, address);
-                byte result = A + value;
-                bool flagC = result < A;
-                if (flag.C) { result++; if (result == 0) flagC = true; }
-                flag.C = flagC;
-                bool sign = isNeg(A);
-                flag.V = (sign == isNeg(value)) && (sign != isNeg(result));
-                A = result; setAssignmentFlags(A);
-            } break;
-            case adcAbs: {
-                word address = absoluteAddress(cycles, memory);
-                byte value = readByte(cycles, memory, address);
-                byte result = A + value;
-                bool flagC = result < A;
-                if (flag.C) { result++; if (result == 0) flagC = true; }
-                flag.C = flagC;
-                bool sign = isNeg(A);
-                flag.V = (sign == isNeg(value)) && (sign != isNeg(result));
-                A = result; setAssignmentFlags(A);
-            } break;
-            case adcAbX: {
-                word address = absoluteAddress(cycles, memory, X);
-                byte value = readByte(cycles, memory, address);
-                byte result = A + value;
-                bool flagC = result < A;
-                if (flag.C) { result++; if (result == 0) flagC = true; }
-                flag.C = flagC;
-                bool sign = isNeg(A);
-                flag.V = (sign == isNeg(value)) && (sign != isNeg(result));
-                A = result; setAssignmentFlags(A);
-            } break;
-            case adcAbY: {
-                word address = absoluteAddress(cycles, memory, Y);
-                byte value = readByte(cycles, memory, address);
-                byte result = A + value;
-                bool flagC = result < A;
-                if (flag.C) { result++; if (result == 0) flagC = true; }
-                flag.C = flagC;
-                bool sign = isNeg(A);
-                flag.V = (sign == isNeg(value)) && (sign != isNeg(result));
-                A = result; setAssignmentFlags(A);
-            } break;
-            case adcIdX: {
-                word address = indirectPreAddress(cycles, memory, X);
-                byte value = readByte(cycles, memory, address);
-                byte result = A + value;
-                bool flagC = result < A;
-                if (flag.C) { result++; if (result == 0) flagC = true; }
-                flag.C = flagC;
-                bool sign = isNeg(A);
-                flag.V = (sign == isNeg(value)) && (sign != isNeg(result));
-                A = result; setAssignmentFlags(A);
-            } break;
-            case adcIdY: {
-                word address = indirectPostAddress(cycles, memory, Y);
-                byte value = readByte(cycles, memory, address);
-                byte result = A + value;
-                bool flagC = result < A;
-                if (flag.C) { result++; if (result == 0) flagC = true; }
-                flag.C = flagC;
-                bool sign = isNeg(A);
-                flag.V = (sign == isNeg(value)) && (sign != isNeg(result));
-                A = result; setAssignmentFlags(A);
-            } break;
-            // FLAG INSTRUCTIONS
-            case clcImp: {
-                flag.C = false; cycles--;
-            } break;
-            case cldImp: {
-                flag.D = false; cycles--;
-            } break;
-            case cliImp: {
-                flag.I = false; cycles--;
-            } break;
-            case clvImp: {
-                flag.V = false; cycles--;
-            } break;
-            case secImp: {
-                flag.C = true; cycles--;
-            } break;
-            case sedImp: {
-                flag.D = true; cycles--;
-            } break;
-            case seiImp: {
-                flag.I = true; cycles--;
-            } break;
-            // BRANCH INSTRUCTIONS
-            case bccRel: {
-                byte offset = fetchByte(cycles, memory);
-                if (flag.C) break; cycles--;
-                PC = addRelativeOffsetWithPageBoundary(PC, (sbyte) offset, cycles);
-            } break;
-            case bcsRel: {
-                byte offset = fetchByte(cycles, memory);
-                if (!flag.C) break; cycles--;
-                PC = addRelativeOffsetWithPageBoundary(PC, (sbyte) offset, cycles);
-            } break;
-            case beqRel: {
-                byte offset = fetchByte(cycles, memory);
-                if (!flag.Z) break; cycles--;
-                PC = addRelativeOffsetWithPageBoundary(PC, (sbyte) offset, cycles);
-            } break;
-            case bmiRel: {
-                byte offset = fetchByte(cycles, memory);
-                if (!flag.N) break; cycles--;
-                PC = addRelativeOffsetWithPageBoundary(PC, (sbyte) offset, cycles);
-            } break;
-            case bneRel: {
-                byte offset = fetchByte(cycles, memory);
-                if (flag.Z) break; cycles--;
-                PC = addRelativeOffsetWithPageBoundary(PC, (sbyte) offset, cycles);
-            } break;
-            case bplRel: {
-                byte offset = fetchByte(cycles, memory);
-                if (flag.N) break; cycles--;
-                PC = addRelativeOffsetWithPageBoundary(PC, (sbyte) offset, cycles);
-            } break;
-            case bvcRel: {
-                byte offset = fetchByte(cycles, memory);
-                if (flag.V) break; cycles--;
-                PC = addRelativeOffsetWithPageBoundary(PC, (sbyte) offset, cycles);
-            } break;
-            case bvsRel: {
-                byte offset = fetchByte(cycles, memory);
-                if (!flag.V) break; cycles--;
-                PC = addRelativeOffsetWithPageBoundary(PC, (sbyte) offset, cycles);
-            } break;
-            // JUMP AND CALLS INSTRUCTIONS
-            case jmpAbs: {
-                word address = absoluteAddress(cycles, memory);
-                jumpTo(address);
-            } break;
-            case jmpInd: {
-                word address = indirectAddress(cycles, memory);
-                jumpTo(address);
-            } break;
-            case jsrAbs: {
-                word address = absoluteAddress(cycles, memory);
-                stackPushWord(PC - 1, cycles, memory);
-                jumpTo(address); cycles--;
-            } break;
-            case rtsImp: {
-                word address = stackPullWord(cycles, memory);
-                jumpTo(address + 1); cycles -= 3;
-            } break;
-            case nop: cycles--; break;
-            default :
-                std::cout << "Unhandled instruction opcode: 0x"
-                    << std::hex << instruction << std::endl;
-                throw -1;
-        }
+        executeInstruction(instruction, cycles, memory);
+    }
+    materializeFlags();
+    return finish(cyclesExpected, cycles);
+}
+
+template<class Cycles>
+CPU::Result CPU::executeTable(int budget, Memory &memory) {
+    Cycles cycles(budget);
+    int cyclesExpected = cycles;
+    while (cycles > 0) {
+        Instruction instruction = fetchInstruction(cycles, memory);
+        instructionTable<Cycles>[instruction](*this, cycles, memory);
     }
-    return cyclesExpected - cycles;
+    materializeFlags();
+    return finish(cyclesExpected, cycles);
 }
 
+template<class Cycles>
+CPU::Result CPU::executeThreaded(int budget, Memory &memory) {
+    Cycles cycles(budget);
+#if defined(__GNUC__) || defined(__clang__)
+    // Labels are generated for every opcode. Each one ends with its own copy of the dispatch jump,
+    // so every opcode gets its own branch predictor slot.
+    static void* const labels[0x100] = {
+#define CPU6502_OPCODE_LABEL(hi, lo) &&opcode##hi##lo,
+            CPU6502_FOR_EACH_OPCODE(CPU6502_OPCODE_LABEL)
+#undef CPU6502_OPCODE_LABEL
+    };
+    int cyclesExpected = cycles;
+    byte instruction;
+#define CPU6502_DISPATCH_NEXT() \
+    if (cycles <= 0) goto done; \
+    instruction = fetchInstruction(cycles, memory); \
+    goto *labels[instruction]
+
+    CPU6502_DISPATCH_NEXT();
+#define CPU6502_OPCODE_BODY(hi, lo) opcode##hi##lo: executeOpcode<0x##hi##lo>(cycles, memory); CPU6502_DISPATCH_NEXT();
+    CPU6502_FOR_EACH_OPCODE(CPU6502_OPCODE_BODY)
+#undef CPU6502_OPCODE_BODY
+#undef CPU6502_DISPATCH_NEXT
+    done:
+    materializeFlags();
+    return finish(cyclesExpected, cycles);
+#else
+    return executeSwitch<Cycles>(cycles, memory);
+#endif
+}
+
+template CPU::Result CPU::executeSwitch<int>(int budget, Memory &memory);
+template CPU::Result CPU::executeSwitch<CPU::StaticCycles>(int budget, Memory &memory);
+template CPU::Result CPU::executeTable<int>(int budget, Memory &memory);
+template CPU::Result CPU::executeTable<CPU::StaticCycles>(int budget, Memory &memory);
+template CPU::Result CPU::executeThreaded<int>(int budget, Memory &memory);
+template CPU::Result CPU::executeThreaded<CPU::StaticCycles>(int budget, Memory &memory);
+
+template const std::array<CPU::InstructionHandler<CPU::DecodedCycles>, 0x100> CPU::instructionTable<CPU::DecodedCycles>;
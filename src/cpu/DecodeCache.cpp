@@ -0,0 +1,59 @@
+#include <algorithm>
+#include "DecodeCache.h"
+#include "Opcodes.h"
+
+const DecodeCache::Entry &DecodeCache::lookup(word address, Memory &memory) {
+    const byte page = address >> 8;
+    refresh(page, memory);
+    std::unique_ptr<Entry[]>& entries = pages[page];
+    if (!entries) entries.reset(new Entry[PAGE_SIZE]);
+    Entry& entry = entries[address & 0xFF];
+    // Instructions crossing into the next page also depend on it
+    if (entry.handler != nullptr && (dword) (address & 0xFF) + entry.length > PAGE_SIZE) refresh(page + 1, memory);
+    if (entry.handler == nullptr) decode(entry, address, memory);
+    return entry;
+}
+
+dword DecodeCache::refresh(byte page, Memory &memory) {
+    if (memory.isPageDirty(page)) {
+        invalidate(page);
+        memory.markPageClean(page);
+    }
+    return generations[page];
+}
+
+void DecodeCache::decode(Entry &entry, word address, const Memory &memory) {
+    const byte opcode = memory[address];
+    const OpcodeInfo& info = opcodeTable[opcode];
+    entry.operand = memory[(word) (address + 1)] | (memory[(word) (address + 2)] << 8);
+    entry.cycles = info.cycles;
+    entry.length = instructionLength(info.mode);
+    entry.handler = CPU::instructionTable<CPU::DecodedCycles>[opcode];
+}
+
+void DecodeCache::invalidate(byte page) {
+    generations[page]++;
+    if (pages[page]) std::fill(pages[page].get(), pages[page].get() + PAGE_SIZE, Entry());
+    // Last instructions of the previous page may have their operands on this one
+    const std::unique_ptr<Entry[]>& previous = pages[(byte) (page - 1)];
+    if (previous) previous[PAGE_SIZE - 2] = previous[PAGE_SIZE - 1] = Entry();
+}
+
+void DecodeCache::clear() {
+    for (std::unique_ptr<Entry[]>& entries : pages) entries.reset();
+    for (dword& generation : generations) generation++;
+}
+
+CPU::Result DecodeCache::execute(CPU &cpu, int budget, Memory &memory) {
+    CPU::DecodedCycles cycles(budget);
+    int cyclesExpected = cycles;
+    while (cycles > 0) {
+        const Entry& entry = lookup(cpu.PC, memory);
+        cycles.remaining -= entry.cycles;
+        cycles.operand = entry.operand;
+        cpu.PC++;
+        entry.handler(cpu, cycles, memory);
+    }
+    cpu.materializeFlags();
+    return cpu.finish(cyclesExpected, cycles);
+}
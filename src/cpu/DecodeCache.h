@@ -0,0 +1,57 @@
+
+#ifndef CPU6502_DECODECACHE_H
+#define CPU6502_DECODECACHE_H
+
+#include <memory>
+#include "CPU.h"
+#include "../memory/Memory.h"
+#include "../types.h"
+
+/** @brief Cache of decoded instructions keyed by PC.
+ *  Each entry holds the handler, the operand and the base cycles of an instruction, so hot code
+ *  runs without fetching and decoding it again. Pages written since they were decoded
+ *  (Memory::isPageDirty) are dropped on the next visit, self-modifying code only invalidates
+ *  the page it writes to.
+ */
+class DecodeCache {
+public:
+    struct Entry {
+        CPU::InstructionHandler<CPU::DecodedCycles> handler = nullptr; /// nullptr until decoded
+        word operand = 0;
+        byte cycles = 0; /// Base cycles (opcode table)
+        byte length = 0; /// Bytes, opcode included
+    };
+
+    /// @brief Entry of the instruction at the address given, decoded on the first visit.
+    const Entry& lookup(word address, Memory& memory);
+
+    /** @brief Drops the page's entries when it was written since it was last decoded.
+     *  Caches built on top of this one check their pages through here, so the dirty bits have a single consumer.
+     *
+     *  @return Generation of the page, increased on every invalidation
+     */
+    dword refresh(byte page, Memory& memory);
+
+    /// @brief Drops every entry overlapping the page given.
+    void invalidate(byte page);
+
+    /// @brief Drops every entry.
+    void clear();
+
+    /** @brief Execute the number of cycles given out of the cache.
+     *  Same results and cycle totals as CPU::execute.
+     *
+     *  @return Why it stopped, Cycles Executed and where
+     */
+    CPU::Result execute(CPU& cpu, int cycles, Memory& memory);
+private:
+    static constexpr dword PAGES = 256;
+    static constexpr dword PAGE_SIZE = 256;
+    std::unique_ptr<Entry[]> pages[PAGES];
+    dword generations[PAGES] = {};
+
+    static void decode(Entry& entry, word address, const Memory& memory);
+};
+
+
+#endif //CPU6502_DECODECACHE_H
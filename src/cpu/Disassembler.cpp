@@ -0,0 +1,31 @@
+#include <cstdio>
+#include "Disassembler.h"
+#include "Opcodes.h"
+
+std::string disassemble(const Memory &memory, word address) {
+    const OpcodeInfo& info = opcodeTable[memory[address]];
+    const byte lo = memory[(word) (address + 1)];
+    const word abs = lo | (memory[(word) (address + 2)] << 8);
+    char text[32];
+    switch (info.mode) {
+        case AddressingMode::Illegal:   snprintf(text, sizeof text, "???"); break;
+        case AddressingMode::Implied:   snprintf(text, sizeof text, "%s", info.mnemonic); break;
+        case AddressingMode::Immediate: snprintf(text, sizeof text, "%s #$%02X", info.mnemonic, lo); break;
+        case AddressingMode::ZeroPage:  snprintf(text, sizeof text, "%s $%02X", info.mnemonic, lo); break;
+        case AddressingMode::ZeroPageX: snprintf(text, sizeof text, "%s $%02X,X", info.mnemonic, lo); break;
+        case AddressingMode::ZeroPageY: snprintf(text, sizeof text, "%s $%02X,Y", info.mnemonic, lo); break;
+        case AddressingMode::Absolute:  snprintf(text, sizeof text, "%s $%04X", info.mnemonic, abs); break;
+        case AddressingMode::AbsoluteX: snprintf(text, sizeof text, "%s $%04X,X", info.mnemonic, abs); break;
+        case AddressingMode::AbsoluteY: snprintf(text, sizeof text, "%s $%04X,Y", info.mnemonic, abs); break;
+        case AddressingMode::Indirect:  snprintf(text, sizeof text, "%s ($%04X)", info.mnemonic, abs); break;
+        case AddressingMode::IndirectX: snprintf(text, sizeof text, "%s ($%02X,X)", info.mnemonic, lo); break;
+        case AddressingMode::IndirectY: snprintf(text, sizeof text, "%s ($%02X),Y", info.mnemonic, lo); break;
+        case AddressingMode::Relative:
+            snprintf(text, sizeof text, "%s $%04X", info.mnemonic, (word) (address + 2 + (sbyte) lo)); break;
+    }
+    return text;
+}
+
+word nextInstructionAddress(const Memory &memory, word address) {
+    return address + instructionLength(opcodeTable[memory[address]].mode);
+}
@@ -0,0 +1,18 @@
+
+#ifndef CPU6502_DISASSEMBLER_H
+#define CPU6502_DISASSEMBLER_H
+
+#include <string>
+#include "../memory/Memory.h"
+#include "../types.h"
+
+/** @brief Disassembles the instruction at the address given (e.g. "LDA $1234,X").
+ *  Opcodes not executed by the CPU are shown as "???".
+ */
+std::string disassemble(const Memory& memory, word address);
+
+/// @brief Address of the instruction following the one at the address given.
+word nextInstructionAddress(const Memory& memory, word address);
+
+
+#endif //CPU6502_DISASSEMBLER_H
@@ -0,0 +1,588 @@
+#include <cstddef>
+#include <cstdint>
+#include "Jit.h"
+#include "Opcodes.h"
+
+#ifdef CPU6502_JIT_X64
+#include <sys/mman.h>
+
+namespace {
+
+/// Registers shared between compiled blocks and the helpers they call.
+struct State {
+    CPU* cpu;
+    Memory* memory;
+    int cycles;
+    dword pc;
+    byte A, X, Y, SP, status;
+    byte firstPage, lastPage;
+
+    void load(const CPU& from) {
+        A = from.A; X = from.X; Y = from.Y; SP = from.SP; status = from.status;
+    }
+
+    void store(CPU& to) const {
+        to.A = A; to.X = X; to.Y = Y; to.SP = SP; to.status = status;
+    }
+
+    bool blockWritten() const {
+        return memory->isPageDirty(firstPage) || memory->isPageDirty(lastPage);
+    }
+};
+
+dword readByte(State* state, dword address) {
+    return (*static_cast<const Memory*>(state->memory))[(word) address];
+}
+
+dword readWord(State* state, dword address) {
+    return state->memory->readWord((word) address);
+}
+
+/// @return Whether the block running must stop, it wrote to its own pages
+dword writeByte(State* state, dword address, dword value) {
+    state->memory->write((word) address, (byte) value);
+    return state->blockWritten();
+}
+
+/// @brief Runs an instruction without a native translation on the interpreter handler.
+/// @return Whether the block running must stop, it wrote to its own pages
+dword interpret(State* state, CPU::InstructionHandler<CPU::DecodedCycles> handler,
+                dword operand, dword cycles, dword address) {
+    CPU& cpu = *state->cpu;
+    state->store(cpu);
+    cpu.PC = address + 1;
+    CPU::DecodedCycles decoded(state->cycles);
+    decoded.remaining -= cycles;
+    decoded.operand = operand;
+    handler(cpu, decoded, *state->memory);
+    cpu.materializeFlags();
+    state->load(cpu);
+    state->cycles = decoded.remaining;
+    state->pc = cpu.PC;
+    return state->blockWritten();
+}
+
+/// N and Z flags of every value
+struct FlagTable {
+    byte flags[0x100];
+
+    FlagTable() {
+        for (dword value = 0; value <= 0xFF; value++) {
+            flags[value] = (value & CPU::FLAG_N) | (value == 0 ? CPU::FLAG_Z : 0);
+        }
+    }
+};
+
+const FlagTable assignmentFlags;
+
+enum Reg : byte { RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, R10, R11, R12, R13, R14, R15 };
+enum Condition : byte { IF_OVERFLOW = 0x0, IF_CARRY = 0x2, IF_ZERO = 0x4, IF_NOT_ZERO = 0x5, IF_GREATER = 0xF };
+enum AluOp : byte { ADD = 0, OR = 1, AND = 4, SUB = 5, XOR = 6 };
+
+// 6502 registers live in callee saved registers, so helper calls leave them untouched
+const Reg STATE = RBX, REG_P = RBP, REG_A = R12, REG_X = R13, REG_Y = R14, REG_SP = R15;
+
+/// @brief Minimal x86-64 encoder, 32 bit operations unless stated otherwise.
+class Emitter {
+public:
+    Emitter(byte* buffer, dword capacity) : buffer(buffer), capacity(capacity) {}
+
+    dword size() const { return used; }
+    bool overflowed() const { return used > capacity; }
+
+    void emit8(byte value) { if (used < capacity) buffer[used] = value; used++; }
+    void emit32(dword value) { for (int i = 0; i < 4; i++) emit8(value >> 8 * i); }
+    void emit64(std::uint64_t value) { for (int i = 0; i < 8; i++) emit8(value >> 8 * i); }
+
+    void push(Reg reg) { rex(false, RAX, reg); emit8(0x50 + (reg & 7)); }
+    void pop(Reg reg) { rex(false, RAX, reg); emit8(0x58 + (reg & 7)); }
+    void ret() { emit8(0xC3); }
+    void mov(Reg dst, Reg src) { rex(false, src, dst); emit8(0x89); modrm(3, src, dst); }
+    void mov64(Reg dst, Reg src) { rex(true, src, dst); emit8(0x89); modrm(3, src, dst); }
+    void movImm(Reg dst, dword value) { rex(false, RAX, dst); emit8(0xB8 + (dst & 7)); emit32(value); }
+    void movImm64(Reg dst, std::uint64_t value) { rex(true, RAX, dst); emit8(0xB8 + (dst & 7)); emit64(value); }
+    /// movzx dst, src8
+    void movzx(Reg dst, Reg src) { rex(false, dst, src, true); emit8(0x0F); emit8(0xB6); modrm(3, dst, src); }
+    /// movzx dst, byte [base + index]
+    void movzx(Reg dst, Reg base, Reg index) {
+        emit8(0x40 | (dst >> 3) << 2 | (index >> 3) << 1 | base >> 3);
+        emit8(0x0F); emit8(0xB6); modrm(0, dst, RSP); modrm(0, index, base);
+    }
+    void alu(AluOp op, Reg dst, dword value) { rex(false, RAX, dst); emit8(0x81); modrm(3, op, dst); emit32(value); }
+    void alu(AluOp op, Reg dst, Reg src) { rex(false, src, dst); emit8(op << 3 | 1); modrm(3, src, dst); }
+    /// adc dst8, src8
+    void adc8(Reg dst, Reg src) { rex(false, src, dst, true); emit8(0x10); modrm(3, src, dst); }
+    void inc8(Reg reg) { rex(false, RAX, reg, true); emit8(0xFE); modrm(3, 0, reg); }
+    void dec8(Reg reg) { rex(false, RAX, reg, true); emit8(0xFE); modrm(3, 1, reg); }
+    void shl(Reg reg, byte count) { rex(false, RAX, reg); emit8(0xC1); modrm(3, 4, reg); emit8(count); }
+    void test(Reg reg, dword value) { rex(false, RAX, reg); emit8(0xF7); modrm(3, 0, reg); emit32(value); }
+    void test(Reg a, Reg b) { rex(false, b, a); emit8(0x85); modrm(3, b, a); }
+    /// bt reg, bit (carry = bit)
+    void bt(Reg reg, byte bit) { rex(false, RAX, reg); emit8(0x0F); emit8(0xBA); modrm(3, 4, reg); emit8(bit); }
+    void set(Condition condition, Reg reg) { rex(false, RAX, reg, true); emit8(0x0F); emit8(0x90 + condition); modrm(3, 0, reg); }
+    void call(const void* function) { movImm64(RAX, (std::uint64_t) function); emit8(0xFF); modrm(3, 2, RAX); }
+    void addRsp(byte value) { emit8(0x48); emit8(0x83); modrm(3, ADD, RSP); emit8(value); }
+    void subRsp(byte value) { emit8(0x48); emit8(0x83); modrm(3, SUB, RSP); emit8(value); }
+
+    /// mov [rsp], src
+    void saveTemp(Reg src) { rex(false, src, RSP); emit8(0x89); modrm(0, src, RSP); emit8(0x24); }
+    /// mov dst, [rsp]
+    void loadTemp(Reg dst) { rex(false, dst, RSP); emit8(0x8B); modrm(0, dst, RSP); emit8(0x24); }
+
+    /// movzx dst, byte [STATE + field]
+    void loadField(Reg dst, dword field) { rex(false, dst, STATE); emit8(0x0F); emit8(0xB6); modrm(2, dst, STATE); emit32(field); }
+    /// mov byte [STATE + field], src8
+    void storeField(dword field, Reg src) { rex(false, src, STATE, true); emit8(0x88); modrm(2, src, STATE); emit32(field); }
+    /// mov dword [STATE + field], value
+    void storeField32(dword field, dword value) { emit8(0xC7); modrm(2, 0, STATE); emit32(field); emit32(value); }
+    /// sub dword [STATE + field], value
+    void subField32(dword field, dword value) { emit8(0x81); modrm(2, SUB, STATE); emit32(field); emit32(value); }
+    /// cmp dword [STATE + field], value
+    void cmpField32(dword field, dword value) { emit8(0x81); modrm(2, 7, STATE); emit32(field); emit32(value); }
+
+    /// @return Position of the displacement, see bind()
+    dword jump(Condition condition) { emit8(0x0F); emit8(0x80 + condition); emit32(0); return used - 4; }
+    /// @brief Jump to a position already emitted.
+    void jump(Condition condition, dword target) { emit8(0x0F); emit8(0x80 + condition); emit32(target - (used + 4)); }
+    /// @brief Makes the jump at the position given land here.
+    void bind(dword position) {
+        const dword displacement = used - (position + 4);
+        for (int i = 0; i < 4; i++) {
+            if (position + i < capacity) buffer[position + i] = (byte) (displacement >> 8 * i);
+        }
+    }
+private:
+    byte* buffer;
+    dword capacity;
+    dword used = 0;
+
+    void rex(bool wide, byte reg, byte rm, bool force = false) {
+        const byte value = 0x40 | wide << 3 | (reg >> 3) << 2 | rm >> 3;
+        if (value != 0x40 || force) emit8(value);
+    }
+
+    void modrm(byte mod, byte reg, byte rm) { emit8(mod << 6 | (reg & 7) << 3 | (rm & 7)); }
+};
+
+/// @brief Whether the block may be an idle loop the interpreter handlers fast forward (see CPU::idleSkip):
+/// at most one instruction then a jump or branch back to its start.
+bool mayBeIdle(const BlockCache::Block& block) {
+    if (block.ops.size() > 2) return false;
+    const BlockCache::MicroOp& last = block.ops.back();
+    const OpcodeInfo& info = opcodeTable[last.opcode];
+    const word end = block.end;
+    if (info.mode == AddressingMode::Relative) return (word) (end + (sbyte) (last.operand & 0xFF)) == block.start;
+    return info.operation == Operation::Jmp && info.mode == AddressingMode::Absolute && last.operand == block.start;
+}
+
+/// @brief Translates one block, cycles are charged to the state at exits and helper calls.
+class Compiler {
+public:
+    explicit Compiler(Emitter& out) : out(out) {}
+
+    void compile(const BlockCache::Block& block) {
+        start = block.start;
+        worstCycles = block.worstCycles;
+        prologue();
+        body = out.size();
+        word address = block.start;
+        for (BlockCache::MicroOp op : block.ops) {
+            const OpcodeInfo& info = opcodeTable[op.opcode];
+            const word next = address + instructionLength(info.mode);
+            // Decoded operands of two byte instructions carry the next byte too
+            if (instructionLength(info.mode) == 2) op.operand &= 0xFF;
+            // Illegal opcodes are left to the interpreter, exceptions can't unwind through native code
+            if (!info.isLegal()) return exit(address, pending);
+            if (info.mode == AddressingMode::Relative) return branch(info, op, next);
+            if (info.operation == Operation::Jmp && info.mode == AddressingMode::Absolute) {
+                return jumpExit(op.operand, pending + info.cycles);
+            }
+            if (!translate(info, op, next)) {
+                interpret(op, address);
+                if (info.changesFlow) return epilogue();
+            }
+            address = next;
+        }
+        exit(address, pending);
+    }
+private:
+    Emitter& out;
+    int pending = 0; /// Cycles not charged to the state yet
+    word start = 0;
+    int worstCycles = 0;
+    dword body = 0;  /// Position following the prologue
+
+    static Reg reg(Register name) {
+        switch (name) {
+            case Register::A: return REG_A;
+            case Register::X: return REG_X;
+            case Register::Y: return REG_Y;
+            default: return REG_SP;
+        }
+    }
+
+    void prologue() {
+        for (Reg reg : {RBX, RBP, R12, R13, R14, R15}) out.push(reg);
+        out.subRsp(8); // Aligns the stack for calls and holds a temporary
+        out.mov64(STATE, RDI);
+        out.loadField(REG_A, offsetof(State, A));
+        out.loadField(REG_X, offsetof(State, X));
+        out.loadField(REG_Y, offsetof(State, Y));
+        out.loadField(REG_SP, offsetof(State, SP));
+        out.loadField(REG_P, offsetof(State, status));
+    }
+
+    void storeRegisters() {
+        out.storeField(offsetof(State, A), REG_A);
+        out.storeField(offsetof(State, X), REG_X);
+        out.storeField(offsetof(State, Y), REG_Y);
+        out.storeField(offsetof(State, SP), REG_SP);
+        out.storeField(offsetof(State, status), REG_P);
+    }
+
+    /// @brief Leaves the block, with the PC already in the state.
+    void epilogue() {
+        storeRegisters();
+        out.addRsp(8);
+        for (Reg reg : {R15, R14, R13, R12, RBP, RBX}) out.pop(reg);
+        out.ret();
+    }
+
+    void exit(word pc, int cycles) {
+        if (cycles != 0) out.subField32(offsetof(State, cycles), cycles);
+        out.storeField32(offsetof(State, pc), pc);
+        epilogue();
+    }
+
+    /// @brief Leaves through a jump or taken branch, blocks jumping to their own start loop without leaving.
+    void jumpExit(word target, int cycles) {
+        if (target == start) {
+            out.subField32(offsetof(State, cycles), cycles);
+            // The block's pages are unchanged, or a write would have left, so only the budget needs a check
+            out.cmpField32(offsetof(State, cycles), worstCycles);
+            out.jump(IF_GREATER, body);
+            cycles = 0;
+        }
+        exit(target, cycles);
+    }
+
+    void chargePending() {
+        if (pending != 0) out.subField32(offsetof(State, cycles), pending);
+        pending = 0;
+    }
+
+    void penalty() {
+        out.subField32(offsetof(State, cycles), 1);
+    }
+
+    void callHelper(const void* helper) {
+        out.mov64(RDI, STATE);
+        out.call(helper);
+    }
+
+    /// @brief Leaves at the next instruction if the write just made hit the block's pages.
+    void checkWrite(word next) {
+        const dword skip = out.jump(IF_ZERO);
+        exit(next, pending);
+        out.bind(skip);
+    }
+
+    void setFlags(Reg value) {
+        out.movzx(RDX, value);
+        out.movImm64(RCX, (std::uint64_t) assignmentFlags.flags);
+        out.movzx(RDX, RCX, RDX);
+        out.alu(AND, REG_P, (byte) ~(CPU::FLAG_N | CPU::FLAG_Z));
+        out.alu(OR, REG_P, RDX);
+    }
+
+    void setFlags(byte value) {
+        out.alu(AND, REG_P, (byte) ~(CPU::FLAG_N | CPU::FLAG_Z));
+        if (assignmentFlags.flags[value] != 0) out.alu(OR, REG_P, assignmentFlags.flags[value]);
+    }
+
+    /// @brief Page crossing penalty between the base address in RAX and the final address in RSI.
+    void pageCrossing() {
+        out.alu(XOR, RAX, RSI);
+        out.test(RAX, 0x100);
+        const dword skip = out.jump(IF_ZERO);
+        penalty();
+        out.bind(skip);
+    }
+
+    /// @brief Effective address into RSI.
+    void address(AddressingMode mode, word operand, bool pageCross) {
+        switch (mode) {
+            case AddressingMode::ZeroPage:
+            case AddressingMode::Absolute:
+                out.movImm(RSI, operand);
+                break;
+            case AddressingMode::ZeroPageX:
+            case AddressingMode::ZeroPageY:
+                out.mov(RSI, mode == AddressingMode::ZeroPageX ? REG_X : REG_Y);
+                out.alu(ADD, RSI, operand);
+                out.alu(AND, RSI, 0xFF);
+                break;
+            case AddressingMode::AbsoluteX:
+            case AddressingMode::AbsoluteY:
+                out.mov(RSI, mode == AddressingMode::AbsoluteX ? REG_X : REG_Y);
+                out.alu(ADD, RSI, operand);
+                out.alu(AND, RSI, 0xFFFF);
+                if (!pageCross) break;
+                out.movImm(RAX, operand);
+                pageCrossing();
+                break;
+            case AddressingMode::IndirectX:
+                out.mov(RSI, REG_X);
+                out.alu(ADD, RSI, operand);
+                out.alu(AND, RSI, 0xFF);
+                callHelper((const void*) readWord);
+                out.mov(RSI, RAX);
+                break;
+            case AddressingMode::IndirectY:
+                out.movImm(RSI, operand);
+                callHelper((const void*) readWord);
+                out.mov(RSI, REG_Y);
+                out.alu(ADD, RSI, RAX);
+                out.alu(AND, RSI, 0xFFFF);
+                if (pageCross) pageCrossing();
+                break;
+            default: break;
+        }
+    }
+
+    /// @brief Operand value into RAX.
+    void read(const OpcodeInfo& info, word operand) {
+        if (info.mode == AddressingMode::Immediate) return out.movImm(RAX, operand & 0xFF);
+        address(info.mode, operand, info.pageCrossCycles != 0);
+        callHelper((const void*) readByte);
+    }
+
+    /// @return false when the instruction has no native translation
+    bool translate(const OpcodeInfo& info, const BlockCache::MicroOp& op, word next) {
+        using O = Operation;
+        switch (info.operation) {
+            case O::Lda: case O::Ldx: case O::Ldy: {
+                pending += info.cycles;
+                const Reg target = reg(targetOf(info.operation));
+                if (info.mode == AddressingMode::Immediate) {
+                    out.movImm(target, op.operand & 0xFF);
+                    setFlags((byte) op.operand);
+                } else {
+                    read(info, op.operand);
+                    out.mov(target, RAX);
+                    setFlags(target);
+                }
+            } break;
+            case O::Sta: case O::Stx: case O::Sty: {
+                pending += info.cycles;
+                address(info.mode, op.operand, false);
+                out.mov(RDX, reg(sourceOf(info.operation)));
+                callHelper((const void*) writeByte);
+                out.test(RAX, RAX);
+                checkWrite(next);
+            } break;
+            case O::And: case O::Ora: case O::Eor: {
+                pending += info.cycles;
+                read(info, op.operand);
+                out.alu(info.operation == O::And ? AND : info.operation == O::Ora ? OR : XOR, REG_A, RAX);
+                setFlags(REG_A);
+            } break;
+            case O::Adc: {
+                pending += info.cycles;
+                read(info, op.operand);
+                out.bt(REG_P, 0);
+                out.adc8(REG_A, RAX);
+                out.set(IF_CARRY, RCX);
+                out.set(IF_OVERFLOW, RDX);
+                out.alu(AND, REG_P, (byte) ~(CPU::FLAG_C | CPU::FLAG_V));
+                out.movzx(RCX, RCX);
+                out.alu(OR, REG_P, RCX);
+                out.movzx(RDX, RDX);
+                out.shl(RDX, 6);
+                out.alu(OR, REG_P, RDX);
+                setFlags(REG_A);
+            } break;
+            case O::Bit: {
+                pending += info.cycles;
+                read(info, op.operand);
+                out.alu(AND, REG_P, (byte) ~(CPU::FLAG_N | CPU::FLAG_V | CPU::FLAG_Z));
+                out.mov(RCX, RAX);
+                out.alu(AND, RCX, CPU::FLAG_N | CPU::FLAG_V);
+                out.alu(OR, REG_P, RCX);
+                out.test(REG_A, RAX);
+                out.set(IF_ZERO, RCX);
+                out.movzx(RCX, RCX);
+                out.shl(RCX, 1);
+                out.alu(OR, REG_P, RCX);
+            } break;
+            case O::Inc: case O::Dec: {
+                pending += info.cycles;
+                address(info.mode, op.operand, false);
+                out.saveTemp(RSI);
+                callHelper((const void*) readByte);
+                if (info.operation == O::Inc) out.inc8(RAX); else out.dec8(RAX);
+                setFlags(RAX);
+                out.mov(RDX, RAX);
+                out.loadTemp(RSI);
+                callHelper((const void*) writeByte);
+                out.test(RAX, RAX);
+                checkWrite(next);
+            } break;
+            case O::Inx: case O::Iny: case O::Dex: case O::Dey: {
+                pending += info.cycles;
+                const Reg target = reg(targetOf(info.operation));
+                if (info.operation == O::Inx || info.operation == O::Iny) out.inc8(target); else out.dec8(target);
+                setFlags(target);
+            } break;
+            case O::Tax: case O::Tay: case O::Txa: case O::Tya: case O::Tsx: case O::Txs: {
+                pending += info.cycles;
+                const Reg target = reg(targetOf(info.operation));
+                out.mov(target, reg(sourceOf(info.operation)));
+                if (info.flagsWritten) setFlags(target);
+            } break;
+            // CLI is left to its handler, which may end the run for a waiting IRQ (see CPU::yieldOnUnmask)
+            case O::Clc: case O::Cld: case O::Clv: case O::Sec: case O::Sed: case O::Sei: {
+                pending += info.cycles;
+                if (setsFlag(info.operation)) out.alu(OR, REG_P, info.flagsWritten);
+                else out.alu(AND, REG_P, (byte) ~info.flagsWritten);
+            } break;
+            case O::Nop: pending += info.cycles; break;
+            default: return false;
+        }
+        return true;
+    }
+
+    void interpret(const BlockCache::MicroOp& op, word address) {
+        chargePending();
+        storeRegisters();
+        out.mov64(RDI, STATE);
+        out.movImm64(RSI, (std::uint64_t) op.handler);
+        out.movImm(RDX, op.operand);
+        out.movImm(RCX, op.cycles);
+        out.movImm(R8, address);
+        out.call((const void*) ::interpret);
+        out.loadField(REG_A, offsetof(State, A));
+        out.loadField(REG_X, offsetof(State, X));
+        out.loadField(REG_Y, offsetof(State, Y));
+        out.loadField(REG_SP, offsetof(State, SP));
+        out.loadField(REG_P, offsetof(State, status));
+        out.test(RAX, RAX);
+        const dword skip = out.jump(IF_ZERO);
+        epilogue();
+        out.bind(skip);
+    }
+
+    void branch(const OpcodeInfo& info, const BlockCache::MicroOp& op, word next) {
+        pending += info.cycles;
+        const word target = next + (sbyte) op.operand;
+        out.test(REG_P, info.flagsRead);
+        const dword notTaken = out.jump(branchesWhenSet(info.operation) ? IF_ZERO : IF_NOT_ZERO);
+        jumpExit(target, pending + 1 + (((target ^ next) & 0x0100) != 0));
+        out.bind(notTaken);
+        exit(next, pending);
+    }
+};
+
+}
+
+Jit::Jit(BlockCache &blockCache) : blockCache(blockCache) {}
+
+Jit::~Jit() {
+    if (buffer) munmap(buffer, CODE_SIZE);
+}
+
+bool Jit::isSupported() {
+    return !CPU::STATS && !CPU::TRACE;
+}
+
+Jit::NativeBlock Jit::compile(const BlockCache::Block &block) {
+    if (!buffer) {
+        void* mapping = mmap(nullptr, CODE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapping == MAP_FAILED) return nullptr;
+        buffer = static_cast<byte*>(mapping);
+    } else if (mprotect(buffer, CODE_SIZE, PROT_READ | PROT_WRITE) != 0) {
+        return nullptr;
+    }
+    // Out of space, start over
+    if (CODE_SIZE - used < MAX_BLOCK_CODE) clear();
+    Emitter out(buffer + used, MAX_BLOCK_CODE);
+    Compiler(out).compile(block);
+    const NativeBlock code = out.overflowed() ? nullptr : reinterpret_cast<NativeBlock>(buffer + used);
+    if (code) used += out.size();
+    mprotect(buffer, CODE_SIZE, PROT_READ | PROT_EXEC);
+    return code;
+}
+
+Jit::NativeBlock Jit::lookup(const BlockCache::Block &block, dword threshold) {
+    Native& native = natives[block.start];
+    if (native.generations[0] != block.generations[0] || native.generations[1] != block.generations[1]) {
+        native = Native();
+        native.generations[0] = block.generations[0];
+        native.generations[1] = block.generations[1];
+    }
+    if (!native.code && ++native.runs >= threshold && opcodeTable[block.ops.front().opcode].isLegal()) {
+        Native compiled = native;
+        compiled.code = compile(block);
+        // Compiling may have dropped every entry to make room
+        natives[block.start] = compiled;
+        return compiled.code;
+    }
+    return native.code;
+}
+
+bool Jit::run(const BlockCache::Block &block, CPU &cpu, CPU::DecodedCycles &cycles, Memory &memory, dword threshold) {
+    // Blocks that could outlast the budget run one micro-op at a time, idle loops on handlers that skip them
+    const bool native = !CPU::STATS && !CPU::TRACE && cycles > block.worstCycles && !(cpu.idleSkip && mayBeIdle(block));
+    const NativeBlock code = native ? lookup(block, threshold) : nullptr;
+    if (!code) return BlockCache::run(block, cpu, cycles, memory);
+    State state{&cpu, &memory, cycles.remaining, cpu.PC, cpu.A, cpu.X, cpu.Y, cpu.SP, cpu.status,
+                block.firstPage, block.lastPage};
+    code(&state);
+    state.store(cpu);
+    cpu.PC = state.pc;
+    cycles.remaining = state.cycles;
+    nativeRuns++;
+    return true;
+}
+
+void Jit::clear() {
+    natives.clear();
+    used = 0;
+}
+
+#else
+
+Jit::Jit(BlockCache &blockCache) : blockCache(blockCache) {}
+
+Jit::~Jit() = default;
+
+bool Jit::isSupported() {
+    return false;
+}
+
+bool Jit::run(const BlockCache::Block &block, CPU &cpu, CPU::DecodedCycles &cycles, Memory &memory, dword) {
+    return BlockCache::run(block, cpu, cycles, memory);
+}
+
+void Jit::clear() {
+    natives.clear();
+}
+
+#endif
+
+CPU::Result Jit::execute(CPU &cpu, int budget, Memory &memory) {
+    CPU::DecodedCycles cycles(budget);
+    int cyclesExpected = cycles;
+    BlockCache::Block* previous = nullptr;
+    while (cycles > 0) {
+        BlockCache::Block& block = blockCache.successor(previous, cpu.PC, memory);
+        previous = run(block, cpu, cycles, memory, hotThreshold) ? &block : nullptr;
+    }
+    return cpu.finish(cyclesExpected, cycles);
+}
+
+dword Jit::size() const {
+    dword compiled = 0;
+    for (const auto& entry : natives) compiled += entry.second.code != nullptr;
+    return compiled;
+}
@@ -0,0 +1,77 @@
+
+#ifndef CPU6502_JIT_H
+#define CPU6502_JIT_H
+
+#include <cstdint>
+#include <unordered_map>
+#include "CPU.h"
+#include "BlockCache.h"
+#include "../memory/Memory.h"
+#include "../types.h"
+
+/// Native code is only generated on x86-64 System V hosts, elsewhere the Jit runs the block cache.
+#if defined(__x86_64__) && (defined(__unix__) || defined(__APPLE__))
+#define CPU6502_JIT_X64
+#endif
+
+/** @brief Dynamic recompiler translating hot blocks of a BlockCache into x86-64 code.
+ *  Compiled blocks keep A, X, Y, SP and the status register in host registers from entry to exit and
+ *  charge the same cycles as CPU::execute. Instructions without a native translation call their
+ *  interpreter handler from the compiled block, memory is accessed through the Memory class.
+ */
+class Jit {
+public:
+    static constexpr dword CODE_SIZE = 1 << 22; /// Bytes of the executable buffer
+    static constexpr dword MAX_BLOCK_CODE = 1 << 14;
+
+    dword hotThreshold = 8;        /// Runs of a block before execute() compiles it
+    std::uint64_t nativeRuns = 0;  /// Blocks run as native code
+
+    explicit Jit(BlockCache& blockCache);
+    ~Jit();
+    Jit(const Jit&) = delete;
+    Jit& operator=(const Jit&) = delete;
+
+    /// @brief Whether native code can be generated on this host, and in this build (native code doesn't count stats or trace).
+    static bool isSupported();
+
+    /** @brief Execute the number of cycles given, compiling the blocks that get hot.
+     *  Blocks that could exceed the budget run on the block cache, so the results and
+     *  cycle totals are the same as CPU::execute.
+     *
+     *  @return Why it stopped, Cycles Executed and where
+     */
+    CPU::Result execute(CPU& cpu, int cycles, Memory& memory);
+
+    /** @brief Runs the block given (PC must be at its start), as native code once it ran threshold times.
+     *  Blocks that could outlast the budget run on the block cache.
+     *
+     *  @return false when the block stopped early because it wrote to its own pages
+     */
+    bool run(const BlockCache::Block& block, CPU& cpu, CPU::DecodedCycles& cycles, Memory& memory, dword threshold);
+
+    /// @brief Drops every compiled block.
+    void clear();
+
+    /// @brief Number of blocks compiled and still valid.
+    dword size() const;
+private:
+    using NativeBlock = void (*)(void* state);
+
+    struct Native {
+        NativeBlock code = nullptr;
+        dword generations[2] = {0, 0}; /// Block generations the code was compiled from
+        dword runs = 0;
+    };
+
+    BlockCache& blockCache;
+    std::unordered_map<word, Native> natives; /// By start address, blocks may be freed and translated again
+    byte* buffer = nullptr;
+    dword used = 0;
+
+    NativeBlock lookup(const BlockCache::Block& block, dword threshold);
+    NativeBlock compile(const BlockCache::Block& block);
+};
+
+
+#endif //CPU6502_JIT_H
@@ -0,0 +1,292 @@
+
+#ifndef CPU6502_OPCODES_H
+#define CPU6502_OPCODES_H
+
+#include "CPU.h"
+
+/// @brief Addressing Modes
+enum class AddressingMode : byte {
+    Illegal,    /// Opcode not executed by the CPU
+    Implied,    /// OPC
+    Immediate,  /// OPC #$BB
+    ZeroPage,   /// OPC $LL
+    ZeroPageX,  /// OPC $LL,X
+    ZeroPageY,  /// OPC $LL,Y
+    Absolute,   /// OPC $LLHH
+    AbsoluteX,  /// OPC $LLHH,X
+    AbsoluteY,  /// OPC $LLHH,Y
+    Indirect,   /// OPC ($LLHH)
+    IndirectX,  /// OPC ($LL,X)
+    IndirectY,  /// OPC ($LL),Y
+    Relative,   /// OPC $BB
+};
+
+/// @brief Operations, what an opcode does whatever its addressing mode
+enum class Operation : byte {
+    Illegal,                                       /// Opcode not executed by the CPU
+    Lda, Ldx, Ldy, Sta, Stx, Sty,                  /// Loads and stores
+    And, Eor, Ora, Adc, Bit,                       /// Accumulator and BIT
+    Tax, Txa, Tay, Tya, Tsx, Txs,                  /// Transfers
+    Pha, Php, Pla, Plp,                            /// Stack
+    Inc, Inx, Iny, Dec, Dex, Dey,                  /// Increments and decrements
+    Clc, Cld, Cli, Clv, Sec, Sed, Sei,             /// Flags
+    Bcc, Bcs, Beq, Bmi, Bne, Bpl, Bvc, Bvs,        /// Branches
+    Jmp, Jsr, Rts, Rti,                            /// Jumps and calls
+    Nop,
+};
+
+/// @brief Registers an operation reads or writes
+enum class Register : byte {
+    None,
+    A,
+    X,
+    Y,
+    SP,
+};
+
+/// @brief Mnemonic of an operation.
+constexpr const char* mnemonicOf(Operation operation) {
+    constexpr const char* names[] = {
+        "???",
+        "LDA", "LDX", "LDY", "STA", "STX", "STY",
+        "AND", "EOR", "ORA", "ADC", "BIT",
+        "TAX", "TXA", "TAY", "TYA", "TSX", "TXS",
+        "PHA", "PHP", "PLA", "PLP",
+        "INC", "INX", "INY", "DEC", "DEX", "DEY",
+        "CLC", "CLD", "CLI", "CLV", "SEC", "SED", "SEI",
+        "BCC", "BCS", "BEQ", "BMI", "BNE", "BPL", "BVC", "BVS",
+        "JMP", "JSR", "RTS", "RTI",
+        "NOP",
+    };
+    return names[(byte) operation];
+}
+
+/// @brief Register an operation reads its value from (stores, transfers, pushes, increments and decrements).
+constexpr Register sourceOf(Operation operation) {
+    using O = Operation;
+    switch (operation) {
+        case O::Sta: case O::Tax: case O::Tay: case O::Pha: return Register::A;
+        case O::Stx: case O::Txa: case O::Txs: case O::Inx: case O::Dex: return Register::X;
+        case O::Sty: case O::Tya: case O::Iny: case O::Dey: return Register::Y;
+        case O::Tsx: return Register::SP;
+        default: return Register::None;
+    }
+}
+
+/// @brief Register an operation writes its result to (loads, transfers, pulls, increments and decrements).
+constexpr Register targetOf(Operation operation) {
+    using O = Operation;
+    switch (operation) {
+        case O::Lda: case O::Txa: case O::Tya: case O::Pla: return Register::A;
+        case O::Ldx: case O::Tax: case O::Tsx: case O::Inx: case O::Dex: return Register::X;
+        case O::Ldy: case O::Tay: case O::Iny: case O::Dey: return Register::Y;
+        case O::Txs: return Register::SP;
+        default: return Register::None;
+    }
+}
+
+/// @brief Whether a flag instruction sets its flag (SEC, SED, SEI) rather than clearing it, see OpcodeInfo::flagsWritten.
+constexpr bool setsFlag(Operation operation) {
+    return operation == Operation::Sec || operation == Operation::Sed || operation == Operation::Sei;
+}
+
+/// @brief Whether a branch is taken when the flag it tests (OpcodeInfo::flagsRead) is set rather than clear.
+constexpr bool branchesWhenSet(Operation operation) {
+    return operation == Operation::Bcs || operation == Operation::Beq
+        || operation == Operation::Bmi || operation == Operation::Bvs;
+}
+
+/// @brief Static facts about an opcode, as executed by CPU::execute.
+struct OpcodeInfo {
+    const char* mnemonic = "???";
+    Operation operation = Operation::Illegal;
+    AddressingMode mode = AddressingMode::Illegal;
+    byte cycles = 0;          /// Base cycles (branch not taken, no page boundary crossed)
+    byte pageCrossCycles = 0; /// Extra cycles when a page boundary is crossed (branches: only when taken)
+    byte flagsRead = 0;       /// Status flags the result depends on (CPU::FLAG_*)
+    byte flagsWritten = 0;    /// Status flags changed (CPU::FLAG_*)
+    bool writesMemory = false;
+    bool changesFlow = false; /// Branches, jumps, calls and returns
+
+    constexpr bool isLegal() const { return mode != AddressingMode::Illegal; }
+};
+
+/// @brief Number of bytes (opcode included) an instruction with the addressing mode given takes.
+constexpr byte instructionLength(AddressingMode mode) {
+    switch (mode) {
+        case AddressingMode::Illegal:
+        case AddressingMode::Implied: return 1;
+        case AddressingMode::Absolute:
+        case AddressingMode::AbsoluteX:
+        case AddressingMode::AbsoluteY:
+        case AddressingMode::Indirect: return 3;
+        default: return 2;
+    }
+}
+
+/// @brief Descriptor of every opcode, indexed by opcode.
+struct OpcodeTable {
+    OpcodeInfo entries[0x100];
+
+    constexpr const OpcodeInfo& operator[](byte opcode) const { return entries[opcode]; }
+
+    constexpr void set(byte opcode, Operation operation, AddressingMode mode, byte cycles, byte pageCrossCycles,
+                       byte flagsRead, byte flagsWritten, bool writesMemory = false, bool changesFlow = false) {
+        OpcodeInfo& info = entries[opcode];
+        info.mnemonic = mnemonicOf(operation);
+        info.operation = operation;
+        info.mode = mode;
+        info.cycles = cycles;
+        info.pageCrossCycles = pageCrossCycles;
+        info.flagsRead = flagsRead;
+        info.flagsWritten = flagsWritten;
+        info.writesMemory = writesMemory;
+        info.changesFlow = changesFlow;
+    }
+};
+
+constexpr OpcodeTable makeOpcodeTable() {
+    using M = AddressingMode;
+    using O = Operation;
+    const byte NZ = CPU::FLAG_N | CPU::FLAG_Z;
+    const byte ALL = CPU::FLAG_N | CPU::FLAG_V | CPU::FLAG_B | CPU::FLAG_D | CPU::FLAG_I | CPU::FLAG_Z | CPU::FLAG_C;
+    OpcodeTable t{};
+    // LDA
+    t.set(CPU::ldaImm, O::Lda, M::Immediate, 2, 0, 0, NZ);
+    t.set(CPU::ldaZpg, O::Lda, M::ZeroPage,  3, 0, 0, NZ);
+    t.set(CPU::ldaZpX, O::Lda, M::ZeroPageX, 4, 0, 0, NZ);
+    t.set(CPU::ldaAbs, O::Lda, M::Absolute,  4, 0, 0, NZ);
+    t.set(CPU::ldaAbX, O::Lda, M::AbsoluteX, 4, 1, 0, NZ);
+    t.set(CPU::ldaAbY, O::Lda, M::AbsoluteY, 4, 1, 0, NZ);
+    t.set(CPU::ldaIdX, O::Lda, M::IndirectX, 6, 0, 0, NZ);
+    t.set(CPU::ldaIdY, O::Lda, M::IndirectY, 5, 1, 0, NZ);
+    // LDX
+    t.set(CPU::ldxImm, O::Ldx, M::Immediate, 2, 0, 0, NZ);
+    t.set(CPU::ldxZpg, O::Ldx, M::ZeroPage,  3, 0, 0, NZ);
+    t.set(CPU::ldxZpY, O::Ldx, M::ZeroPageY, 4, 0, 0, NZ);
+    t.set(CPU::ldxAbs, O::Ldx, M::Absolute,  4, 0, 0, NZ);
+    t.set(CPU::ldxAbY, O::Ldx, M::AbsoluteY, 4, 1, 0, NZ);
+    // LDY
+    t.set(CPU::ldyImm, O::Ldy, M::Immediate, 2, 0, 0, NZ);
+    t.set(CPU::ldyZpg, O::Ldy, M::ZeroPage,  3, 0, 0, NZ);
+    t.set(CPU::ldyZpX, O::Ldy, M::ZeroPageX, 4, 0, 0, NZ);
+    t.set(CPU::ldyAbs, O::Ldy, M::Absolute,  4, 0, 0, NZ);
+    t.set(CPU::ldyAbX, O::Ldy, M::AbsoluteX, 4, 1, 0, NZ);
+    // STA
+    t.set(CPU::staZpg, O::Sta, M::ZeroPage,  3, 0, 0, 0, true);
+    t.set(CPU::staZpX, O::Sta, M::ZeroPageX, 4, 0, 0, 0, true);
+    t.set(CPU::staAbs, O::Sta, M::Absolute,  4, 0, 0, 0, true);
+    t.set(CPU::staAbX, O::Sta, M::AbsoluteX, 5, 0, 0, 0, true);
+    t.set(CPU::staAbY, O::Sta, M::AbsoluteY, 5, 0, 0, 0, true);
+    t.set(CPU::staIdX, O::Sta, M::IndirectX, 6, 0, 0, 0, true);
+    t.set(CPU::staIdY, O::Sta, M::IndirectY, 6, 0, 0, 0, true);
+    // STX
+    t.set(CPU::stxZpg, O::Stx, M::ZeroPage,  3, 0, 0, 0, true);
+    t.set(CPU::stxZpY, O::Stx, M::ZeroPageY, 4, 0, 0, 0, true);
+    t.set(CPU::stxAbs, O::Stx, M::Absolute,  4, 0, 0, 0, true);
+    // STY
+    t.set(CPU::styZpg, O::Sty, M::ZeroPage,  3, 0, 0, 0, true);
+    t.set(CPU::styZpX, O::Sty, M::ZeroPageX, 4, 0, 0, 0, true);
+    t.set(CPU::styAbs, O::Sty, M::Absolute,  4, 0, 0, 0, true);
+    // AND
+    t.set(CPU::andImm, O::And, M::Immediate, 2, 0, 0, NZ);
+    t.set(CPU::andZpg, O::And, M::ZeroPage,  3, 0, 0, NZ);
+    t.set(CPU::andZpX, O::And, M::ZeroPageX, 4, 0, 0, NZ);
+    t.set(CPU::andAbs, O::And, M::Absolute,  4, 0, 0, NZ);
+    t.set(CPU::andAbX, O::And, M::AbsoluteX, 4, 1, 0, NZ);
+    t.set(CPU::andAbY, O::And, M::AbsoluteY, 4, 1, 0, NZ);
+    t.set(CPU::andIdX, O::And, M::IndirectX, 6, 0, 0, NZ);
+    t.set(CPU::andIdY, O::And, M::IndirectY, 5, 1, 0, NZ);
+    // EOR
+    t.set(CPU::eorImm, O::Eor, M::Immediate, 2, 0, 0, NZ);
+    t.set(CPU::eorZpg, O::Eor, M::ZeroPage,  3, 0, 0, NZ);
+    t.set(CPU::eorZpX, O::Eor, M::ZeroPageX, 4, 0, 0, NZ);
+    t.set(CPU::eorAbs, O::Eor, M::Absolute,  4, 0, 0, NZ);
+    t.set(CPU::eorAbX, O::Eor, M::AbsoluteX, 4, 1, 0, NZ);
+    t.set(CPU::eorAbY, O::Eor, M::AbsoluteY, 4, 1, 0, NZ);
+    t.set(CPU::eorIdX, O::Eor, M::IndirectX, 6, 0, 0, NZ);
+    t.set(CPU::eorIdY, O::Eor, M::IndirectY, 5, 1, 0, NZ);
+    // ORA
+    t.set(CPU::oraImm, O::Ora, M::Immediate, 2, 0, 0, NZ);
+    t.set(CPU::oraZpg, O::Ora, M::ZeroPage,  3, 0, 0, NZ);
+    t.set(CPU::oraZpX, O::Ora, M::ZeroPageX, 4, 0, 0, NZ);
+    t.set(CPU::oraAbs, O::Ora, M::Absolute,  4, 0, 0, NZ);
+    t.set(CPU::oraAbX, O::Ora, M::AbsoluteX, 4, 1, 0, NZ);
+    t.set(CPU::oraAbY, O::Ora, M::AbsoluteY, 4, 1, 0, NZ);
+    t.set(CPU::oraIdX, O::Ora, M::IndirectX, 6, 0, 0, NZ);
+    t.set(CPU::oraIdY, O::Ora, M::IndirectY, 5, 1, 0, NZ);
+    // BIT
+    t.set(CPU::bitZpg, O::Bit, M::ZeroPage,  3, 0, 0, NZ | CPU::FLAG_V);
+    t.set(CPU::bitAbs, O::Bit, M::Absolute,  4, 0, 0, NZ | CPU::FLAG_V);
+    // Transfer
+    t.set(CPU::taxImp, O::Tax, M::Implied, 2, 0, 0, NZ);
+    t.set(CPU::txaImp, O::Txa, M::Implied, 2, 0, 0, NZ);
+    t.set(CPU::tayImp, O::Tay, M::Implied, 2, 0, 0, NZ);
+    t.set(CPU::tyaImp, O::Tya, M::Implied, 2, 0, 0, NZ);
+    t.set(CPU::tsxImp, O::Tsx, M::Implied, 2, 0, 0, NZ);
+    t.set(CPU::txsImp, O::Txs, M::Implied, 2, 0, 0, 0);
+    // Stack (PLA leaves the flags untouched in CPU::execute)
+    t.set(CPU::phaImp, O::Pha, M::Implied, 3, 0, 0, 0, true);
+    t.set(CPU::phpImp, O::Php, M::Implied, 3, 0, ALL, 0, true);
+    t.set(CPU::plaImp, O::Pla, M::Implied, 4, 0, 0, 0);
+    t.set(CPU::plpImp, O::Plp, M::Implied, 4, 0, 0, ALL & ~CPU::FLAG_B);
+    // Increments
+    t.set(CPU::incZpg, O::Inc, M::ZeroPage,  5, 0, 0, NZ, true);
+    t.set(CPU::incZpX, O::Inc, M::ZeroPageX, 6, 0, 0, NZ, true);
+    t.set(CPU::incAbs, O::Inc, M::Absolute,  6, 0, 0, NZ, true);
+    t.set(CPU::incAbX, O::Inc, M::AbsoluteX, 7, 0, 0, NZ, true);
+    t.set(CPU::inxImp, O::Inx, M::Implied,   2, 0, 0, NZ);
+    t.set(CPU::inyImp, O::Iny, M::Implied,   2, 0, 0, NZ);
+    // Decrements
+    t.set(CPU::decZpg, O::Dec, M::ZeroPage,  5, 0, 0, NZ, true);
+    t.set(CPU::decZpX, O::Dec, M::ZeroPageX, 6, 0, 0, NZ, true);
+    t.set(CPU::decAbs, O::Dec, M::Absolute,  6, 0, 0, NZ, true);
+    t.set(CPU::decAbX, O::Dec, M::AbsoluteX, 7, 0, 0, NZ, true);
+    t.set(CPU::dexImp, O::Dex, M::Implied,   2, 0, 0, NZ);
+    t.set(CPU::deyImp, O::Dey, M::Implied,   2, 0, 0, NZ);
+    // Add with Carry (SBC is declared in CPU::Instruction but not executed yet)
+    const byte NVZC = NZ | CPU::FLAG_V | CPU::FLAG_C;
+    t.set(CPU::adcImm, O::Adc, M::Immediate, 2, 0, CPU::FLAG_C, NVZC);
+    t.set(CPU::adcZpg, O::Adc, M::ZeroPage,  3, 0, CPU::FLAG_C, NVZC);
+    t.set(CPU::adcZpX, O::Adc, M::ZeroPageX, 4, 0, CPU::FLAG_C, NVZC);
+    t.set(CPU::adcAbs, O::Adc, M::Absolute,  4, 0, CPU::FLAG_C, NVZC);
+    t.set(CPU::adcAbX, O::Adc, M::AbsoluteX, 4, 1, CPU::FLAG_C, NVZC);
+    t.set(CPU::adcAbY, O::Adc, M::AbsoluteY, 4, 1, CPU::FLAG_C, NVZC);
+    t.set(CPU::adcIdX, O::Adc, M::IndirectX, 6, 0, CPU::FLAG_C, NVZC);
+    t.set(CPU::adcIdY, O::Adc, M::IndirectY, 5, 1, CPU::FLAG_C, NVZC);
+    // Flag Instructions
+    t.set(CPU::clcImp, O::Clc, M::Implied, 2, 0, 0, CPU::FLAG_C);
+    t.set(CPU::cldImp, O::Cld, M::Implied, 2, 0, 0, CPU::FLAG_D);
+    t.set(CPU::cliImp, O::Cli, M::Implied, 2, 0, 0, CPU::FLAG_I);
+    t.set(CPU::clvImp, O::Clv, M::Implied, 2, 0, 0, CPU::FLAG_V);
+    t.set(CPU::secImp, O::Sec, M::Implied, 2, 0, 0, CPU::FLAG_C);
+    t.set(CPU::sedImp, O::Sed, M::Implied, 2, 0, 0, CPU::FLAG_D);
+    t.set(CPU::seiImp, O::Sei, M::Implied, 2, 0, 0, CPU::FLAG_I);
+    // Branches (+1 cycle when taken, +1 more when the page boundary is crossed)
+    t.set(CPU::bccRel, O::Bcc, M::Relative, 2, 1, CPU::FLAG_C, 0, false, true);
+    t.set(CPU::bcsRel, O::Bcs, M::Relative, 2, 1, CPU::FLAG_C, 0, false, true);
+    t.set(CPU::beqRel, O::Beq, M::Relative, 2, 1, CPU::FLAG_Z, 0, false, true);
+    t.set(CPU::bmiRel, O::Bmi, M::Relative, 2, 1, CPU::FLAG_N, 0, false, true);
+    t.set(CPU::bneRel, O::Bne, M::Relative, 2, 1, CPU::FLAG_Z, 0, false, true);
+    t.set(CPU::bplRel, O::Bpl, M::Relative, 2, 1, CPU::FLAG_N, 0, false, true);
+    t.set(CPU::bvcRel, O::Bvc, M::Relative, 2, 1, CPU::FLAG_V, 0, false, true);
+    t.set(CPU::bvsRel, O::Bvs, M::Relative, 2, 1, CPU::FLAG_V, 0, false, true);
+    // Jump & Calls
+    t.set(CPU::jmpAbs, O::Jmp, M::Absolute, 3, 0, 0, 0, false, true);
+    t.set(CPU::jmpInd, O::Jmp, M::Indirect, 5, 0, 0, 0, false, true);
+    t.set(CPU::jsrAbs, O::Jsr, M::Absolute, 6, 0, 0, 0, true, true);
+    t.set(CPU::rtsImp, O::Rts, M::Implied,  6, 0, 0, 0, false, true);
+    t.set(CPU::rtiImp, O::Rti, M::Implied,  6, 0, 0, ALL & ~CPU::FLAG_B, false, true);
+    // No Operation
+    t.set(CPU::nop, O::Nop, M::Implied, 2, 0, 0, 0);
+    return t;
+}
+
+/// @brief Single source of truth for per opcode metadata, evaluated at compile time.
+constexpr OpcodeTable opcodeTable = makeOpcodeTable();
+
+static_assert(opcodeTable[CPU::ldaAbX].cycles == 4 && opcodeTable[CPU::jsrAbs].cycles == 6,
+              "opcode table must be evaluated at compile time");
+
+
+#endif //CPU6502_OPCODES_H
@@ -0,0 +1,72 @@
+#ifndef CPU6502_OPERATIONS_H
+#define CPU6502_OPERATIONS_H
+
+#include "CPU.h"
+#include "Opcodes.h"
+#include "../types.h"
+
+/** @brief What the operations do to values, shared by CPU::execute and the code StaticRecompiler generates
+ *  (see AotRuntime.h). Cycles, addressing and when N and Z are written (lazily in the interpreter) are left
+ *  to the callers.
+ */
+
+/// @brief N and Z flags of a value assigned to a register or memory.
+constexpr byte assignmentFlags(byte value) {
+    return (value & CPU::FLAG_N) | (value == 0 ? CPU::FLAG_Z : 0);
+}
+
+/** @brief AND, EOR, ORA or ADC of the accumulator and the value given, ADC sets C and V in status.
+ *
+ *  @return New accumulator
+ */
+CPU6502_ALWAYS_INLINE byte accumulate(Operation operation, byte a, byte value, byte& status) {
+    switch (operation) {
+        case Operation::And: return a & value;
+        case Operation::Eor: return a ^ value;
+        case Operation::Ora: return a | value;
+        default: {
+            byte result = a + value;
+            bool carry = result < a;
+            if (status & CPU::FLAG_C) { result++; if (result == 0) carry = true; }
+            const bool sign = (a & CPU::FLAG_N) != 0;
+            const bool overflow = sign == ((value & CPU::FLAG_N) != 0) && sign != ((result & CPU::FLAG_N) != 0);
+            status = (status & ~(CPU::FLAG_C | CPU::FLAG_V)) | (carry ? CPU::FLAG_C : 0) | (overflow ? CPU::FLAG_V : 0);
+            return result;
+        }
+    }
+}
+
+/// @brief BIT: N and V are bits 7 and 6 of the value, Z is set when A AND the value is zero.
+CPU6502_ALWAYS_INLINE void bitTest(byte a, byte value, byte& status) {
+    status = (status & ~(CPU::FLAG_N | CPU::FLAG_V | CPU::FLAG_Z)) | (value & (CPU::FLAG_N | CPU::FLAG_V))
+             | ((a & value) == 0 ? CPU::FLAG_Z : 0);
+}
+
+/// @brief INC, INX and INY add one to the value, DEC, DEX and DEY take one from it.
+constexpr byte step(Operation operation, byte value) {
+    return operation == Operation::Inc || operation == Operation::Inx || operation == Operation::Iny
+           ? (byte) (value + 1) : (byte) (value - 1);
+}
+
+/// @brief Status after the flag instruction given (CLC, CLD, CLI, CLV, SEC, SED or SEI).
+constexpr byte changeFlag(const OpcodeInfo& info, byte status) {
+    return setsFlag(info.operation) ? status | info.flagsWritten : status & ~info.flagsWritten;
+}
+
+/// @brief Status byte PHP pushes, with B and the unused bit set.
+constexpr byte pushedStatus(byte status) {
+    return status | 0b00110000;
+}
+
+/// @brief Status after PLP or RTI pull the byte given, B and the unused bit aren't pulled.
+constexpr byte pulledStatus(byte status, byte pulled) {
+    return (status & 0b00110000) | (pulled & 0b11001111);
+}
+
+/// @brief Whether the branch given is taken, flagSet telling whether the flag it tests (OpcodeInfo::flagsRead) is set.
+constexpr bool branchTaken(Operation operation, bool flagSet) {
+    return flagSet == branchesWhenSet(operation);
+}
+
+
+#endif //CPU6502_OPERATIONS_H
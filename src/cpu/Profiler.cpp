@@ -0,0 +1,94 @@
+#include <cstdio>
+#include "Profiler.h"
+
+constexpr const char* Profiler::ROOT;
+
+Profiler::Profiler() {
+    clear();
+}
+
+void Profiler::call(word routine, byte sp, std::uint64_t clock) {
+    unwind(sp, clock);
+    Node& caller = nodes[top()];
+    auto child = caller.children.find(routine);
+    std::size_t node;
+    if (child != caller.children.end()) {
+        node = child->second;
+    } else {
+        node = nodes.size();
+        caller.children.emplace(routine, node);
+        nodes.emplace_back(routine, top());
+    }
+    frames.push_back({node, sp, clock});
+    totals[routine].calls++;
+    activations[routine]++;
+}
+
+void Profiler::ret(byte sp, std::uint64_t clock) {
+    unwind(sp, clock);
+}
+
+std::vector<word> Profiler::stack() const {
+    std::vector<word> routines;
+    for (const Frame& frame : frames) routines.push_back(nodes[frame.node].routine);
+    return routines;
+}
+
+std::map<word, Profiler::Routine> Profiler::routines(std::uint64_t clock) const {
+    std::map<word, Routine> routines = totals;
+    if (frames.empty()) return routines;
+    routines[nodes[top()].routine].exclusive += clock - last;
+    // Only the outermost frame of a routine counts towards its inclusive cycles
+    std::map<word, int> seen;
+    for (const Frame& frame : frames) {
+        const word routine = nodes[frame.node].routine;
+        if (seen[routine]++ == 0) routines[routine].inclusive += clock - frame.start;
+    }
+    return routines;
+}
+
+std::string Profiler::folded(std::uint64_t clock) const {
+    std::string text;
+    for (std::size_t node = 0; node < nodes.size(); node++) {
+        std::uint64_t cycles = nodes[node].exclusive;
+        if (node == top()) cycles += clock - last;
+        if (cycles == 0) continue;
+        std::string path;
+        for (std::size_t at = node; at != 0; at = nodes[at].parent) {
+            char name[8];
+            snprintf(name, sizeof name, ";$%04X", nodes[at].routine);
+            path.insert(0, name);
+        }
+        text += ROOT + path + ' ' + std::to_string(cycles) + '\n';
+    }
+    return text;
+}
+
+void Profiler::clear() {
+    nodes.clear();
+    nodes.emplace_back(0, 0);
+    frames.clear();
+    totals.clear();
+    activations.clear();
+    last = 0;
+}
+
+std::size_t Profiler::top() const {
+    return frames.empty() ? 0 : frames.back().node;
+}
+
+void Profiler::advance(std::uint64_t clock) {
+    nodes[top()].exclusive += clock - last;
+    if (!frames.empty()) totals[nodes[top()].routine].exclusive += clock - last;
+    last = clock;
+}
+
+void Profiler::unwind(byte sp, std::uint64_t clock) {
+    advance(clock);
+    while (!frames.empty() && frames.back().sp <= sp) {
+        const Frame frame = frames.back();
+        frames.pop_back();
+        const word routine = nodes[frame.node].routine;
+        if (--activations[routine] == 0) totals[routine].inclusive += clock - frame.start;
+    }
+}
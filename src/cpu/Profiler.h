@@ -0,0 +1,82 @@
+
+#ifndef CPU6502_PROFILER_H
+#define CPU6502_PROFILER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "../types.h"
+
+/** @brief Attributes emulated cycles to the subroutines running, through a shadow call stack.
+ *  The cpu tells it of every JSR (and interrupt) with the routine entered, and of every RTS (and RTI), with the
+ *  stack pointer and its cycle clock (see StatsPolicy). A frame ends once the stack pointer is back where it was
+ *  before its return address was pushed, so returns made by hand (PLA PLA, TXS) unwind the frames they drop and
+ *  an RTS to an address pushed by the program (a jump table) ends none.
+ *  Cycles go to the frame on top of the stack: a JSR's cycles to the caller, an RTS's to the routine it ends.
+ */
+class Profiler {
+public:
+    struct Routine {
+        std::uint64_t calls = 0;
+        std::uint64_t inclusive = 0; /// Cycles from its calls to their returns (a recursive call counted once)
+        std::uint64_t exclusive = 0; /// Cycles spent in the routine itself, not in the routines it called
+    };
+
+    /// Name of the frame at the bottom of every stack, the code that isn't in any subroutine
+    static constexpr const char* ROOT = "main";
+
+    Profiler();
+
+    /// @brief Enters the routine, sp is the stack pointer before its return address was pushed.
+    void call(word routine, byte sp, std::uint64_t clock);
+
+    /// @brief Leaves the routines whose return address is no longer on the stack, sp is the stack pointer after the pull.
+    void ret(byte sp, std::uint64_t clock);
+
+    /// @brief Entry addresses of the routines on the shadow stack, outermost first.
+    std::vector<word> stack() const;
+
+    /// @brief Totals per entry address of every routine called, the frames still on the stack counted up to clock.
+    std::map<word, Routine> routines(std::uint64_t clock) const;
+
+    /** @brief Exclusive cycles per call path in folded stack format, the input of flame graph tools.
+     *  One line per path ("main;$2040;$2100 1234"), the frames still on the stack counted up to clock.
+     */
+    std::string folded(std::uint64_t clock) const;
+
+    /// @brief Forgets everything, the clock starts over at 0.
+    void clear();
+private:
+    /// Call path of the call tree, its parent is the path of the caller
+    struct Node {
+        word routine;
+        std::size_t parent;
+        std::map<word, std::size_t> children;
+        std::uint64_t exclusive = 0;
+
+        Node(word routine, std::size_t parent) : routine(routine), parent(parent) {}
+    };
+
+    struct Frame {
+        std::size_t node;
+        byte sp;              /// Stack pointer before the return address was pushed
+        std::uint64_t start;  /// Clock at the call
+    };
+
+    std::vector<Node> nodes;           /// Call tree, the root (no routine) first
+    std::vector<Frame> frames;
+    std::map<word, Routine> totals;
+    std::map<word, int> activations;   /// Frames on the stack per routine
+    std::uint64_t last = 0;            /// Clock of the last call or return, the cycles since go to the top frame
+
+    std::size_t top() const;
+    /// @brief Gives the cycles since the last event to the top frame.
+    void advance(std::uint64_t clock);
+    /// @brief Pops the frames ended with the stack pointer at sp.
+    void unwind(byte sp, std::uint64_t clock);
+};
+
+
+#endif //CPU6502_PROFILER_H
@@ -0,0 +1,40 @@
+#include "Stats.h"
+#include "Opcodes.h"
+
+namespace {
+    std::array<byte, 0x100> opcodeCycles() {
+        std::array<byte, 0x100> cycles{};
+        for (dword opcode = 0; opcode < 0x100; opcode++) cycles[opcode] = opcodeTable[opcode].cycles;
+        return cycles;
+    }
+}
+
+const std::array<byte, 0x100> StatsPolicy<true>::OPCODE_CYCLES = opcodeCycles();
+
+std::uint64_t Stats::executions(AddressingMode mode) const {
+    std::uint64_t total = 0;
+    for (dword opcode = 0; opcode < 0x100; opcode++) {
+        if (opcodeTable[opcode].mode == mode) total += opcodes[opcode];
+    }
+    return total;
+}
+
+std::uint64_t Stats::instructions() const {
+    std::uint64_t total = 0;
+    for (dword opcode = 0; opcode < 0x100; opcode++) {
+        if (opcodeTable[opcode].isLegal()) total += opcodes[opcode];
+    }
+    return total;
+}
+
+std::uint64_t Stats::branches() const {
+    return executions(AddressingMode::Relative);
+}
+
+std::uint64_t Stats::branchesNotTaken() const {
+    return branches() - branchesTaken;
+}
+
+byte Stats::maxStackDepth() const {
+    return 0xFF - lowestSP;
+}
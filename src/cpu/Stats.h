@@ -0,0 +1,87 @@
+
+#ifndef CPU6502_STATS_H
+#define CPU6502_STATS_H
+
+#include <array>
+#include <cstdint>
+#include "Profiler.h"
+#include "../types.h"
+
+enum class AddressingMode : byte;
+
+/// @brief What the cpu executed, gathered in stats builds (see CPU6502_STATS).
+struct Stats {
+    std::uint64_t opcodes[0x100] = {};     /// Executions of every opcode (illegal ones that stopped execute included)
+    std::uint64_t pageCrossings = 0;       /// Indexed addresses that crossed a page (addOffsetWithPageBoundary)
+    std::uint64_t branchesTaken = 0;
+    std::uint64_t branchPageCrossings = 0; /// Taken branches to another page
+    byte lowestSP = 0xFF;                  /// Stack high-water mark: lowest SP left by a push
+    std::uint64_t cycles = 0;              /// Cycles of the instructions and interrupts, the clock of the profiler
+
+    /// @brief Executions of the opcodes with the addressing mode given.
+    std::uint64_t executions(AddressingMode mode) const;
+
+    /// @brief Instructions executed.
+    std::uint64_t instructions() const;
+
+    /// @brief Branch instructions executed, taken or not.
+    std::uint64_t branches() const;
+
+    std::uint64_t branchesNotTaken() const;
+
+    /// @brief Deepest the stack got, in bytes below $01FF.
+    byte maxStackDepth() const;
+};
+
+/** @brief Hooks the cpu calls as it executes, empty (no code, and no space as a base class) unless enabled.
+ *  The enabled policy keeps a public Stats, and a Profiler of the subroutines called, for the instructions the cpu's handlers run (see CPU.h).
+ */
+template<bool enabled>
+class StatsPolicy {
+protected:
+    void countOpcode(byte) {}
+    void countPageCrossing(word, byte) {}
+    void countBranch(word, sbyte) {}
+    void countPush(byte) {}
+    void countCall(word, byte) {}
+    void countInterrupt(word, byte, int) {}
+    void countReturn(byte) {}
+};
+
+template<>
+class StatsPolicy<true> {
+public:
+    Stats stats;
+    Profiler profiler;
+protected:
+    void countOpcode(byte opcode) {
+        stats.opcodes[opcode]++;
+        stats.cycles += OPCODE_CYCLES[opcode];
+    }
+    void countPageCrossing(word address, byte offset) {
+        const bool crossed = (((address + offset) ^ address) & 0x0100) != 0;
+        stats.pageCrossings += crossed;
+        stats.cycles += crossed;
+    }
+    void countBranch(word next, sbyte offset) {
+        const bool crossed = ((((word) (next + offset)) ^ next) & 0x0100) != 0;
+        stats.branchesTaken++;
+        stats.branchPageCrossings += crossed;
+        stats.cycles += 1 + crossed;
+    }
+    void countPush(byte sp) { if (sp < stats.lowestSP) stats.lowestSP = sp; }
+    /// sp: the stack pointer before the return address was pushed
+    void countCall(word routine, byte sp) { profiler.call(routine, sp, stats.cycles); }
+    void countInterrupt(word handler, byte sp, int cycles) {
+        stats.cycles += cycles;
+        profiler.call(handler, sp, stats.cycles);
+    }
+    /// sp: the stack pointer after the return address was pulled
+    void countReturn(byte sp) { profiler.ret(sp, stats.cycles); }
+private:
+    /// Base cycles of every opcode (see OpcodeInfo), the ones that stop execute take none
+    static const std::array<byte, 0x100> OPCODE_CYCLES;
+};
+
+
+#endif //CPU6502_STATS_H
@@ -0,0 +1,54 @@
+#include "TieredEngine.h"
+
+TieredEngine::TieredEngine(BlockCache &blockCache, Jit &jit) : blockCache(blockCache), jit(jit) {}
+
+CPU::Result TieredEngine::execute(CPU &cpu, int budget, Memory &memory) {
+    CPU::DecodedCycles cycles(budget);
+    int cyclesExpected = cycles;
+    BlockCache::Block* previous = nullptr;
+    while (cycles > 0) {
+        std::unique_ptr<dword[]>& page = entries[cpu.PC >> 8];
+        if (!page) page.reset(new dword[0x100]());
+        dword& heat = page[cpu.PC & 0xFF];
+        if (heat != UINT32_MAX) heat++;
+        if (heat < warmThreshold) {
+            interpret(cpu, cycles, memory);
+            previous = nullptr;
+            continue;
+        }
+        BlockCache::Block& block = blockCache.successor(previous, cpu.PC, memory);
+        bool completed;
+        if (heat >= hotThreshold) {
+            const std::uint64_t nativeRuns = jit.nativeRuns;
+            completed = jit.run(block, cpu, cycles, memory, 0);
+            if (jit.nativeRuns != nativeRuns) counters.nativeRuns++; else counters.blockRuns++;
+        } else {
+            completed = BlockCache::run(block, cpu, cycles, memory);
+            counters.blockRuns++;
+        }
+        previous = completed ? &block : nullptr;
+    }
+    return cpu.finish(cyclesExpected, cycles);
+}
+
+void TieredEngine::interpret(CPU &cpu, CPU::DecodedCycles &cycles, Memory &memory) {
+    CPU::Budget budget;
+    budget.cycles = cycles.remaining;
+    budget.untilFlowChange = true;
+    const CPU::Result result = cpu.execute(budget, memory);
+    cycles.remaining -= result.cycles;
+    counters.interpreted += result.instructions;
+    if (result.stop != CPU::Stop::Budget) cpu.stop(result.stop, result.pc, cycles);
+    // Passes on the end of the run for a waiting IRQ, the run above already returned
+    else if (cpu.yieldOnUnmask && !cpu.flag.I) cpu.yield(cycles);
+}
+
+dword TieredEngine::heat(word address) const {
+    const std::unique_ptr<dword[]>& page = entries[address >> 8];
+    return page ? page[address & 0xFF] : 0;
+}
+
+void TieredEngine::clear() {
+    for (std::unique_ptr<dword[]>& page : entries) page.reset();
+    counters = Counters();
+}
@@ -0,0 +1,54 @@
+
+#ifndef CPU6502_TIEREDENGINE_H
+#define CPU6502_TIEREDENGINE_H
+
+#include <cstdint>
+#include <memory>
+#include "CPU.h"
+#include "BlockCache.h"
+#include "Jit.h"
+#include "../memory/Memory.h"
+#include "../types.h"
+
+/** @brief Runs code on the tier its hotness calls for.
+ *  Every address a block is entered at counts its entries. Cold code runs on CPU::execute, code entered
+ *  warmThreshold times moves to the block cache and code entered hotThreshold times to the Jit, so code
+ *  that runs once is never translated while hot loops end up compiled.
+ */
+class TieredEngine {
+public:
+    struct Counters {
+        std::uint64_t interpreted = 0; /// Instructions run on CPU::execute
+        std::uint64_t blockRuns = 0;   /// Blocks run on the block cache
+        std::uint64_t nativeRuns = 0;  /// Blocks run as native code
+    };
+
+    dword warmThreshold = 2; /// Entries before the code runs on the block cache
+    dword hotThreshold = 16; /// Entries before the code is compiled
+    Counters counters;
+
+    TieredEngine(BlockCache& blockCache, Jit& jit);
+
+    /** @brief Execute the number of cycles given, each block on its tier.
+     *  Results and cycle totals are the same as CPU::execute.
+     *
+     *  @return Why it stopped, Cycles Executed and where
+     */
+    CPU::Result execute(CPU& cpu, int cycles, Memory& memory);
+
+    /// @brief Times a block was entered at the address given.
+    dword heat(word address) const;
+
+    /// @brief Drops the counters, every block starts cold again.
+    void clear();
+private:
+    BlockCache& blockCache;
+    Jit& jit;
+    std::unique_ptr<dword[]> entries[0x100]; /// Per address, each page allocated when code is first entered in it
+
+    /// @brief Runs instructions on CPU::execute within the budget, up to the first one changing the flow.
+    void interpret(CPU& cpu, CPU::DecodedCycles& cycles, Memory& memory);
+};
+
+
+#endif //CPU6502_TIEREDENGINE_H
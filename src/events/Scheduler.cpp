@@ -0,0 +1,40 @@
+#include <algorithm>
+#include "Scheduler.h"
+
+constexpr std::uint64_t Scheduler::NEVER;
+
+std::uint64_t Scheduler::schedule(std::uint64_t time, Callback callback) {
+    const std::uint64_t id = nextId++;
+    events.push_back({time, id, std::move(callback)});
+    std::push_heap(events.begin(), events.end(), later);
+    return id;
+}
+
+bool Scheduler::cancel(std::uint64_t id) {
+    const auto event = std::find_if(events.begin(), events.end(), [id](const Event& event) { return event.id == id; });
+    if (event == events.end()) return false;
+    events.erase(event);
+    std::make_heap(events.begin(), events.end(), later);
+    return true;
+}
+
+std::uint64_t Scheduler::next() const {
+    return events.empty() ? NEVER : events.front().time;
+}
+
+void Scheduler::runDue(std::uint64_t time) {
+    while (!events.empty() && events.front().time <= time) {
+        std::pop_heap(events.begin(), events.end(), later);
+        Event event = std::move(events.back());
+        events.pop_back();
+        event.callback(event.time);
+    }
+}
+
+std::size_t Scheduler::size() const {
+    return events.size();
+}
+
+bool Scheduler::later(const Event &first, const Event &second) {
+    return first.time != second.time ? first.time > second.time : first.id > second.id;
+}
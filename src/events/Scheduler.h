@@ -0,0 +1,53 @@
+
+#ifndef CPU6502_SCHEDULER_H
+#define CPU6502_SCHEDULER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/** @brief Events due at a cycle of the computer's clock, kept in a min-heap of their times.
+ *  Computer::run only looks at the earliest one: it runs the cpu up to it in a single call to the engine,
+ *  so devices cost nothing between their events instead of being polled after every instruction.
+ */
+class Scheduler {
+public:
+    /// Called with the time the event was due at (the clock may be a few cycles past it, see Computer::run)
+    using Callback = std::function<void(std::uint64_t time)>;
+
+    /// Time of the next event when there's none
+    static constexpr std::uint64_t NEVER = UINT64_MAX;
+
+    /// @brief Schedules the callback at the time given, returns the id to cancel it with.
+    std::uint64_t schedule(std::uint64_t time, Callback callback);
+
+    /// @brief Drops the event, false if it already ran or was cancelled.
+    bool cancel(std::uint64_t id);
+
+    /// @brief Time of the earliest event, NEVER without any.
+    std::uint64_t next() const;
+
+    /** @brief Runs the events due at the time given or before, by time then in the order they were scheduled.
+     *  Callbacks may schedule (or cancel) events, the ones already due run in the same call.
+     */
+    void runDue(std::uint64_t time);
+
+    /// @brief Number of events scheduled.
+    std::size_t size() const;
+private:
+    struct Event {
+        std::uint64_t time;
+        std::uint64_t id; /// Also breaks ties between events due at the same time
+        Callback callback;
+    };
+
+    /// Heap order, the earliest event on top
+    static bool later(const Event& first, const Event& second);
+
+    std::vector<Event> events; /// Min-heap
+    std::uint64_t nextId = 0;
+};
+
+
+#endif //CPU6502_SCHEDULER_H
@@ -0,0 +1,22 @@
+
+#ifndef CPU6502_DEVICE_H
+#define CPU6502_DEVICE_H
+
+#include "../types.h"
+
+/** @brief Device registers mapped over whole pages of Memory (see Memory::map).
+ *  Every read and write the cpu makes to a mapped page goes to the device instead of RAM.
+ */
+class Device {
+public:
+    virtual ~Device() = default;
+
+    /// Read byte at the address (of a page the device is mapped over)
+    virtual byte read(word address) = 0;
+
+    /// Write byte at the address (of a page the device is mapped over)
+    virtual void write(word address, byte value) = 0;
+};
+
+
+#endif //CPU6502_DEVICE_H
@@ -2,30 +2,283 @@
 #include <cstring>
 #include "Memory.h"
 
-Memory::Memory() {
-    clear();
+namespace {
+    /// Every page never written and not in an image reads from here
+    const byte zeroPage[256] = {};
+
+    bool isZero(const byte* page) {
+        if (page == zeroPage) return true;
+        for (dword offset = 0; offset < sizeof zeroPage; offset++) {
+            if (page[offset] != 0) return false;
+        }
+        return true;
+    }
+}
+
+dword Memory::Image::storedPages() const {
+    return (dword) owners.size();
+}
+
+const byte *Memory::Image::page(byte number) const {
+    return table[number];
+}
+
+std::shared_ptr<const Memory::Image> Memory::Image::view(const byte *state, std::size_t size,
+                                                         std::shared_ptr<const void> storage) {
+    const std::size_t BITMAP = PAGES / 8;
+    if (size < BITMAP) return nullptr;
+    std::shared_ptr<Image> image = std::make_shared<Image>();
+    std::size_t offset = BITMAP;
+    for (dword page = 0; page < PAGES; page++) {
+        if (!((state[page >> 3] >> (page & 7)) & 1u)) {
+            image->table[page] = zeroPage;
+            continue;
+        }
+        if (size - offset < PAGE_SIZE) return nullptr;
+        image->table[page] = state + offset;
+        image->owners.push_back(std::shared_ptr<const byte>(storage, state + offset));
+        offset += PAGE_SIZE;
+    }
+    if (offset != size) return nullptr;
+    return image;
+}
+
+Memory::Memory() : devices(), writtenPages(), dirtyPages() {
+    load(nullptr);
+}
+
+Memory::Memory(std::shared_ptr<const Image> image) : devices(), writtenPages(), dirtyPages() {
+    load(std::move(image));
+}
+
+Memory::Memory(const Memory &other) : devices(), writtenPages(), dirtyPages() {
+    *this = other;
+}
+
+Memory &Memory::operator=(const Memory &other) {
+    if (this == &other) return *this;
+    memcpy(devices, other.devices, sizeof devices);
+    load(other.base);
+    for (dword page = 0; page < PAGES; page++) {
+        if (other.isPageWritten(page)) memcpy(own(page), other.ram(page), PAGE_SIZE);
+    }
+    return *this;
+}
+
+byte Memory::operator[](word address) const {
+    const byte* page = table[address >> 8];
+    if (page == nullptr) return devices[address >> 8]->read(address);
+    return page[address & 0xFF];
 }
 
-byte Memory::operator[](word address) const { return data[address]; }
+Memory::Reference Memory::operator[](word address) {
+    return Reference(*this, address);
+}
+
+Memory::Reference::Reference(Memory &memory, word address) : memory(memory), address(address) {}
 
-byte &Memory::operator[](word address) { return data[address]; }
+Memory::Reference::operator byte() const {
+    return memory.ram(address >> 8)[address & 0xFF];
+}
+
+Memory::Reference &Memory::Reference::operator=(byte value) {
+    const byte page = address >> 8;
+    memory.markDirty(address);
+    if (!memory.isPageWritten(page)) memory.copyOnWrite(page);
+    memory.privatePages[page]->bytes[address & 0xFF] = value;
+    return *this;
+}
+
+Memory::Reference &Memory::Reference::operator=(const Reference &other) {
+    return *this = (byte) other;
+}
+
+void Memory::write(word address, byte value) {
+    byte* page = writeTable[address >> 8];
+    if (page == nullptr) return writeSlow(address, value);
+    markDirty(address);
+    page[address & 0xFF] = value;
+}
+
+void Memory::writeSlow(word address, byte value) {
+    const byte page = address >> 8;
+    markDirty(address);
+    if (devices[page] != nullptr) return devices[page]->write(address, value);
+    copyOnWrite(page);
+    privatePages[page]->bytes[address & 0xFF] = value;
+}
 
 word Memory::readWord(word address) const {
-    // assert(address < MAX_MEM - 1);
-    word loByte = data[address];
-    word hiByte = data[address + 1];
+    word loByte = (*this)[address];
+    word hiByte = (*this)[(word) (address + 1)];
     return loByte | (hiByte << 8);
 }
 
 void Memory::writeWord(word value, word address) {
-    // assert(address < MAX_MEM - 1);
-    data[address] = (byte) value; // Low byte
-    data[address + 1] = value >> 8; // High byte
+    write(address, (byte) value); // Low byte
+    write((word) (address + 1), value >> 8); // High byte
+}
+
+void Memory::map(byte page, Device &device) {
+    devices[page] = &device;
+    point(page);
+    markDirty(page << 8);
+}
+
+void Memory::unmap(byte page) {
+    devices[page] = nullptr;
+    point(page);
+    markDirty(page << 8);
+}
+
+bool Memory::isMapped(byte page) const {
+    return devices[page] != nullptr;
 }
 
 void Memory::clear() {
-    memset(data, 0, MAX_MEM - 6);
+    const dword VECTORS = 6;
+    byte vectors[VECTORS];
+    memcpy(vectors, ram(PAGES - 1) + PAGE_SIZE - VECTORS, VECTORS);
+    if (base) load(nullptr);
+    else reset();
+    if (memcmp(vectors, zeroPage, VECTORS) != 0) {
+        byte* lastPage = own(PAGES - 1);
+        memset(lastPage, 0, PAGE_SIZE - VECTORS);
+        memcpy(lastPage + PAGE_SIZE - VECTORS, vectors, VECTORS);
+    }
 }
 
+void Memory::reset() {
+    // Unwritten pages already read from the baseline, they and the caches built from them stay valid
+    for (dword group = 0; group < PAGES / 32; group++) {
+        const dword written = writtenPages[group];
+        if (written == 0) continue;
+        dirtyPages[group] |= written;
+        writtenPages[group] = 0;
+        for (dword bit = 0; bit < 32; bit++) {
+            if (!((written >> bit) & 1u)) continue;
+            point(group * 32 + bit);
+        }
+    }
+}
 
+void Memory::saveBaseline() {
+    // Same contents, nothing to mark dirty
+    base = snapshot();
+    memset(writtenPages, 0, sizeof writtenPages);
+    for (dword page = 0; page < PAGES; page++) {
+        point(page);
+    }
+}
 
+void Memory::load(std::shared_ptr<const Image> image) {
+    // Private pages stay allocated, the next writes copy into them again
+    base = std::move(image);
+    memset(writtenPages, 0, sizeof writtenPages);
+    for (dword page = 0; page < PAGES; page++) {
+        point(page);
+    }
+    memset(dirtyPages, 0xFF, sizeof dirtyPages);
+}
+
+std::shared_ptr<const Memory::Image> Memory::snapshot() const {
+    return snapshot(nullptr);
+}
+
+std::shared_ptr<const Memory::Image> Memory::snapshot(std::shared_ptr<const Image> previous) const {
+    std::shared_ptr<Image> image = std::make_shared<Image>();
+    bool zero[PAGES];
+    dword stored = 0;
+    for (dword page = 0; page < PAGES; page++) {
+        zero[page] = isZero(ram(page));
+        stored += !zero[page];
+    }
+    image->owners.reserve(stored);
+    // Index of the owner of the page in previous, which stores its pages in page order too
+    dword previousOwner = 0;
+    for (dword page = 0; page < PAGES; page++) {
+        const byte* bytes = ram(page);
+        const byte* before = previous ? previous->table[page] : zeroPage;
+        const std::shared_ptr<const byte>* owner = before != zeroPage ? &previous->owners[previousOwner++] : nullptr;
+        if (zero[page]) {
+            image->table[page] = zeroPage;
+        } else if (owner && (bytes == before || memcmp(bytes, before, PAGE_SIZE) == 0)) {
+            image->table[page] = before;
+            image->owners.push_back(*owner);
+        } else {
+            std::shared_ptr<Page> copy = std::make_shared<Page>();
+            memcpy(copy->bytes, bytes, PAGE_SIZE);
+            image->table[page] = copy->bytes;
+            image->owners.push_back(std::shared_ptr<const byte>(copy, copy->bytes));
+        }
+    }
+    return image;
+}
+
+void Memory::readPage(byte page, byte *bytes) const {
+    memcpy(bytes, ram(page), PAGE_SIZE);
+}
+
+void Memory::writePage(byte page, const byte *bytes) {
+    markDirty(page << 8);
+    memcpy(own(page), bytes, PAGE_SIZE);
+}
+
+void Memory::save(std::vector<byte> &state) const {
+    const std::size_t bitmap = state.size();
+    state.resize(bitmap + PAGES / 8, 0);
+    for (dword page = 0; page < PAGES; page++) {
+        const byte* bytes = ram(page);
+        if (isZero(bytes)) continue;
+        state[bitmap + (page >> 3)] |= 1u << (page & 7);
+        state.insert(state.end(), bytes, bytes + PAGE_SIZE);
+    }
+}
+
+dword Memory::privatePageCount() const {
+    dword count = 0;
+    for (dword page = 0; page < PAGES; page++) count += isPageWritten(page);
+    return count;
+}
+
+void Memory::markDirty(word address) {
+    const byte page = address >> 8;
+    dirtyPages[page >> 5] |= 1u << (page & 31);
+}
+
+bool Memory::isPageDirty(byte page) const {
+    return (dirtyPages[page >> 5] >> (page & 31)) & 1u;
+}
+
+void Memory::markPageClean(byte page) {
+    dirtyPages[page >> 5] &= ~(1u << (page & 31));
+}
+
+bool Memory::isPageWritten(byte page) const {
+    return (writtenPages[page >> 5] >> (page & 31)) & 1u;
+}
+
+const byte *Memory::shared(byte page) const {
+    return base ? base->table[page] : zeroPage;
+}
+
+const byte *Memory::ram(byte page) const {
+    return isPageWritten(page) ? privatePages[page]->bytes : shared(page);
+}
+
+void Memory::point(byte page) {
+    const bool written = isPageWritten(page);
+    table[page] = devices[page] ? nullptr : ram(page);
+    writeTable[page] = devices[page] || !written ? nullptr : privatePages[page]->bytes;
+}
+
+byte *Memory::own(byte page) {
+    if (!privatePages[page]) privatePages[page].reset(new Page);
+    writtenPages[page >> 5] |= 1u << (page & 31);
+    point(page);
+    return privatePages[page]->bytes;
+}
+
+void Memory::copyOnWrite(byte page) {
+    memcpy(own(page), shared(page), PAGE_SIZE);
+}
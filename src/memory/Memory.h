@@ -2,20 +2,104 @@
 #ifndef CPU6502_MEMORY_H
 #define CPU6502_MEMORY_H
 
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "Device.h"
 #include "../types.h"
 
+/** @brief 64 KiB address space split into 256 pages of 256 bytes behind a page table.
+ *  Pages are shared copy on write: until it is first written a page is read straight from the base Image
+ *  (or from a single zero page shared by every instance), and only then copied into a private page.
+ *  Many instances loaded from the same Image only pay for the pages they write.
+ *  Pages can also be mapped to a Device: their table entries are left null, so plain RAM accesses only pay
+ *  for the null check of a pointer they load anyway and device accesses leave the fast path there.
+ */
 class Memory {
     static constexpr dword MAX_MEM = 1024 * 64;
-    byte data[MAX_MEM];
+    static constexpr dword PAGE_SIZE = 256;
+    static constexpr dword PAGES = MAX_MEM / PAGE_SIZE;
+
+    struct Page {
+        byte bytes[PAGE_SIZE];
+    };
+public:
+    /** @brief Immutable memory contents, shared by any number of Memory instances (and threads).
+     *  Only the pages holding something are stored, the others read as the shared zero page. Stored pages are
+     *  owned one by one, so images share the pages that are the same without keeping each other alive.
+     */
+    class Image {
+    public:
+        /// Number of pages stored (not all zeros)
+        dword storedPages() const;
+
+        /// Bytes of the page, the shared zero page when it isn't stored (the same pointer in images sharing it)
+        const byte* page(byte number) const;
+
+        /// Image of the pages Memory::save wrote, read in place from state (kept alive by storage),
+        /// null unless the size is exactly what save wrote
+        static std::shared_ptr<const Image> view(const byte* state, std::size_t size, std::shared_ptr<const void> storage);
+    private:
+        const byte* table[PAGES];
+        std::vector<std::shared_ptr<const byte>> owners; /// Owner of every page stored, in page order
+
+        friend class Memory;
+    };
+private:
+    const byte* table[PAGES];                  /// Page read for every page number (base image, zero page or private), null for devices
+    byte* writeTable[PAGES];                   /// Private page written for every page number, null until copied and for devices
+    Device* devices[PAGES];                    /// Device mapped over every page number, null for RAM
+    std::unique_ptr<Page> privatePages[PAGES]; /// Copies made on first write, kept allocated for reuse after a load
+    dword writtenPages[PAGES / 32];            /// One bit per page read from its private copy (written since the last reset)
+    dword dirtyPages[PAGES / 32];              /// One bit per page written since it was last marked clean
+    std::shared_ptr<const Image> base;         /// Image the pages not yet written are read from (null: all zeros)
+
+    void markDirty(word address);
+    bool isPageWritten(byte page) const;
+    /// RAM contents of the page, shared or private, whether a device hides them or not
+    const byte* shared(byte page) const;
+    const byte* ram(byte page) const;
+    /// Sets both table entries of the page from its state
+    void point(byte page);
+    /// Points the page at its private copy (left as it was) and returns it
+    byte* own(byte page);
+    void copyOnWrite(byte page);
+    void writeSlow(word address, byte value);
 public:
     /// Default constructor initializes data to all Zeros
     Memory();
 
-    /// Read byte
+    /// Constructor sharing the image given copy on write
+    explicit Memory(std::shared_ptr<const Image> image);
+
+    /// Copies the contents, sharing the same base image
+    Memory(const Memory& other);
+    Memory& operator=(const Memory& other);
+
+    /// Read byte (from the device mapped over the page, if any)
     byte operator[](word address) const;
 
-    /// Write byte
-    byte& operator[](word address);
+    /** @brief Byte of RAM under any device mapped over its page, as operator[] hands it out.
+     *  Reading it leaves the page shared and clean, only assigning copies the page (if it is still shared) and marks it dirty.
+     */
+    class Reference {
+    public:
+        operator byte() const;
+        Reference& operator=(byte value);
+        Reference& operator=(const Reference& other);
+    private:
+        Memory& memory;
+        const word address;
+
+        Reference(Memory& memory, word address);
+        friend class Memory;
+    };
+
+    /// Byte of RAM to write, under any device mapped over the page (see Reference)
+    Reference operator[](word address);
+
+    /// Write byte (to the device mapped over the page, if any), the way the cpu writes
+    void write(word address, byte value);
 
     /// Read word (little endian)
     word readWord(word address) const;
@@ -23,9 +107,52 @@ public:
     /// Write word (little endian)
     void writeWord(word value, word address);
 
-    /// Zeros all data except the System Vectors
+    /// Sends every access to the page to the device (which must outlive the mapping)
+    void map(byte page, Device& device);
+
+    /// Maps the page back to RAM
+    void unmap(byte page);
+
+    /// Whether a device is mapped over the page
+    bool isMapped(byte page) const;
+
+    /// Zeros all data except the System Vectors (marks the pages it changes dirty)
     void clear();
 
+    /// Restores the baseline image (or all zeros without one), only touching the pages written since
+    void reset();
+
+    /// Makes the current contents the baseline image reset() restores
+    void saveBaseline();
+
+    /// Replaces all data by the image given, shared copy on write, and makes it the baseline (marks every page dirty)
+    void load(std::shared_ptr<const Image> image);
+
+    /// Image of the current contents, to be shared by other instances
+    std::shared_ptr<const Image> snapshot() const;
+
+    /// Image of the current contents sharing the pages that are the same in previous (previous itself isn't kept alive),
+    /// only copying the ones that changed
+    std::shared_ptr<const Image> snapshot(std::shared_ptr<const Image> previous) const;
+
+    /// Copies the 256 bytes of RAM of the page, under any device mapped over it
+    void readPage(byte page, byte* bytes) const;
+
+    /// Overwrites the 256 bytes of RAM of the page, under any device mapped over it (marks the page dirty)
+    void writePage(byte page, const byte* bytes);
+
+    /// Appends the RAM contents to state: a bitmap of the non-zero pages followed by their bytes (see Image::view)
+    void save(std::vector<byte>& state) const;
+
+    /// Number of pages copied on write, the memory used on top of the shared image
+    dword privatePageCount() const;
+
+    /// Whether the page was written since it was last marked clean
+    bool isPageDirty(byte page) const;
+
+    /// Marks the page clean (used by the caches of decoded code)
+    void markPageClean(byte page);
+
     friend class Computer;
     friend class CPU;
 };
@@ -0,0 +1,187 @@
+#include <algorithm>
+#include <cstring>
+#include "RewindBuffer.h"
+
+namespace {
+    const dword PAGES = 0x100;
+    const std::size_t PAGE_SIZE = 256;
+
+    void putNumber(std::vector<byte>& bytes, std::size_t number) {
+        while (number >= 0x80) {
+            bytes.push_back((byte) (number | 0x80));
+            number >>= 7;
+        }
+        bytes.push_back((byte) number);
+    }
+
+    /// @brief Reads the ring sequentially, wrapping around its end.
+    struct RingReader {
+        const std::vector<byte>& ring;
+        std::size_t offset;
+
+        byte next() {
+            const byte value = ring[offset];
+            if (++offset == ring.size()) offset = 0;
+            return value;
+        }
+
+        std::size_t number() {
+            std::size_t number = 0;
+            for (unsigned shift = 0;; shift += 7) {
+                const byte value = next();
+                number |= (std::size_t) (value & 0x7F) << shift;
+                if (!(value & 0x80)) return number;
+            }
+        }
+    };
+}
+
+RewindBuffer::RewindBuffer(Computer &computer, int interval, std::size_t capacity)
+        : computer(computer), interval(interval), ring(capacity), newest(computer.snapshot(nullptr)),
+          xored(newest.header.size() + PAGES * PAGE_SIZE) {}
+
+CPU::Result RewindBuffer::execute(int cycles) {
+    CPU::Result result{CPU::Stop::Budget, 0, computer.cpu.PC};
+    while (result.cycles < cycles) {
+        if (now >= newestClock + interval) checkpoint();
+        const std::uint64_t untilCheckpoint = newestClock + interval - now;
+        const int chunk = (int) std::min<std::uint64_t>(cycles - result.cycles, untilCheckpoint);
+        const CPU::Result ran = computer.execute(chunk);
+        result.cycles += ran.cycles;
+        result.stop = ran.stop;
+        result.pc = ran.pc;
+        now += ran.cycles;
+        if (ran.stop != CPU::Stop::Budget) break;
+    }
+    if (now >= newestClock + interval) checkpoint();
+    return result;
+}
+
+int RewindBuffer::run(int cycles) {
+    return execute(cycles).cycles;
+}
+
+bool RewindBuffer::stepBack(std::uint64_t cycles) {
+    if (cycles > now) return false;
+    const std::uint64_t target = now - cycles;
+    if (target < newestClock && (deltas.empty() || target < deltas.front().clock)) return false;
+
+    // Walks back from the newest checkpoint to the nearest one at or before the target
+    while (newestClock > target) {
+        Delta& delta = deltas.back();
+        apply(delta, newest);
+        newestClock = delta.clock;
+        ringEnd = delta.offset;
+        used -= delta.size;
+        deltas.pop_back();
+    }
+    computer.restore(newest);
+    now = newestClock;
+    // The run being replayed went past the target, so it can't stop on the way there
+    if (target > now) {
+        now += computer.execute((int) (target - now)).cycles;
+    }
+    return true;
+}
+
+void RewindBuffer::checkpoint() {
+    if (now == newestClock) return;
+    Computer::Snapshot current = computer.snapshot(&newest);
+    encode(newest, current);
+    store(newestClock, std::move(newest));
+    newest = std::move(current);
+    newestClock = now;
+}
+
+std::uint64_t RewindBuffer::clock() const {
+    return now;
+}
+
+std::size_t RewindBuffer::checkpoints() const {
+    return deltas.size() + 1;
+}
+
+std::size_t RewindBuffer::usedBytes() const {
+    return used;
+}
+
+void RewindBuffer::encode(const Computer::Snapshot &from, const Computer::Snapshot &to) {
+    const std::size_t header = from.header.size();
+    for (std::size_t index = 0; index < header; index++) xored[index] = from.header[index] ^ to.header[index];
+    for (dword number = 0; number < PAGES; number++) {
+        const byte* fromPage = from.memory->page(number);
+        const byte* toPage = to.memory->page(number);
+        byte* page = &xored[header + number * PAGE_SIZE];
+        // Pages shared by both images didn't change
+        if (fromPage == toPage) {
+            memset(page, 0, PAGE_SIZE);
+            continue;
+        }
+        for (std::size_t offset = 0; offset < PAGE_SIZE; offset++) page[offset] = fromPage[offset] ^ toPage[offset];
+    }
+    // Pairs of (zero run, literal run) lengths, each followed by its literal XOR bytes
+    encoded.clear();
+    std::size_t index = 0;
+    while (index < xored.size()) {
+        std::size_t zeros = index;
+        while (zeros < xored.size() && xored[zeros] == 0) zeros++;
+        std::size_t literals = zeros;
+        while (literals < xored.size() && xored[literals] != 0) literals++;
+        putNumber(encoded, zeros - index);
+        putNumber(encoded, literals - zeros);
+        encoded.insert(encoded.end(), xored.begin() + zeros, xored.begin() + literals);
+        index = literals;
+    }
+}
+
+void RewindBuffer::apply(Delta &delta, Computer::Snapshot &state) {
+    std::fill(xored.begin(), xored.end(), 0);
+    RingReader reader{ring, delta.offset};
+    std::size_t index = 0;
+    while (index < xored.size()) {
+        index += reader.number();
+        const std::size_t literals = reader.number();
+        for (std::size_t at = 0; at < literals; at++) xored[index++] = reader.next();
+    }
+    const std::size_t header = state.header.size();
+    for (std::size_t at = 0; at < header; at++) state.header[at] ^= xored[at];
+    // Only the pages that changed are copied, the others stay shared with the image
+    Memory memory(state.memory);
+    byte page[PAGE_SIZE];
+    for (dword number = 0; number < PAGES; number++) {
+        const byte* changes = &xored[header + number * PAGE_SIZE];
+        if (std::all_of(changes, changes + PAGE_SIZE, [](byte value) { return value == 0; })) continue;
+        memory.readPage(number, page);
+        for (std::size_t offset = 0; offset < PAGE_SIZE; offset++) page[offset] ^= changes[offset];
+        memory.writePage(number, page);
+    }
+    state.memory = memory.snapshot(state.memory);
+    state.clock = delta.machine.clock;
+    state.irqLine = delta.machine.irqLine;
+    state.nmiPending = delta.machine.nmiPending;
+    state.scheduler = std::move(delta.machine.scheduler);
+}
+
+void RewindBuffer::store(std::uint64_t clock, Computer::Snapshot checkpoint) {
+    if (encoded.size() > ring.size()) {
+        // Too big to ever fit, the history before it is lost
+        deltas.clear();
+        ringEnd = 0;
+        used = 0;
+        return;
+    }
+    // Drops the oldest deltas overlapping the bytes about to be written
+    while (ring.size() - used < encoded.size()) {
+        used -= deltas.front().size;
+        deltas.pop_front();
+    }
+    // The header and memory are in the delta
+    checkpoint.header.clear();
+    checkpoint.memory.reset();
+    deltas.push_back({clock, ringEnd, encoded.size(), std::move(checkpoint)});
+    used += encoded.size();
+    for (byte value : encoded) {
+        ring[ringEnd] = value;
+        if (++ringEnd == ring.size()) ringEnd = 0;
+    }
+}
@@ -0,0 +1,82 @@
+
+#ifndef CPU6502_REWINDBUFFER_H
+#define CPU6502_REWINDBUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include "../Computer.h"
+#include "../types.h"
+
+/** @brief Runs a computer taking periodic checkpoints (Computer::Snapshot), so it can step back in time.
+ *  The newest checkpoint is kept whole, every older one as the XOR delta of the registers and memory pages turning
+ *  its successor back into it, with the runs of zero bytes (everything that didn't change) compressed away. Deltas
+ *  live in a ring of fixed size, the oldest ones are dropped to make room. The clock, interrupt lines and scheduled
+ *  events of a checkpoint are kept next to its delta. Stepping back restores the nearest checkpoint at or before the
+ *  target and re-executes forward from it, replaying the events of the run at the same clocks.
+ *  Devices aren't part of the checkpoints: the replay is only the run it was if the devices read the same since, and
+ *  replayed events act again on whatever they touch outside the computer.
+ */
+class RewindBuffer {
+public:
+    /// @brief Checkpoints the computer as it is (clock 0), then every interval cycles run, within capacity bytes of deltas.
+    RewindBuffer(Computer& computer, int interval, std::size_t capacity);
+
+    /** @brief Runs the computer (like Computer::execute) taking the checkpoints due, stops early where it does.
+     *
+     *  @return Why it stopped, Cycles Executed and where
+     */
+    CPU::Result execute(int cycles);
+
+    /// @brief Runs the computer, execute() without the stop reason.
+    int run(int cycles);
+
+    /** @brief Goes back the cycles given, to the first instruction boundary at or after clock() - cycles.
+     *  Checkpoints past the one restored are dropped, running again takes them anew.
+     *
+     *  @return false (nothing done) if that is before the oldest checkpoint
+     */
+    bool stepBack(std::uint64_t cycles);
+
+    /// @brief Takes a checkpoint now.
+    void checkpoint();
+
+    /// @brief Cycles run since the first checkpoint.
+    std::uint64_t clock() const;
+
+    /// @brief Checkpoints kept, the newest one included.
+    std::size_t checkpoints() const;
+
+    /// @brief Bytes of deltas in the ring.
+    std::size_t usedBytes() const;
+private:
+    struct Delta {
+        std::uint64_t clock;        /// Clock of the checkpoint the delta leads back to
+        std::size_t offset;         /// Start in the ring
+        std::size_t size;
+        Computer::Snapshot machine; /// Clock, interrupt lines and events of that checkpoint (header and memory are in the ring)
+    };
+
+    Computer& computer;
+    const int interval;
+    std::vector<byte> ring;
+    std::size_t ringEnd = 0;     /// Offset the next delta is written at
+    std::size_t used = 0;        /// Bytes of the deltas, stored back to back from the oldest one
+    std::deque<Delta> deltas;    /// Oldest first
+    Computer::Snapshot newest;   /// Newest checkpoint, whole
+    std::uint64_t newestClock = 0;
+    std::uint64_t now = 0;
+    std::vector<byte> xored;     /// Scratch XOR of the header then every page
+    std::vector<byte> encoded;   /// Scratch delta
+
+    /// @brief Zero run length encodes from XOR to, only reading the pages they don't share.
+    void encode(const Computer::Snapshot& from, const Computer::Snapshot& to);
+    /// @brief XORs the delta into the state and gives it the clock, interrupt lines and events of the delta.
+    void apply(Delta& delta, Computer::Snapshot& state);
+    /// @brief Appends the encoded delta leading back to the checkpoint given.
+    void store(std::uint64_t clock, Computer::Snapshot checkpoint);
+};
+
+
+#endif //CPU6502_REWINDBUFFER_H
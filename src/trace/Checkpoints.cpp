@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include "Checkpoints.h"
+
+namespace {
+    const byte CHECKPOINTS_MAGIC[4] = {'6', '5', 'C', 'P'};
+    const word CHECKPOINTS_VERSION = 1;
+    const std::size_t PAGE_SIZE = 256;
+    const std::size_t BITMAP = 256 / 8;
+    const std::size_t REGISTERS = 8 + 2 + 5;
+
+    void putNumber(std::vector<byte>& bytes, std::uint64_t number, int size) {
+        for (int index = 0; index < size; index++) bytes.push_back((byte) (number >> (8 * index)));
+    }
+
+    std::uint64_t getNumber(const byte* bytes, int size) {
+        std::uint64_t number = 0;
+        for (int index = 0; index < size; index++) number |= (std::uint64_t) bytes[index] << (8 * index);
+        return number;
+    }
+}
+
+Checkpoint Checkpoint::capture(const Computer &computer, const Checkpoint *previous) {
+    const CPU& cpu = computer.cpu;
+    Checkpoint checkpoint;
+    checkpoint.clock = computer.clock;
+    checkpoint.PC = cpu.PC;
+    checkpoint.SP = cpu.SP;
+    checkpoint.A = cpu.A;
+    checkpoint.X = cpu.X;
+    checkpoint.Y = cpu.Y;
+    checkpoint.status = cpu.status;
+    checkpoint.memory = computer.memory.snapshot(previous ? previous->memory : nullptr);
+    return checkpoint;
+}
+
+void Checkpoint::restore(Computer &computer) const {
+    CPU& cpu = computer.cpu;
+    cpu.PC = PC;
+    cpu.SP = SP;
+    cpu.A = A;
+    cpu.X = X;
+    cpu.Y = Y;
+    cpu.status = status;
+    computer.memory.load(memory);
+}
+
+bool Checkpoint::matches(const Computer &computer) const {
+    const CPU& cpu = computer.cpu;
+    if (cpu.PC != PC || cpu.SP != SP || cpu.A != A || cpu.X != X || cpu.Y != Y || cpu.status != status) return false;
+    const Memory expected(memory);
+    byte expectedPage[PAGE_SIZE], page[PAGE_SIZE];
+    for (dword number = 0; number < 0x100; number++) {
+        expected.readPage(number, expectedPage);
+        computer.memory.readPage(number, page);
+        if (memcmp(expectedPage, page, PAGE_SIZE) != 0) return false;
+    }
+    return true;
+}
+
+CheckpointRecorder::CheckpointRecorder(Computer &computer, int interval) : computer(computer), interval(interval) {
+    checkpoint();
+}
+
+int CheckpointRecorder::run(int cycles) {
+    int executed = 0;
+    while (executed < cycles) {
+        const std::uint64_t due = taken.back().clock + interval;
+        if (computer.clock >= due) {
+            checkpoint();
+            continue;
+        }
+        const int chunk = (int) std::min<std::uint64_t>(cycles - executed, due - computer.clock);
+        const CPU::Result result = computer.execute(chunk);
+        executed += result.cycles;
+        if (result.stop != CPU::Stop::Budget) break;
+    }
+    if (computer.clock >= taken.back().clock + interval) checkpoint();
+    return executed;
+}
+
+void CheckpointRecorder::checkpoint() {
+    if (!taken.empty() && taken.back().clock == computer.clock) return;
+    taken.push_back(Checkpoint::capture(computer, taken.empty() ? nullptr : &taken.back()));
+}
+
+const std::vector<Checkpoint> &CheckpointRecorder::checkpoints() const {
+    return taken;
+}
+
+bool saveCheckpoints(const std::string &path, const std::vector<Checkpoint> &checkpoints) {
+    std::vector<byte> bytes(CHECKPOINTS_MAGIC, CHECKPOINTS_MAGIC + sizeof CHECKPOINTS_MAGIC);
+    putNumber(bytes, CHECKPOINTS_VERSION, 2);
+    putNumber(bytes, checkpoints.size(), 4);
+    Memory previous;
+    for (const Checkpoint& checkpoint : checkpoints) {
+        putNumber(bytes, checkpoint.clock, 8);
+        putNumber(bytes, checkpoint.PC, 2);
+        const byte registers[5] = {checkpoint.SP, checkpoint.A, checkpoint.X, checkpoint.Y, checkpoint.status};
+        bytes.insert(bytes.end(), registers, registers + 5);
+        // Bitmap of the pages that changed, then the pages
+        const Memory current(checkpoint.memory);
+        const std::size_t bitmap = bytes.size();
+        bytes.resize(bitmap + BITMAP, 0);
+        byte previousPage[PAGE_SIZE], page[PAGE_SIZE];
+        for (dword number = 0; number < 0x100; number++) {
+            previous.readPage(number, previousPage);
+            current.readPage(number, page);
+            if (memcmp(previousPage, page, PAGE_SIZE) == 0) continue;
+            bytes[bitmap + (number >> 3)] |= 1u << (number & 7);
+            bytes.insert(bytes.end(), page, page + PAGE_SIZE);
+        }
+        previous = current;
+    }
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(bytes.data()), (std::streamsize) bytes.size());
+    return (bool) file;
+}
+
+bool loadCheckpoints(const std::string &path, std::vector<Checkpoint> &checkpoints) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    const std::vector<byte> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    const std::size_t HEADER = sizeof CHECKPOINTS_MAGIC + 2 + 4;
+    if (bytes.size() < HEADER || !std::equal(CHECKPOINTS_MAGIC, CHECKPOINTS_MAGIC + sizeof CHECKPOINTS_MAGIC, bytes.data())) {
+        return false;
+    }
+    if (getNumber(&bytes[4], 2) != CHECKPOINTS_VERSION) return false;
+    const std::uint64_t count = getNumber(&bytes[6], 4);
+
+    std::vector<Checkpoint> loaded;
+    std::size_t offset = HEADER;
+    Memory memory;
+    for (std::uint64_t index = 0; index < count; index++) {
+        if (bytes.size() - offset < REGISTERS + BITMAP) return false;
+        Checkpoint checkpoint;
+        checkpoint.clock = getNumber(&bytes[offset], 8);
+        checkpoint.PC = (word) getNumber(&bytes[offset + 8], 2);
+        checkpoint.SP = bytes[offset + 10];
+        checkpoint.A = bytes[offset + 11];
+        checkpoint.X = bytes[offset + 12];
+        checkpoint.Y = bytes[offset + 13];
+        checkpoint.status = bytes[offset + 14];
+        const byte* bitmap = &bytes[offset + REGISTERS];
+        offset += REGISTERS + BITMAP;
+        for (dword number = 0; number < 0x100; number++) {
+            if (!((bitmap[number >> 3] >> (number & 7)) & 1u)) continue;
+            if (bytes.size() - offset < PAGE_SIZE) return false;
+            memory.writePage(number, &bytes[offset]);
+            offset += PAGE_SIZE;
+        }
+        checkpoint.memory = memory.snapshot(loaded.empty() ? nullptr : loaded.back().memory);
+        loaded.push_back(std::move(checkpoint));
+    }
+    if (offset != bytes.size()) return false;
+    checkpoints = std::move(loaded);
+    return true;
+}
@@ -0,0 +1,71 @@
+
+#ifndef CPU6502_CHECKPOINTS_H
+#define CPU6502_CHECKPOINTS_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../Computer.h"
+#include "../memory/Memory.h"
+#include "../types.h"
+
+/** @brief State of a computer at an instruction boundary: its clock, the cpu registers and the memory.
+ *  The memory image shares the pages that didn't change with the checkpoint taken before it (see
+ *  Memory::snapshot), so a checkpoint only costs the pages written since. Devices, scheduled events and
+ *  interrupt lines aren't part of it.
+ */
+struct Checkpoint {
+    std::uint64_t clock = 0;
+    word PC = 0;
+    byte SP = 0xFF;
+    byte A = 0x00;
+    byte X = 0x00;
+    byte Y = 0x00;
+    byte status = 0x00;
+    std::shared_ptr<const Memory::Image> memory;
+
+    /// @brief Checkpoint of the computer as it is, sharing the pages of previous (if any) that didn't change.
+    static Checkpoint capture(const Computer& computer, const Checkpoint* previous);
+
+    /// @brief Puts the cpu and the memory of the computer in the state (its clock is left alone).
+    void restore(Computer& computer) const;
+
+    /// @brief Whether the cpu and the memory of the computer are in the state.
+    bool matches(const Computer& computer) const;
+};
+
+/** @brief Runs a computer taking a checkpoint every interval cycles, to regenerate its trace later (see
+ *  TraceRegenerator) without slowing the run down with tracing.
+ */
+class CheckpointRecorder {
+public:
+    /// @brief Checkpoints the computer as it is, then every interval cycles of its clock.
+    CheckpointRecorder(Computer& computer, int interval);
+
+    /// @brief Runs the computer (like Computer::run) taking the checkpoints due, stops early where execute() does.
+    int run(int cycles);
+
+    /// @brief Takes a checkpoint now (nothing if the clock didn't move since the last one).
+    void checkpoint();
+
+    /// @brief Checkpoints taken, oldest first.
+    const std::vector<Checkpoint>& checkpoints() const;
+private:
+    Computer& computer;
+    const int interval;
+    std::vector<Checkpoint> taken;
+};
+
+/** @brief Writes the checkpoints to the file, false on failure.
+ *  Little endian layout: "65CP" magic, version (2 bytes), count (4 bytes), then for each checkpoint its clock
+ *  (8 bytes), PC (2 bytes), SP, A, X, Y, status, a bitmap of the pages that differ from the previous checkpoint
+ *  (from all zeros for the first) and those pages.
+ */
+bool saveCheckpoints(const std::string& path, const std::vector<Checkpoint>& checkpoints);
+
+/// @brief Reads checkpoints written by saveCheckpoints, false (checkpoints untouched) if the file isn't a valid one.
+bool loadCheckpoints(const std::string& path, std::vector<Checkpoint>& checkpoints);
+
+
+#endif //CPU6502_CHECKPOINTS_H
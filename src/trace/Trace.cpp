@@ -0,0 +1,183 @@
+#include <algorithm>
+#include "Trace.h"
+#include "../cpu/Opcodes.h"
+
+namespace {
+    const byte TRACE_MAGIC[4] = {'T', '6', '5', 1};
+
+    const byte PC_CHANGED = 0x40;
+    const byte WRITE_NEAR = 0x80;  /// Write within 32 bytes of the previous one, the delta in the low 6 bits
+    const byte WRITE_FAR = 0xC0;
+    const byte INTERRUPT = 0xC1;
+    const byte GAP = 0xC2;
+    const byte RESTART = 0xC3;
+
+    byte* putNumber(byte* out, dword number) {
+        while (number >= 0x80) {
+            *out++ = (byte) (number | 0x80);
+            number >>= 7;
+        }
+        *out++ = (byte) number;
+        return out;
+    }
+
+    /// @brief Signed 16 bit delta as a small unsigned number (0, -1, 1, -2...).
+    dword zigzag(word delta) {
+        const int value = (std::int16_t) delta;
+        return value < 0 ? (dword) (-2 * value - 1) : (dword) (2 * value);
+    }
+
+    word unzigzag(dword number) {
+        return (word) (number & 1 ? -(int) ((number + 1) / 2) : (int) (number / 2));
+    }
+
+    word following(word pc, byte opcode) {
+        return pc + instructionLength(opcodeTable[opcode].mode);
+    }
+}
+
+constexpr std::size_t TraceWriter::MAX_RECORD_SIZE;
+
+void TraceWriter::header(std::vector<byte> &bytes) {
+    bytes.insert(bytes.end(), TRACE_MAGIC, TRACE_MAGIC + sizeof TRACE_MAGIC);
+}
+
+void TraceWriter::restart(std::vector<byte> &bytes) {
+    bytes.push_back(RESTART);
+    *this = TraceWriter();
+}
+
+void TraceWriter::encode(const TraceRecord &record, std::vector<byte> &bytes) {
+    const std::size_t size = bytes.size();
+    bytes.resize(size + MAX_RECORD_SIZE);
+    bytes.resize(encode(record, bytes.data() + size) - bytes.data());
+}
+
+byte* TraceWriter::encode(const TraceRecord &record, byte *out) {
+    const byte values[5] = {record.A, record.X, record.Y, record.SP, record.status};
+    byte changed = 0;
+    for (int index = 0; index < 5; index++) {
+        changed |= (values[index] != registers[index]) << index;
+    }
+    switch (record.kind) {
+        case TraceRecord::Kind::Instruction: {
+            const bool jumped = record.address != nextPC;
+            *out++ = changed | (jumped ? PC_CHANGED : 0);
+            if (jumped) out = putNumber(out, zigzag(record.address - nextPC));
+            *out++ = record.value;
+            nextPC = following(record.address, record.value);
+        } break;
+        case TraceRecord::Kind::Write: {
+            const int delta = (std::int16_t) (word) (record.address - lastWrite);
+            if (delta >= -32 && delta < 32) {
+                *out++ = WRITE_NEAR | (delta + 32);
+            } else {
+                *out++ = WRITE_FAR;
+                *out++ = (byte) record.address;
+                *out++ = (byte) (record.address >> 8);
+            }
+            *out++ = record.value;
+            lastWrite = record.address;
+        } return out;
+        case TraceRecord::Kind::Interrupt: {
+            *out++ = INTERRUPT;
+            *out++ = changed;
+            *out++ = (byte) record.address;
+            *out++ = (byte) (record.address >> 8);
+        } break;
+        case TraceRecord::Kind::Gap: {
+            *out++ = GAP;
+            out = putNumber(out, record.lost);
+        } return out;
+    }
+    for (int index = 0; index < 5; index++) {
+        if (changed & (1 << index)) *out++ = values[index];
+    }
+    std::copy(values, values + 5, registers);
+    return out;
+}
+
+TraceReader::TraceReader(std::istream &input) : input(input) {
+    byte magic[sizeof TRACE_MAGIC];
+    input.read(reinterpret_cast<char*>(magic), sizeof magic);
+    valid = input && std::equal(TRACE_MAGIC, TRACE_MAGIC + sizeof TRACE_MAGIC, magic);
+}
+
+bool TraceReader::isValid() const {
+    return valid;
+}
+
+bool TraceReader::next(TraceRecord &record) {
+    byte tag;
+    if (!valid || !get(tag)) return false;
+    while (tag == RESTART) {
+        nextPC = 0;
+        lastWrite = 0;
+        std::fill(registers, registers + 5, 0);
+        if (!get(tag)) return false;
+    }
+    record = TraceRecord();
+    if (tag < WRITE_NEAR) {
+        dword delta = 0;
+        if (tag & PC_CHANGED && !getNumber(delta)) return false;
+        record.kind = TraceRecord::Kind::Instruction;
+        record.address = nextPC + unzigzag(delta);
+        if (!get(record.value) || !getRegisters(tag, record)) return false;
+        nextPC = following(record.address, record.value);
+        return true;
+    }
+    if (tag < WRITE_FAR) {
+        record.kind = TraceRecord::Kind::Write;
+        record.address = lastWrite + (tag & 0x3F) - 32;
+    } else if (tag == WRITE_FAR) {
+        byte lo, hi;
+        if (!get(lo) || !get(hi)) return false;
+        record.kind = TraceRecord::Kind::Write;
+        record.address = lo | (hi << 8);
+    } else if (tag == INTERRUPT) {
+        byte changed, lo, hi;
+        if (!get(changed) || !get(lo) || !get(hi)) return false;
+        record.kind = TraceRecord::Kind::Interrupt;
+        record.address = lo | (hi << 8);
+        return getRegisters(changed, record);
+    } else if (tag == GAP) {
+        record.kind = TraceRecord::Kind::Gap;
+        return getNumber(record.lost);
+    } else {
+        valid = false;
+        return false;
+    }
+    lastWrite = record.address;
+    return get(record.value);
+}
+
+bool TraceReader::get(byte &value) {
+    const int read = input.get();
+    if (read == std::istream::traits_type::eof()) return false;
+    value = (byte) read;
+    return true;
+}
+
+bool TraceReader::getNumber(dword &number) {
+    number = 0;
+    for (unsigned shift = 0; shift < 32; shift += 7) {
+        byte value;
+        if (!get(value)) return false;
+        number |= (dword) (value & 0x7F) << shift;
+        if (!(value & 0x80)) return true;
+    }
+    valid = false;
+    return false;
+}
+
+bool TraceReader::getRegisters(byte mask, TraceRecord &record) {
+    for (int index = 0; index < 5; index++) {
+        if (mask & (1 << index) && !get(registers[index])) return false;
+    }
+    record.A = registers[0];
+    record.X = registers[1];
+    record.Y = registers[2];
+    record.SP = registers[3];
+    record.status = registers[4];
+    return true;
+}
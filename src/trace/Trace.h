@@ -0,0 +1,82 @@
+
+#ifndef CPU6502_TRACE_H
+#define CPU6502_TRACE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+#include "../types.h"
+
+/// @brief One event of an execution trace (see TraceRecorder).
+struct TraceRecord {
+    enum class Kind : byte {
+        Instruction, /// Instruction about to run: address is its PC, value its opcode
+        Write,       /// Byte the previous instruction (or interrupt) wrote: address and value
+        Interrupt,   /// Interrupt taken: address is the PC it interrupted, its pushes follow
+        Gap,         /// Records dropped because the ring was full, lost of them
+    };
+
+    Kind kind;
+    byte value;
+    word address;
+    byte A, X, Y, SP, status; /// Registers before the instruction or interrupt (0 in the other records)
+    dword lost;               /// Gap only
+};
+
+/** @brief Encodes trace records into the compact trace file format, read back by TraceReader.
+ *  After the magic every record is a tag byte followed by what changed since the previous one:
+ *  instructions only store their PC when it isn't the one following the previous instruction (as a signed
+ *  delta from it), their opcode and the registers that changed. Writes store their address as a delta from the
+ *  previous write (in the tag when it's small) and their value. Straight line code takes 2 to 3 bytes per
+ *  instruction.
+ */
+class TraceWriter {
+public:
+    /// @brief Appends the magic every trace starts with.
+    static void header(std::vector<byte>& bytes);
+
+    /// Most bytes a record takes
+    static constexpr std::size_t MAX_RECORD_SIZE = 16;
+
+    /// @brief Appends a restart: what follows is encoded from the initial state again, as after the header.
+    /// Traces can be joined that way, header, the records of the first, restart, the records of the second...
+    void restart(std::vector<byte>& bytes);
+
+    /// @brief Appends the record to bytes.
+    void encode(const TraceRecord& record, std::vector<byte>& bytes);
+
+    /// @brief Encodes the record at out (with room for MAX_RECORD_SIZE bytes), returns the end of it.
+    byte* encode(const TraceRecord& record, byte* out);
+private:
+    word nextPC = 0;      /// PC the next instruction has if it follows the previous one
+    word lastWrite = 0;
+    byte registers[5] = {};
+};
+
+/// @brief Decodes trace files written by TraceWriter.
+class TraceReader {
+public:
+    /// @brief Reads the magic, the stream is invalid if it doesn't match.
+    explicit TraceReader(std::istream& input);
+
+    bool isValid() const;
+
+    /// @brief Decodes the next record, false at the end of the stream (or when it's invalid).
+    bool next(TraceRecord& record);
+private:
+    std::istream& input;
+    bool valid;
+    word nextPC = 0;  /// Same state as the TraceWriter's
+    word lastWrite = 0;
+    byte registers[5] = {};
+
+    bool get(byte& value);
+    bool getNumber(dword& number);
+    /// @brief Reads the registers flagged in the mask into the record.
+    bool getRegisters(byte mask, TraceRecord& record);
+};
+
+
+#endif //CPU6502_TRACE_H
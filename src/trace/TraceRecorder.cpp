@@ -0,0 +1,85 @@
+#include <chrono>
+#include "TraceRecorder.h"
+
+namespace {
+    /// Bytes encoded before they're handed to the file
+    const std::size_t CHUNK = 1 << 16;
+
+    std::size_t powerOfTwo(std::size_t capacity) {
+        std::size_t size = 1;
+        while (size < capacity) size <<= 1;
+        return size;
+    }
+}
+
+constexpr std::size_t TraceRecorder::DEFAULT_CAPACITY;
+
+TraceRecorder::TraceRecorder(const std::string &path, std::size_t capacity, bool waitWhenFull)
+        : ring(powerOfTwo(capacity)), mask(ring.size() - 1), waitWhenFull(waitWhenFull),
+          file(path, std::ios::binary | std::ios::trunc) {
+    if (!file) return;
+    std::vector<byte> header;
+    TraceWriter::header(header);
+    file.write(reinterpret_cast<const char*>(header.data()), (std::streamsize) header.size());
+    drainer = std::thread(&TraceRecorder::drain, this);
+}
+
+TraceRecorder::~TraceRecorder() {
+    close();
+}
+
+bool TraceRecorder::isOpen() const {
+    return file.is_open();
+}
+
+bool TraceRecorder::close() {
+    if (!file.is_open()) return false;
+    stopping.store(true, std::memory_order_release);
+    if (drainer.joinable()) drainer.join();
+    if (lost) {
+        // The drainer is done, what the last pushes dropped goes straight to the file
+        const TraceRecord record = gap();
+        std::vector<byte> bytes;
+        writer.encode(record, bytes);
+        file.write(reinterpret_cast<const char*>(bytes.data()), (std::streamsize) bytes.size());
+        lost = 0;
+    }
+    file.close();
+    return !failed && !file.fail();
+}
+
+std::uint64_t TraceRecorder::droppedRecords() const {
+    return dropped;
+}
+
+void TraceRecorder::drain() {
+    std::vector<byte> bytes(CHUNK + TraceWriter::MAX_RECORD_SIZE);
+    byte* out = bytes.data();
+    const auto flush = [&]() {
+        file.write(reinterpret_cast<const char*>(bytes.data()), out - bytes.data());
+        out = bytes.data();
+    };
+    while (true) {
+        // Checked before looking at the ring, so whatever was pushed before close() is still drained
+        const bool last = stopping.load(std::memory_order_acquire);
+        std::size_t at = tail.load(std::memory_order_relaxed);
+        const std::size_t end = head.load(std::memory_order_acquire);
+        if (at == end) {
+            if (last) break;
+            if (out != bytes.data()) flush();
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            continue;
+        }
+        for (; at != end; at++) {
+            out = writer.encode(ring[at & mask], out);
+            if ((std::size_t) (out - bytes.data()) >= CHUNK) {
+                // Frees the slots encoded so far before the (slow) write
+                tail.store(at + 1, std::memory_order_release);
+                flush();
+            }
+        }
+        tail.store(at, std::memory_order_release);
+    }
+    flush();
+    failed = !file;
+}
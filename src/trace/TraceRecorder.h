@@ -0,0 +1,138 @@
+
+#ifndef CPU6502_TRACERECORDER_H
+#define CPU6502_TRACERECORDER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Trace.h"
+#include "../types.h"
+
+/** @brief Records every instruction a cpu runs (PC, opcode, registers) and the bytes it writes to a trace file.
+ *  The cpu pushes fixed size records into a single producer, single consumer lock-free ring, and a background
+ *  thread drains it into the file through a TraceWriter. A full ring never blocks the cpu: the records that don't
+ *  fit are dropped and a Gap record tells how many, unless the recorder was asked to wait for room instead.
+ *  Traced by the cpu in trace builds (see CPU6502_TRACE and TracePolicy), or by pushing records directly.
+ */
+class TraceRecorder {
+public:
+    static constexpr std::size_t DEFAULT_CAPACITY = 1 << 20;
+
+    /// @brief Opens (truncates) the file and starts draining into it, capacity is rounded up to a power of two.
+    /// Pushes into a full ring wait for the thread draining it when waitWhenFull (nothing is dropped then).
+    explicit TraceRecorder(const std::string& path, std::size_t capacity = DEFAULT_CAPACITY, bool waitWhenFull = false);
+
+    /// @brief Closes the file, if close() wasn't called.
+    ~TraceRecorder();
+
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    bool isOpen() const;
+
+    /// @brief Drains what is left, stops the thread and closes the file, false if writing any of it failed.
+    bool close();
+
+    /// @brief Pushes a record (from the single thread recording), dropping it if the ring is full.
+    void push(const TraceRecord& record) {
+        if (lost) {
+            if (!tryPush(gap())) {
+                lost++;
+                dropped++;
+                return;
+            }
+            lost = 0;
+        }
+        if (tryPush(record)) return;
+        if (waitWhenFull) {
+            while (!tryPush(record)) std::this_thread::yield();
+            return;
+        }
+        lost++;
+        dropped++;
+    }
+
+    void instruction(word pc, byte opcode, byte A, byte X, byte Y, byte SP, byte status) {
+        push({TraceRecord::Kind::Instruction, opcode, pc, A, X, Y, SP, status, 0});
+    }
+
+    void write(word address, byte value) {
+        push({TraceRecord::Kind::Write, value, address, 0, 0, 0, 0, 0, 0});
+    }
+
+    void interrupt(word pc, byte A, byte X, byte Y, byte SP, byte status) {
+        push({TraceRecord::Kind::Interrupt, 0, pc, A, X, Y, SP, status, 0});
+    }
+
+    /// @brief Records dropped so far because the ring was full.
+    std::uint64_t droppedRecords() const;
+private:
+    std::vector<TraceRecord> ring;
+    const std::size_t mask;
+    const bool waitWhenFull;
+    std::atomic<std::size_t> head{0}; /// Next slot pushed into, only written by the recording thread
+    std::size_t cachedTail = 0;        /// Tail as last seen by the recording thread
+    dword lost = 0;                    /// Records dropped since the last Gap pushed
+    std::uint64_t dropped = 0;
+    std::ofstream file;                /// Also keeps head and tail on different cache lines
+    TraceWriter writer;                /// Only used by the thread draining
+    std::atomic<std::size_t> tail{0}; /// Next slot drained, only written by the thread draining
+    std::atomic<bool> stopping{false};
+    bool failed = false;
+    std::thread drainer;
+
+    bool tryPush(const TraceRecord& record) {
+        const std::size_t at = head.load(std::memory_order_relaxed);
+        if (at - cachedTail > mask) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (at - cachedTail > mask) return false;
+        }
+        ring[at & mask] = record;
+        head.store(at + 1, std::memory_order_release);
+        return true;
+    }
+
+    TraceRecord gap() const { return {TraceRecord::Kind::Gap, 0, 0, 0, 0, 0, 0, 0, lost}; }
+
+    /// @brief Body of the thread draining the ring into the file.
+    void drain();
+};
+
+/** @brief Hooks the cpu calls for its tracer, empty (no code, and no space as a base class) unless enabled.
+ *  The enabled policy traces into the public tracer, when there is one. Native and recompiled code bypasses the hooks (see CPU.h).
+ */
+template<bool enabled>
+class TracePolicy {
+protected:
+    /// Takes the cpu about to run the opcode (PC past it) whole, so disabled hooks cost nothing
+    template<class Cpu>
+    void traceInstruction(const Cpu&, byte) {}
+    void traceWrite(word, byte) {}
+    template<class Cpu>
+    void traceInterrupt(const Cpu&) {}
+};
+
+template<>
+class TracePolicy<true> {
+public:
+    TraceRecorder* tracer = nullptr; /// Recorder of everything executed, none by default
+protected:
+    template<class Cpu>
+    void traceInstruction(const Cpu& cpu, byte opcode) {
+        if (tracer) tracer->instruction((word) (cpu.PC - 1), opcode, cpu.A, cpu.X, cpu.Y, cpu.SP, cpu.currentStatus());
+    }
+    void traceWrite(word address, byte value) {
+        if (tracer) tracer->write(address, value);
+    }
+    template<class Cpu>
+    void traceInterrupt(const Cpu& cpu) {
+        if (tracer) tracer->interrupt(cpu.PC, cpu.A, cpu.X, cpu.Y, cpu.SP, cpu.status);
+    }
+};
+
+
+#endif //CPU6502_TRACERECORDER_H
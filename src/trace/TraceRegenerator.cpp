@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include "TraceRegenerator.h"
+#include "TraceRecorder.h"
+
+namespace {
+    /// Ring of every replay, smaller than live recording's as there's one per worker
+    const std::size_t REPLAY_CAPACITY = 1 << 16;
+    /// Bytes of TraceWriter::header
+    const std::size_t HEADER_SIZE = 4;
+
+    std::string partPath(const std::string& path, std::size_t interval) {
+        return path + ".part" + std::to_string(interval);
+    }
+}
+
+TraceRegenerator::TraceRegenerator(std::vector<Checkpoint> checkpoints, unsigned threads)
+        : checkpoints(std::move(checkpoints)), pool(threads) {
+    for (unsigned worker = 0; worker < pool.size(); worker++) {
+        computers.emplace_back(new Computer());
+    }
+}
+
+bool TraceRegenerator::isSupported() {
+    return CPU::TRACE;
+}
+
+std::size_t TraceRegenerator::intervals() const {
+    return checkpoints.empty() ? 0 : checkpoints.size() - 1;
+}
+
+bool TraceRegenerator::regenerate(const std::string &path) {
+    return regenerate(path, 0, intervals());
+}
+
+bool TraceRegenerator::regenerate(const std::string &path, std::size_t first, std::size_t last) {
+    divergedIntervals.clear();
+    if (!isSupported() || first > last || last > intervals()) return false;
+    const std::size_t count = last - first;
+    std::vector<char> written(count), matched(count);
+    pool.run(count, [&](unsigned worker, std::size_t index) {
+        bool same = false;
+        written[index] = replay(first + index, *computers[worker], partPath(path, first + index), same);
+        matched[index] = same;
+    });
+
+    // Joins the parts in order, each one after a restart
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    std::vector<byte> bytes;
+    TraceWriter::header(bytes);
+    TraceWriter joiner;
+    const bool complete = std::all_of(written.begin(), written.end(), [](char part) { return part; });
+    for (std::size_t index = 0; index < count; index++) {
+        const std::string part = partPath(path, first + index);
+        if (complete) {
+            std::ifstream input(part, std::ios::binary);
+            const std::vector<byte> trace((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+            if (index > 0) joiner.restart(bytes);
+            // Past the header of the part
+            bytes.insert(bytes.end(), trace.begin() + std::min<std::size_t>(trace.size(), HEADER_SIZE), trace.end());
+            file.write(reinterpret_cast<const char*>(bytes.data()), (std::streamsize) bytes.size());
+            bytes.clear();
+        }
+        std::remove(part.c_str());
+        if (!matched[index]) divergedIntervals.push_back(first + index);
+    }
+    file.write(reinterpret_cast<const char*>(bytes.data()), (std::streamsize) bytes.size());
+    return complete && (bool) file;
+}
+
+bool TraceRegenerator::regenerateWindow(const std::string &path, std::uint64_t from, std::uint64_t to) {
+    std::size_t first = 0;
+    while (first < intervals() && checkpoints[first + 1].clock <= from) first++;
+    std::size_t last = first;
+    while (last < intervals() && checkpoints[last].clock < to) last++;
+    return regenerate(path, first, last);
+}
+
+const std::vector<std::size_t> &TraceRegenerator::diverged() const {
+    return divergedIntervals;
+}
+
+bool TraceRegenerator::replay(std::size_t interval, Computer &computer, const std::string &path, bool &matched) {
+    const Checkpoint& start = checkpoints[interval];
+    const Checkpoint& end = checkpoints[interval + 1];
+    start.restore(computer);
+    TraceRecorder recorder(path, REPLAY_CAPACITY, true);
+#if CPU6502_TRACE
+    computer.cpu.tracer = &recorder;
+#endif
+    std::uint64_t remaining = end.clock - start.clock;
+    while (remaining > 0) {
+        const CPU::Result result = computer.execute((int) std::min<std::uint64_t>(remaining, INT_MAX));
+        if (result.stop != CPU::Stop::Budget || (std::uint64_t) result.cycles >= remaining) break;
+        remaining -= result.cycles;
+    }
+#if CPU6502_TRACE
+    computer.cpu.tracer = nullptr;
+#endif
+    matched = end.matches(computer);
+    return recorder.close();
+}
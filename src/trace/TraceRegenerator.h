@@ -0,0 +1,55 @@
+
+#ifndef CPU6502_TRACEREGENERATOR_H
+#define CPU6502_TRACEREGENERATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Checkpoints.h"
+#include "../Computer.h"
+#include "../batch/WorkStealingPool.h"
+
+/** @brief Rebuilds the trace of a run from its checkpoints (see CheckpointRecorder), re-executing the intervals
+ *  between them in parallel. Each worker restores the checkpoint starting an interval on its own Computer and
+ *  runs it up to the clock of the next checkpoint with a TraceRecorder attached, which waits instead of dropping
+ *  records. The intervals' traces are then joined in order into one file (see TraceWriter::restart).
+ *  Every interval must end in the state of the checkpoint after it: the ones that don't (a device, an event or
+ *  an interrupt of the original run, which checkpoints don't capture) are reported as diverged.
+ *  Only trace builds (CPU6502_TRACE) can trace the cpu, regenerating fails in the others.
+ */
+class TraceRegenerator {
+public:
+    /// @brief Starts the workers given (0: one per hardware thread).
+    explicit TraceRegenerator(std::vector<Checkpoint> checkpoints, unsigned threads = 0);
+
+    /// @brief Whether this build can trace the cpu.
+    static bool isSupported();
+
+    /// @brief Number of intervals, one less than the checkpoints.
+    std::size_t intervals() const;
+
+    /// @brief Rebuilds the whole trace into the file, false if it can't be written (or isn't supported).
+    bool regenerate(const std::string& path);
+
+    /// @brief Rebuilds the trace of the intervals [first, last) into the file.
+    bool regenerate(const std::string& path, std::size_t first, std::size_t last);
+
+    /// @brief Rebuilds the trace of the intervals overlapping the clock window [from, to) into the file.
+    bool regenerateWindow(const std::string& path, std::uint64_t from, std::uint64_t to);
+
+    /// @brief Intervals of the last regeneration that didn't end in the state of the next checkpoint.
+    const std::vector<std::size_t>& diverged() const;
+private:
+    const std::vector<Checkpoint> checkpoints;
+    WorkStealingPool pool;
+    std::vector<std::unique_ptr<Computer>> computers; /// One per worker
+    std::vector<std::size_t> divergedIntervals;
+
+    /// @brief Traces the interval into its own file, false if it can't be written.
+    bool replay(std::size_t interval, Computer& computer, const std::string& path, bool& matched);
+};
+
+
+#endif //CPU6502_TRACEREGENERATOR_H
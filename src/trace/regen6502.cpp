@@ -0,0 +1,38 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Checkpoints.h"
+#include "TraceRegenerator.h"
+
+/** @brief cpu6502-regen <checkpoints> <trace> [from cycle to cycle]
+ *  Rebuilds the trace of a run from the checkpoints saveCheckpoints wrote, across every core (see
+ *  TraceRegenerator): the whole run, or only the intervals overlapping the cycles [from, to).
+ */
+int main(int argc, char** argv) {
+    if (argc != 3 && argc != 5) {
+        std::cerr << "Usage: " << argv[0] << " <checkpoints> <trace> [from cycle to cycle]" << std::endl;
+        return 1;
+    }
+    if (!TraceRegenerator::isSupported()) {
+        std::cerr << argv[0] << " wasn't built with CPU6502_TRACE" << std::endl;
+        return 1;
+    }
+    std::vector<Checkpoint> checkpoints;
+    if (!loadCheckpoints(argv[1], checkpoints)) {
+        std::cerr << "Can't read checkpoints from " << argv[1] << std::endl;
+        return 1;
+    }
+
+    TraceRegenerator regenerator(std::move(checkpoints));
+    const bool written = argc == 5 ? regenerator.regenerateWindow(argv[2], std::stoull(argv[3]), std::stoull(argv[4]))
+                                   : regenerator.regenerate(argv[2]);
+    if (!written) {
+        std::cerr << "Can't write " << argv[2] << std::endl;
+        return 1;
+    }
+    for (std::size_t interval : regenerator.diverged()) {
+        std::cerr << "Interval " << interval << " didn't end in the state of the next checkpoint" << std::endl;
+    }
+    std::cout << regenerator.intervals() << " intervals, trace written to " << argv[2] << std::endl;
+    return regenerator.diverged().empty() ? 0 : 2;
+}
@@ -0,0 +1,190 @@
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "gtest/gtest.h"
+#include "../src/Computer.h"
+#include "../src/batch/BatchRunner.h"
+#include "../src/batch/WorkStealingPool.h"
+
+class BatchRunnerTests : public ::testing::Test {
+public:
+    /*
+    * = $2000
+
+    loop:
+    inc $80
+    adc $80
+    tax
+    sta $3000,X
+    jmp loop
+     */
+    static const dword countingBytes = 13;
+    const byte counting[countingBytes] = {0x00, 0x20, 0xE6, 0x80, 0x65, 0x80, 0xAA, 0x9D, 0x00, 0x30, 0x4C, 0x00, 0x20};
+    /*
+    * = $2000
+
+    loop:
+    pha
+    jsr sub
+    pla
+    adc #$07
+    php
+    plp
+    jmp loop
+    sub:
+    tsx
+    inx
+    rts
+     */
+    static const dword stackBytes = 18;
+    const byte stack[stackBytes] = {0x00, 0x20, 0x48, 0x20, 0x0C, 0x20, 0x68, 0x69, 0x07, 0x08,
+                                    0x28, 0x4C, 0x00, 0x20, 0xBA, 0xE8, 0x60, 0xEA};
+    /*
+    * = $2000
+
+    lda #$01
+    .byte $02
+     */
+    static const dword illegalBytes = 5;
+    const byte illegal[illegalBytes] = {0x00, 0x20, 0xA9, 0x01, 0x02};
+
+    std::vector<BatchRunner::Job> MakeJobs(std::size_t count) const {
+        std::vector<BatchRunner::Job> jobs;
+        for (std::size_t index = 0; index < count; index++) {
+            BatchRunner::Job job;
+            switch (index % 3) {
+                case 0: job.image = counting; job.noBytes = countingBytes; break;
+                case 1: job.image = stack; job.noBytes = stackBytes; break;
+                default: job.image = illegal; job.noBytes = illegalBytes; break;
+            }
+            job.registers.A = (byte) (index * 7);
+            job.registers.SP = (byte) (0xFF - index);
+            job.registers.status = (byte) (index * 13);
+            job.cycles = 1 + (int) (index * 37 % 5000);
+            jobs.push_back(job);
+        }
+        return jobs;
+    }
+
+    /// @brief The job run on its own Computer with the interpreter.
+    static BatchRunner::Result RunAlone(const BatchRunner::Job& job) {
+        std::unique_ptr<Computer> alone(new Computer());
+        Computer& computer = *alone;
+        computer.engine = Computer::Engine::Interpreter;
+        computer.loadProgram(job.image, job.noBytes);
+        computer.resetPC();
+        computer.cpu.SP = job.registers.SP;
+        computer.cpu.A = job.registers.A;
+        computer.cpu.X = job.registers.X;
+        computer.cpu.Y = job.registers.Y;
+        computer.cpu.status = job.registers.status & CPU::STATUS_MASK;
+        BatchRunner::Result result;
+        const CPU::Result run = computer.execute(job.cycles);
+        result.cycles = run.cycles;
+        result.failed = run.stop != CPU::Stop::Budget;
+        result.registers = {computer.cpu.PC, computer.cpu.SP, computer.cpu.A, computer.cpu.X, computer.cpu.Y, computer.cpu.status};
+        result.digest = BatchRunner::digest(computer.memory);
+        return result;
+    }
+
+    static void ExpectSameResult(const BatchRunner::Result& result, const BatchRunner::Result& expected) {
+        EXPECT_EQ(result.failed, expected.failed);
+        EXPECT_EQ(result.cycles, expected.cycles);
+        EXPECT_EQ(result.registers.PC, expected.registers.PC);
+        EXPECT_EQ(result.registers.SP, expected.registers.SP);
+        EXPECT_EQ(result.registers.A, expected.registers.A);
+        EXPECT_EQ(result.registers.X, expected.registers.X);
+        EXPECT_EQ(result.registers.Y, expected.registers.Y);
+        EXPECT_EQ(result.registers.status, expected.registers.status);
+        EXPECT_EQ(result.digest, expected.digest);
+    }
+};
+
+TEST_F(BatchRunnerTests, ResultsMatchRunningEachJobAlone) {
+    // Given:
+    BatchRunner runner(4);
+    const std::vector<BatchRunner::Job> jobs = MakeJobs(60);
+
+    // When:
+    const std::vector<BatchRunner::Result> results = runner.run(jobs);
+
+    // Then:
+    ASSERT_EQ(results.size(), jobs.size());
+    for (std::size_t index = 0; index < jobs.size(); index++) {
+        SCOPED_TRACE(::testing::Message() << "job " << index);
+        ExpectSameResult(results[index], RunAlone(jobs[index]));
+    }
+}
+
+TEST_F(BatchRunnerTests, ResultsDontDependOnTheJobsRunBefore) {
+    // Given:
+    BatchRunner runner(1);
+    const std::vector<BatchRunner::Job> jobs = MakeJobs(6);
+
+    // When: every job runs on the same Computer, after the others
+    const std::vector<BatchRunner::Result> first = runner.run(jobs);
+    const std::vector<BatchRunner::Job> reversed(jobs.rbegin(), jobs.rend());
+    const std::vector<BatchRunner::Result> second = runner.run(reversed);
+
+    // Then:
+    for (std::size_t index = 0; index < jobs.size(); index++) {
+        ExpectSameResult(second[jobs.size() - 1 - index], first[index]);
+    }
+}
+
+TEST_F(BatchRunnerTests, IllegalOpcodesOnlyFailTheirJob) {
+    // Given:
+    BatchRunner runner(2);
+    const std::vector<BatchRunner::Job> jobs = MakeJobs(3);
+
+    // When:
+    const std::vector<BatchRunner::Result> results = runner.run(jobs);
+
+    // Then:
+    EXPECT_FALSE(results[0].failed);
+    EXPECT_FALSE(results[1].failed);
+    EXPECT_TRUE(results[2].failed);
+    EXPECT_EQ(results[2].registers.A, 0x01);
+    EXPECT_EQ(results[2].registers.PC, 0x2003);
+}
+
+TEST_F(BatchRunnerTests, JobsCanStartAtAnyPC) {
+    // Given:
+    BatchRunner runner(1);
+    BatchRunner::Job job;
+    job.image = illegal;
+    job.noBytes = illegalBytes;
+    job.resetPC = false;
+    job.registers.PC = 0x2002;
+    job.cycles = 2;
+
+    // When:
+    const std::vector<BatchRunner::Result> results = runner.run({job});
+
+    // Then: the lda is skipped
+    EXPECT_TRUE(results[0].failed);
+    EXPECT_EQ(results[0].registers.A, 0x00);
+}
+
+TEST_F(BatchRunnerTests, PoolRunsEveryTaskOnceAcrossBatches) {
+    // Given:
+    WorkStealingPool pool(3);
+    std::vector<std::atomic<int>> runs(1000);
+    for (std::atomic<int>& count : runs) count = 0;
+
+    // When: uneven tasks, so the workers with short ones steal
+    for (int batch = 0; batch < 3; batch++) {
+        pool.run(runs.size(), [&](unsigned worker, std::size_t index) {
+            EXPECT_LT(worker, 3);
+            volatile unsigned spin = 0;
+            for (std::size_t i = 0; i < (index < 300 ? 20000 : 10); i++) spin = spin + 1;
+            runs[index]++;
+        });
+    }
+    pool.run(0, [](unsigned, std::size_t) { FAIL(); });
+
+    // Then:
+    for (std::size_t index = 0; index < runs.size(); index++) {
+        EXPECT_EQ(runs[index], 3) << index;
+    }
+}
@@ -0,0 +1,122 @@
+#include "gtest/gtest.h"
+#include "../src/Computer.h"
+
+class BlockCacheTests : public ::testing::Test {
+public:
+    Computer computer;
+
+    void SetUp() override {
+        computer.reset();
+        computer.engine = Computer::Engine::Blocks;
+    }
+    void TearDown() override {}
+};
+
+TEST_F(BlockCacheTests, BlocksEndAtBranches) {
+    //Given:
+    /*
+    * = $2000
+
+    lda #$01
+    loop:
+    ldx #$02
+    inx
+    bne loop
+     */
+    const dword noBytes = 9;
+    const byte program[noBytes] = {0x00, 0x20, 0xA9, 0x01, 0xA2, 0x02, 0xE8, 0xD0, 0xFB};
+
+    // When:
+    computer.loadProgram(program, noBytes);
+    const BlockCache::Block& block = computer.blockCache.lookup(0x2000, computer.memory);
+
+    // Then:
+    EXPECT_EQ(block.ops.size(), 4);
+    EXPECT_EQ(block.end, 0x2007);
+    EXPECT_EQ(block.worstCycles, 2 + 2 + 2);
+}
+
+TEST_F(BlockCacheTests, TranslatingLeavesThePagesClean) {
+    //Given:
+    computer.memory[0x2000] = CPU::inxImp;
+    computer.memory[0x2001] = CPU::jmpAbs;
+    computer.memory.writeWord(0x2000, 0x2002);
+
+    // When:
+    const BlockCache::Block& block = computer.blockCache.lookup(0x2000, computer.memory);
+    const BlockCache::Block& again = computer.blockCache.lookup(0x2000, computer.memory);
+
+    // Then:
+    EXPECT_FALSE(computer.memory.isPageDirty(0x20));
+    EXPECT_EQ(block.generations[0], again.generations[0]);
+}
+
+TEST_F(BlockCacheTests, LoopBlocksAreChained) {
+    //Given:
+    /*
+    * = $2000
+
+    loop:
+    inc $80
+    inx
+    jmp loop
+     */
+    const dword noBytes = 8;
+    const byte program[noBytes] = {0x00, 0x20, 0xE6, 0x80, 0xE8, 0x4C, 0x00, 0x20};
+    const int CYCLES_PER_LOOP = 5 + 2 + 3;
+    const int LOOP_COUNT = 0x20;
+
+    // When:
+    computer.loadProgram(program, noBytes);
+    computer.resetPC();
+    int cyclesExecuted = computer.run(CYCLES_PER_LOOP * LOOP_COUNT);
+    const BlockCache::Block& block = computer.blockCache.lookup(0x2000, computer.memory);
+
+    // Then:
+    EXPECT_EQ(cyclesExecuted, CYCLES_PER_LOOP * LOOP_COUNT);
+    EXPECT_EQ(computer.memory[0x0080], LOOP_COUNT);
+    EXPECT_EQ(computer.cpu.X, LOOP_COUNT);
+    EXPECT_EQ(block.next[0], &block);
+    EXPECT_EQ(computer.blockCache.size(), 1);
+}
+
+TEST_F(BlockCacheTests, WritesToTheRunningBlockAreExecuted) {
+    //Given:
+    /*
+    * = $2000
+
+    lda #$42
+    sta $2006
+    lda #$00
+     */
+    const dword noBytes = 9;
+    const byte program[noBytes] = {0x00, 0x20, 0xA9, 0x42, 0x8D, 0x06, 0x20, 0xA9, 0x00};
+
+    // When:
+    computer.loadProgram(program, noBytes);
+    computer.resetPC();
+    int cyclesExecuted = computer.run(2 + 4 + 2);
+
+    // Then:
+    EXPECT_EQ(cyclesExecuted, 2 + 4 + 2);
+    EXPECT_EQ(computer.cpu.A, 0x42);
+}
+
+TEST_F(BlockCacheTests, BudgetEndingInsideABlockMatchesInterpreter) {
+    // Given:
+    computer.memory[0x1000] = CPU::ldaImm;
+    computer.memory[0x1001] = 0x01;
+    computer.memory[0x1002] = CPU::ldxImm;
+    computer.memory[0x1003] = 0x02;
+    computer.memory[0x1004] = CPU::ldyImm;
+    computer.memory[0x1005] = 0x03;
+
+    // When:
+    int cyclesExecuted = computer.run(3);
+
+    // Then:
+    EXPECT_EQ(cyclesExecuted, 4);
+    EXPECT_EQ(computer.cpu.PC, 0x1004);
+    EXPECT_EQ(computer.cpu.X, 0x02);
+    EXPECT_EQ(computer.cpu.Y, 0x00);
+}
@@ -0,0 +1,93 @@
+#include "gtest/gtest.h"
+#include "../src/Computer.h"
+
+class DecodeCacheTests : public ::testing::Test {
+public:
+    Computer computer;
+
+    void SetUp() override {
+        computer.reset();
+        computer.engine = Computer::Engine::Decoded;
+    }
+    void TearDown() override {}
+};
+
+TEST_F(DecodeCacheTests, SelfModifyingCodeIsExecuted) {
+    //Given:
+    /*
+    * = $2000
+
+    loop:
+    lda #$00
+    inc $2001
+    jmp loop
+     */
+    const dword noBytes = 10;
+    const byte program[noBytes] = {0x00, 0x20, 0xA9, 0x00, 0xEE, 0x01, 0x20, 0x4C, 0x00, 0x20};
+    const int CYCLES_PER_LOOP = 2 + 6 + 3;
+    const int LOOP_COUNT = 0x30;
+
+    // When:
+    computer.loadProgram(program, noBytes);
+    computer.resetPC();
+    int cyclesExecuted = computer.run(CYCLES_PER_LOOP * LOOP_COUNT + 2);
+
+    // Then:
+    EXPECT_EQ(cyclesExecuted, CYCLES_PER_LOOP * LOOP_COUNT + 2);
+    EXPECT_EQ(computer.cpu.A, LOOP_COUNT);
+    EXPECT_EQ(computer.memory[0x2001], LOOP_COUNT);
+}
+
+TEST_F(DecodeCacheTests, WritesBetweenRunsAreExecuted) {
+    // Given:
+    computer.memory[0x1000] = CPU::ldaImm;
+    computer.memory[0x1001] = 0x10;
+    computer.run(2);
+    computer.resetPC();
+
+    // When:
+    computer.memory[0x1001] = 0x20;
+    computer.run(2);
+
+    // Then:
+    EXPECT_EQ(computer.cpu.A, 0x20);
+}
+
+TEST_F(DecodeCacheTests, WritesToTheNextPageInvalidateCrossingInstructions) {
+    // Given:
+    computer.cpu.PC = 0x10FE;
+    computer.memory[0x10FE] = CPU::ldaAbs;
+    computer.memory[0x10FF] = 0x80;
+    computer.memory[0x1100] = 0x30;
+    computer.memory[0x3080] = 0x11;
+    computer.memory[0x4080] = 0x22;
+    computer.run(4);
+    computer.cpu.PC = 0x10FE;
+
+    // When:
+    computer.memory[0x1100] = 0x40;
+    computer.run(4);
+
+    // Then:
+    EXPECT_EQ(computer.cpu.A, 0x22);
+}
+
+TEST_F(DecodeCacheTests, UntouchedPagesStayDecoded) {
+    // Given:
+    computer.memory[0x1000] = CPU::ldaImm;
+    computer.memory[0x1001] = 0x10;
+    computer.run(2);
+    computer.resetPC();
+
+    // When:
+    computer.memory[0x2000] = 0xFF;
+    computer.run(2);
+    const DecodeCache::Entry& decoded = computer.decodeCache.lookup(0x1000, computer.memory);
+
+    // Then:
+    EXPECT_FALSE(computer.memory.isPageDirty(0x10));
+    EXPECT_TRUE(computer.memory.isPageDirty(0x20));
+    EXPECT_EQ(decoded.operand & 0xFF, 0x10);
+    EXPECT_EQ(decoded.cycles, 2);
+    EXPECT_EQ(decoded.length, 2);
+}
@@ -0,0 +1,238 @@
+#include "gtest/gtest.h"
+#include "../src/Computer.h"
+
+class DispatchTests : public ::testing::Test {
+public:
+    static const int SEEDS = 4;
+    Computer reference;
+    Computer computer;
+
+    void SetUp() override { reference.reset(); computer.reset(); }
+    void TearDown() override {}
+
+    /// Fills both computers with the same pseudo random memory and registers.
+    void Randomize(unsigned seed, byte opcode) {
+        unsigned state = seed * 2654435761u + opcode;
+        for (dword address = 0; address < 0xFFFA; address++) {
+            state = state * 1103515245u + 12345u;
+            reference.memory[address] = computer.memory[address] = (byte) (state >> 16);
+        }
+        reference.memory[0x1000] = computer.memory[0x1000] = opcode;
+        reference.cpu.A = computer.cpu.A = (byte) (state >> 8);
+        reference.cpu.X = computer.cpu.X = (byte) (state >> 4);
+        reference.cpu.Y = computer.cpu.Y = (byte) (state >> 12);
+        reference.cpu.status = computer.cpu.status = (byte) (state >> 20) & CPU::STATUS_MASK;
+    }
+
+    void ExpectSameState() const {
+        EXPECT_EQ(computer.cpu.PC, reference.cpu.PC);
+        EXPECT_EQ(computer.cpu.SP, reference.cpu.SP);
+        EXPECT_EQ(computer.cpu.A, reference.cpu.A);
+        EXPECT_EQ(computer.cpu.X, reference.cpu.X);
+        EXPECT_EQ(computer.cpu.Y, reference.cpu.Y);
+        EXPECT_EQ(computer.cpu.status, reference.cpu.status);
+        for (dword address = 0; address <= 0xFFFF; address++) {
+            if (computer.memory[address] != reference.memory[address]) {
+                ADD_FAILURE() << "Memory differs at 0x" << std::hex << address;
+                return;
+            }
+        }
+    }
+
+    /// Runs every opcode on both computers and compares the engine given against the switch.
+    void ExpectSameAsSwitch(CPU::Dispatch dispatch, bool staticCycles = false,
+                            Computer::Engine engine = Computer::Engine::Interpreter) {
+        reference.cpu.dispatch = CPU::Dispatch::Switch;
+        reference.cpu.staticCycles = false;
+        reference.engine = Computer::Engine::Interpreter;
+        computer.cpu.dispatch = dispatch;
+        computer.cpu.staticCycles = staticCycles;
+        computer.engine = engine;
+        for (int opcode = 0; opcode <= 0xFF; opcode++) {
+            for (unsigned seed = 0; seed < SEEDS; seed++) {
+                SCOPED_TRACE(::testing::Message() << "opcode 0x" << std::hex << opcode << " seed " << seed);
+                Randomize(seed, (byte) opcode);
+                const CPU::Result expected = reference.execute(1);
+                const CPU::Result result = computer.execute(1);
+                EXPECT_EQ(result.stop, expected.stop);
+                EXPECT_EQ(result.cycles, expected.cycles);
+                EXPECT_EQ(result.pc, expected.pc);
+                ExpectSameState();
+            }
+        }
+    }
+
+    /// Runs the same counting loop on both computers.
+    void ExpectSameProgramAsSwitch(CPU::Dispatch dispatch, bool staticCycles = false,
+                                   Computer::Engine engine = Computer::Engine::Interpreter) {
+        /*
+        * = $2000
+
+        ldx #$00
+        loop:
+        inc $80
+        inx
+        bne loop
+        jmp $2000
+         */
+        const dword noBytes = 13;
+        const byte program[noBytes] = {0x00, 0x20, 0xA2, 0x00, 0xE6, 0x80, 0xE8, 0xD0, 0xFB, 0x4C, 0x00, 0x20, 0xEA};
+        reference.loadProgram(program, noBytes);
+        computer.loadProgram(program, noBytes);
+        reference.resetPC();
+        computer.resetPC();
+        reference.cpu.dispatch = CPU::Dispatch::Switch;
+        reference.cpu.staticCycles = false;
+        reference.engine = Computer::Engine::Interpreter;
+        computer.cpu.dispatch = dispatch;
+        computer.cpu.staticCycles = staticCycles;
+        computer.engine = engine;
+
+        for (int cycles : {1, 7, 100, 2567, 10000}) {
+            EXPECT_EQ(computer.run(cycles), reference.run(cycles));
+            ExpectSameState();
+        }
+    }
+};
+
+// ================== //
+//       Table        //
+// ================== //
+
+TEST_F(DispatchTests, table_EveryOpcodeMatchesSwitch) {
+    ExpectSameAsSwitch(CPU::Dispatch::Table);
+}
+
+TEST_F(DispatchTests, table_ProgramMatchesSwitch) {
+    ExpectSameProgramAsSwitch(CPU::Dispatch::Table);
+}
+
+// ================== //
+//      Threaded      //
+// ================== //
+
+TEST_F(DispatchTests, threaded_EveryOpcodeMatchesSwitch) {
+    ExpectSameAsSwitch(CPU::Dispatch::Threaded);
+}
+
+TEST_F(DispatchTests, threaded_ProgramMatchesSwitch) {
+    ExpectSameProgramAsSwitch(CPU::Dispatch::Threaded);
+}
+
+// ================== //
+//   Static Cycles    //
+// ================== //
+
+TEST_F(DispatchTests, staticCycles_EveryOpcodeMatchesSwitch) {
+    ExpectSameAsSwitch(CPU::Dispatch::Switch, true);
+    ExpectSameAsSwitch(CPU::Dispatch::Threaded, true);
+}
+
+TEST_F(DispatchTests, staticCycles_ProgramMatchesSwitch) {
+    ExpectSameProgramAsSwitch(CPU::Dispatch::Table, true);
+}
+
+// ================== //
+//    Decode Cache    //
+// ================== //
+
+TEST_F(DispatchTests, decodeCache_EveryOpcodeMatchesSwitch) {
+    ExpectSameAsSwitch(CPU::Dispatch::Switch, false, Computer::Engine::Decoded);
+}
+
+TEST_F(DispatchTests, decodeCache_ProgramMatchesSwitch) {
+    ExpectSameProgramAsSwitch(CPU::Dispatch::Switch, false, Computer::Engine::Decoded);
+}
+
+// ================== //
+//    Block Cache     //
+// ================== //
+
+TEST_F(DispatchTests, blockCache_EveryOpcodeMatchesSwitch) {
+    ExpectSameAsSwitch(CPU::Dispatch::Switch, false, Computer::Engine::Blocks);
+}
+
+TEST_F(DispatchTests, blockCache_ProgramMatchesSwitch) {
+    ExpectSameProgramAsSwitch(CPU::Dispatch::Switch, false, Computer::Engine::Blocks);
+}
+
+// ================== //
+//        JIT         //
+// ================== //
+
+TEST_F(DispatchTests, jit_EveryOpcodeMatchesSwitch) {
+    computer.jit.hotThreshold = 1;
+    ExpectSameAsSwitch(CPU::Dispatch::Switch, false, Computer::Engine::Jit);
+}
+
+TEST_F(DispatchTests, jit_ProgramMatchesSwitch) {
+    computer.jit.hotThreshold = 1;
+    ExpectSameProgramAsSwitch(CPU::Dispatch::Switch, false, Computer::Engine::Jit);
+}
+
+// ================== //
+//       Tiered       //
+// ================== //
+
+TEST_F(DispatchTests, tiered_EveryOpcodeMatchesSwitch) {
+    computer.tiered.warmThreshold = computer.tiered.hotThreshold = 1;
+    ExpectSameAsSwitch(CPU::Dispatch::Switch, false, Computer::Engine::Tiered);
+}
+
+TEST_F(DispatchTests, tiered_ProgramMatchesSwitch) {
+    computer.tiered.hotThreshold = 3;
+    ExpectSameProgramAsSwitch(CPU::Dispatch::Switch, false, Computer::Engine::Tiered);
+}
+
+// ================== //
+//     Lazy Flags     //
+// ================== //
+
+TEST_F(DispatchTests, lazyFlags_StatusIsUpToDateAfterEveryEngine) {
+    for (Computer::Engine engine : {Computer::Engine::Interpreter, Computer::Engine::Decoded, Computer::Engine::Blocks,
+                                    Computer::Engine::Jit, Computer::Engine::Tiered}) {
+        // Given:
+        computer.reset();
+        computer.engine = engine;
+        computer.memory[0x1000] = CPU::ldaImm;
+        computer.memory[0x1001] = 0x00;
+        computer.memory[0x1002] = CPU::ldxImm;
+        computer.memory[0x1003] = 0x80;
+
+        // When:
+        computer.run(4);
+
+        // Then:
+        EXPECT_EQ(computer.cpu.status, (byte) CPU::FLAG_N);
+        EXPECT_FALSE(computer.cpu.flag.Z);
+        EXPECT_TRUE(computer.cpu.flag.N);
+    }
+}
+
+TEST_F(DispatchTests, lazyFlags_PhpPushesPendingFlags) {
+    // Given:
+    computer.memory[0x1000] = CPU::ldaImm;
+    computer.memory[0x1001] = 0x00;
+    computer.memory[0x1002] = CPU::phpImp;
+
+    // When:
+    computer.run(2 + 3);
+
+    // Then:
+    EXPECT_EQ(computer.memory[0x01FF], CPU::FLAG_Z | 0b00110000);
+}
+
+TEST_F(DispatchTests, lazyFlags_PlpDropsPendingFlags) {
+    // Given:
+    computer.memory[0x01FF] = CPU::FLAG_Z;
+    computer.cpu.SP = 0xFE;
+    computer.memory[0x1000] = CPU::ldaImm;
+    computer.memory[0x1001] = 0x80;
+    computer.memory[0x1002] = CPU::plpImp;
+
+    // When:
+    computer.run(2 + 4);
+
+    // Then:
+    EXPECT_EQ(computer.cpu.status, (byte) CPU::FLAG_Z);
+}
@@ -0,0 +1,134 @@
+#include <memory>
+#include "gtest/gtest.h"
+#include "../src/Computer.h"
+#include "../src/cpu/Opcodes.h"
+
+class ExecutionBudgetTests : public ::testing::Test {
+public:
+    /*
+    * = $2000
+
+    loop:
+    inx
+    lda $20F0,X ; crosses a page from X = $10 on
+    sta $80
+    bne loop
+    inc $81
+    jmp loop
+     */
+    static const dword noBytes = 15;
+    const byte program[noBytes] = {0x00, 0x20, 0xE8, 0xBD, 0xF0, 0x20, 0x85, 0x80, 0xD0, 0xF8,
+                                   0xE6, 0x81, 0x4C, 0x00, 0x20};
+    std::unique_ptr<Computer> computer{new Computer()};
+    std::unique_ptr<Computer> reference{new Computer()};
+
+    void SetUp() override {
+        for (Computer* target : {computer.get(), reference.get()}) {
+            target->loadProgram(program, noBytes);
+            for (word address = 0x2100; address < 0x2200; address += 3) target->memory[address] = (byte) address;
+            target->resetPC();
+        }
+    }
+
+    void ExpectSameState() const {
+        EXPECT_EQ(computer->cpu.PC, reference->cpu.PC);
+        EXPECT_EQ(computer->cpu.A, reference->cpu.A);
+        EXPECT_EQ(computer->cpu.X, reference->cpu.X);
+        EXPECT_EQ(computer->cpu.status, reference->cpu.status);
+        const Memory& memory = computer->memory;
+        const Memory& expected = reference->memory;
+        EXPECT_EQ(memory[0x80], expected[0x80]);
+        EXPECT_EQ(memory[0x81], expected[0x81]);
+    }
+};
+
+TEST_F(ExecutionBudgetTests, InstructionBudgetsStopAfterThatManyInstructions) {
+    for (std::uint64_t instructions : {1, 2, 7, 100, 1000}) {
+        SCOPED_TRACE(instructions);
+        SetUp();
+        // Given:
+        CPU::Budget budget;
+        budget.instructions = instructions;
+
+        // When:
+        const CPU::Result result = computer->execute(budget);
+
+        // Then: the same as single instruction runs
+        int cycles = 0;
+        for (std::uint64_t instruction = 0; instruction < instructions; instruction++) cycles += reference->run(1);
+        EXPECT_EQ(result.stop, CPU::Stop::Budget);
+        EXPECT_EQ(result.instructions, instructions);
+        EXPECT_EQ(result.cycles, cycles);
+        ExpectSameState();
+    }
+}
+
+TEST_F(ExecutionBudgetTests, ExactBudgetsNeverOvershoot) {
+    for (int cycles = 1; cycles < 200; cycles += 7) {
+        SCOPED_TRACE(cycles);
+        SetUp();
+        // Given:
+        CPU::Budget budget;
+        budget.cycles = cycles;
+        budget.exact = true;
+
+        // When:
+        const CPU::Result result = computer->execute(budget);
+
+        // Then: stopped before the first instruction that didn't fit
+        EXPECT_EQ(result.stop, CPU::Stop::Budget);
+        EXPECT_LE(result.cycles, cycles);
+        EXPECT_GT(computer->cpu.instructionCycles(computer->memory), cycles - result.cycles);
+        int executed = 0;
+        for (std::uint64_t instruction = 0; instruction < result.instructions; instruction++) executed += reference->run(1);
+        EXPECT_EQ(result.cycles, executed);
+        ExpectSameState();
+    }
+}
+
+TEST_F(ExecutionBudgetTests, SlicesResumeWhereTheyStopped) {
+    // Given:
+    CPU::Budget slice;
+    slice.cycles = 97;
+    slice.exact = true;
+
+    // When:
+    int cycles = 0;
+    for (int run = 0; run < 100; run++) cycles += computer->execute(slice).cycles;
+
+    // Then:
+    CPU::Budget whole;
+    whole.cycles = cycles;
+    whole.exact = true;
+    EXPECT_EQ(reference->execute(whole).cycles, cycles);
+    ExpectSameState();
+}
+
+TEST_F(ExecutionBudgetTests, InstructionCyclesMatchExecution) {
+    for (int opcode = 0; opcode <= 0xFF; opcode++) {
+        if (!opcodeTable[opcode].isLegal()) continue;
+        for (unsigned seed = 0; seed < 16; seed++) {
+            SCOPED_TRACE(::testing::Message() << "opcode 0x" << std::hex << opcode << " seed " << seed);
+            // Given: pseudo random operands, pointers and flags
+            Computer& target = *computer;
+            unsigned state = seed * 2654435761u + opcode;
+            for (dword address = 0; address < 0x100; address++) {
+                state = state * 1103515245u + 12345u;
+                target.memory[address] = (byte) (state >> 16);
+            }
+            target.memory[0x30F0] = opcode;
+            target.memory[0x30F1] = (byte) (state >> 3);
+            target.memory[0x30F2] = (byte) (state >> 11);
+            target.cpu.PC = 0x30F0;
+            target.cpu.X = (byte) (state >> 4);
+            target.cpu.Y = (byte) (state >> 12);
+            target.cpu.status = (byte) (state >> 20) & CPU::STATUS_MASK;
+
+            // When:
+            const int expected = target.cpu.instructionCycles(target.memory);
+
+            // Then:
+            EXPECT_EQ(target.run(1), expected);
+        }
+    }
+}
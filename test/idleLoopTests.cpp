@@ -0,0 +1,233 @@
+#include <memory>
+#include <vector>
+#include "gtest/gtest.h"
+#include "../src/Computer.h"
+
+class IdleLoopTests : public ::testing::Test {
+public:
+    std::unique_ptr<Computer> skipping{new Computer()};
+    std::unique_ptr<Computer> stepping{new Computer()};
+
+    void SetUp() override {
+        for (Computer* computer : {skipping.get(), stepping.get()}) {
+            computer->engine = Computer::Engine::Interpreter;
+        }
+        stepping->cpu.idleSkip = false;
+        skipping->cpu.idleSkip = true;
+    }
+
+    void Load(const byte* program, dword noBytes) {
+        for (Computer* computer : {skipping.get(), stepping.get()}) {
+            computer->reset();
+            computer->loadProgram(program, noBytes);
+            computer->resetPC();
+        }
+    }
+
+    /// @brief Runs both computers on budgets cutting the loops everywhere, expecting the same results.
+    void ExpectSameRuns() {
+        for (int budget : {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 50, 99, 1000, 12345}) {
+            SCOPED_TRACE(budget);
+            EXPECT_EQ(skipping->run(budget), stepping->run(budget));
+            EXPECT_EQ(skipping->cpu.PC, stepping->cpu.PC);
+            EXPECT_EQ(skipping->cpu.A, stepping->cpu.A);
+            EXPECT_EQ(skipping->cpu.X, stepping->cpu.X);
+            EXPECT_EQ(skipping->cpu.Y, stepping->cpu.Y);
+            EXPECT_EQ(skipping->cpu.SP, stepping->cpu.SP);
+            EXPECT_EQ(skipping->cpu.status, stepping->cpu.status);
+        }
+        EXPECT_EQ(skipping->saveState(), stepping->saveState());
+    }
+
+    void ExpectSameRunsOnEveryMode(const byte* program, dword noBytes) {
+        for (CPU::Dispatch dispatch : {CPU::Dispatch::Switch, CPU::Dispatch::Table, CPU::Dispatch::Threaded}) {
+            for (bool staticCycles : {false, true}) {
+                SCOPED_TRACE(::testing::Message() << "dispatch " << (int) dispatch << " static " << staticCycles);
+                Load(program, noBytes);
+                for (Computer* computer : {skipping.get(), stepping.get()}) {
+                    computer->cpu.dispatch = dispatch;
+                    computer->cpu.staticCycles = staticCycles;
+                }
+                ExpectSameRuns();
+            }
+        }
+    }
+
+    /// @brief Same runs with the skipping computer on every other engine of Computer.
+    void ExpectSameRunsOnEveryEngine(const byte* program, dword noBytes) {
+        for (Computer::Engine engine : {Computer::Engine::Decoded, Computer::Engine::Blocks,
+                                        Computer::Engine::Jit, Computer::Engine::Tiered}) {
+            SCOPED_TRACE(::testing::Message() << "engine " << (int) engine);
+            Load(program, noBytes);
+            skipping->engine = engine;
+            ExpectSameRuns();
+        }
+        skipping->engine = Computer::Engine::Interpreter;
+    }
+};
+
+TEST_F(IdleLoopTests, JumpsToThemselvesAreSkipped) {
+    /*
+    * = $2000
+
+    lda #$05
+    jmp *
+     */
+    const dword noBytes = 7;
+    const byte program[noBytes] = {0x00, 0x20, 0xA9, 0x05, 0x4C, 0x02, 0x20};
+    ExpectSameRunsOnEveryMode(program, noBytes);
+    ExpectSameRunsOnEveryEngine(program, noBytes);
+
+    // When: a billion cycles
+    Load(program, noBytes);
+    const int cycles = skipping->run(1000000000);
+
+    // Then:
+    EXPECT_GE(cycles, 1000000000);
+    EXPECT_EQ(skipping->cpu.PC, 0x2002);
+}
+
+TEST_F(IdleLoopTests, BranchesToThemselvesAreSkipped) {
+    /*
+    * = $20FE
+
+    lda #$00
+    beq *
+     */
+    const dword noBytes = 6;
+    const byte program[noBytes] = {0xFE, 0x20, 0xA9, 0x00, 0xF0, 0xFE};
+    ExpectSameRunsOnEveryMode(program, noBytes);
+    ExpectSameRunsOnEveryEngine(program, noBytes);
+}
+
+TEST_F(IdleLoopTests, PollingLoopsAreSkipped) {
+    /*
+    * = $20F0
+
+    poll:
+    lda $80
+    beq poll
+    pollAbs:
+    ldx $3000
+    bpl pollAbs
+    pollBit:
+    bit $81
+    bvc pollBit
+     */
+    const dword noBytes = 15;
+    const byte program[noBytes] = {0xF0, 0x20, 0xA5, 0x80, 0xF0, 0xFC, 0xAE, 0x00, 0x30, 0x10, 0xFB, 0x24, 0x81, 0x50, 0xFC};
+    ExpectSameRunsOnEveryMode(program, noBytes);
+    ExpectSameRunsOnEveryEngine(program, noBytes);
+
+    // Given: polling the two others
+    for (Computer* computer : {skipping.get(), stepping.get()}) {
+        computer->memory[0x0080] = 0x01;
+        computer->cpu.PC = 0x20F0;
+    }
+
+    // When / Then:
+    ExpectSameRuns();
+}
+
+TEST_F(IdleLoopTests, LoopsEnteredAtTheirBranchAreLeftAsTheyRun) {
+    /*
+    * = $2000
+
+    ldx #$00
+    lda #$00
+    jmp branch
+    loop:
+    lda $80
+    branch:
+    beq loop
+    counting:
+    dex
+    bne counting
+    jmp *
+     */
+    const dword noBytes = 19;
+    const byte program[noBytes] = {0x00, 0x20, 0xA2, 0x00, 0xA9, 0x00, 0x4C, 0x09, 0x20, 0xA5, 0x80, 0xF0, 0xFC,
+                                   0xCA, 0xD0, 0xFD, 0x4C, 0x0E, 0x20};
+    Load(program, noBytes);
+    for (Computer* computer : {skipping.get(), stepping.get()}) computer->memory[0x0080] = 0x01;
+    ExpectSameRuns();
+}
+
+TEST_F(IdleLoopTests, CountingLoopsAreComputedInClosedForm) {
+    /*
+    * = $2000
+
+    ldx #$00
+    ldy #$10
+    dey
+    bne *-1
+    dex
+    bne *-1
+    inx
+    bne *-1
+    iny
+    bne *-1
+    jmp $2000
+     */
+    const dword noBytes = 21;
+    const byte program[noBytes] = {0x00, 0x20, 0xA2, 0x00, 0xA0, 0x10, 0x88, 0xD0, 0xFD, 0xCA, 0xD0, 0xFD,
+                                   0xE8, 0xD0, 0xFD, 0xC8, 0xD0, 0xFD, 0x4C, 0x00, 0x20};
+    ExpectSameRunsOnEveryMode(program, noBytes);
+    ExpectSameRunsOnEveryEngine(program, noBytes);
+}
+
+TEST_F(IdleLoopTests, DevicesAreStillPolled) {
+    /*
+    * = $2000
+
+    poll:
+    lda $D000
+    bne poll
+    jmp *
+     */
+    class Countdown : public Device {
+    public:
+        int reads = 0;
+        byte read(word) override { return ++reads < 100 ? 1 : 0; }
+        void write(word, byte) override {}
+    } device;
+    const dword noBytes = 10;
+    const byte program[noBytes] = {0x00, 0x20, 0xAD, 0x00, 0xD0, 0xD0, 0xFB, 0x4C, 0x05, 0x20};
+    Load(program, noBytes);
+    skipping->memory.map(0xD0, device);
+
+    // When:
+    skipping->run(100000);
+
+    // Then:
+    EXPECT_EQ(device.reads, 100);
+    EXPECT_EQ(skipping->cpu.PC, 0x2005);
+}
+
+TEST_F(IdleLoopTests, DefaultEngineSkipsIdleLoops) {
+    /*
+    * = $2000
+
+    ldx #$00
+    delay:
+    dex
+    bne delay
+    poll:
+    lda $80
+    beq poll
+     */
+    const dword noBytes = 11;
+    const byte program[noBytes] = {0x00, 0x20, 0xA2, 0x00, 0xCA, 0xD0, 0xFD, 0xA5, 0x80, 0xF0, 0xFC};
+    Computer computer;
+    computer.cpu.idleSkip = true;
+    computer.loadProgram(program, noBytes);
+    computer.resetPC();
+
+    // When: a billion cycles, far more than stepping through them would take in time
+    const int cycles = computer.run(1000000000);
+
+    // Then:
+    EXPECT_GE(cycles, 1000000000);
+    EXPECT_EQ(computer.cpu.X, 0x00);
+    EXPECT_GE(computer.cpu.PC, 0x2005);
+}
@@ -0,0 +1,194 @@
+#include "gtest/gtest.h"
+#include "../src/Computer.h"
+#include "../src/cpu/Opcodes.h"
+
+class JitTests : public ::testing::Test {
+public:
+    Computer reference;
+    Computer computer;
+
+    void SetUp() override {
+        reference.reset();
+        computer.reset();
+        computer.engine = Computer::Engine::Jit;
+        computer.jit.hotThreshold = 1;
+    }
+    void TearDown() override {}
+
+    void LoadProgram(const byte* program, dword noBytes) {
+        reference.loadProgram(program, noBytes);
+        computer.loadProgram(program, noBytes);
+        reference.resetPC();
+        computer.resetPC();
+    }
+
+    void ExpectSameState() const {
+        EXPECT_EQ(computer.cpu.PC, reference.cpu.PC);
+        EXPECT_EQ(computer.cpu.SP, reference.cpu.SP);
+        EXPECT_EQ(computer.cpu.A, reference.cpu.A);
+        EXPECT_EQ(computer.cpu.X, reference.cpu.X);
+        EXPECT_EQ(computer.cpu.Y, reference.cpu.Y);
+        EXPECT_EQ(computer.cpu.status, reference.cpu.status);
+        for (dword address = 0; address <= 0xFFFF; address++) {
+            if (computer.memory[address] != reference.memory[address]) {
+                ADD_FAILURE() << "Memory differs at 0x" << std::hex << address;
+                return;
+            }
+        }
+    }
+
+    void ExpectSameRuns(std::initializer_list<int> budgets) {
+        for (int cycles : budgets) {
+            EXPECT_EQ(computer.run(cycles), reference.run(cycles));
+            ExpectSameState();
+        }
+    }
+};
+
+TEST_F(JitTests, EveryOpcodeMatchesInterpreterInALoop) {
+    for (int opcode = 0; opcode <= 0xFF; opcode++) {
+        const OpcodeInfo& info = opcodeTable[opcode];
+        if (!info.isLegal()) continue;
+        for (unsigned seed = 0; seed < 4; seed++) {
+            SCOPED_TRACE(::testing::Message() << info.mnemonic << " seed " << seed);
+            // Given: the opcode followed by a jump back to it, with pseudo random memory and registers
+            unsigned state = seed * 2654435761u + opcode;
+            for (dword address = 0; address < 0xFFFA; address++) {
+                state = state * 1103515245u + 12345u;
+                reference.memory[address] = computer.memory[address] = (byte) (state >> 16);
+            }
+            const word jump = 0x1000 + instructionLength(info.mode);
+            for (Computer* target : {&reference, &computer}) {
+                target->memory[0x1000] = opcode;
+                target->memory[jump] = CPU::jmpAbs;
+                target->memory.writeWord(0x1000, jump + 1);
+                target->cpu.PC = 0x1000;
+                target->cpu.SP = (byte) (state >> 24);
+                target->cpu.A = (byte) (state >> 8);
+                target->cpu.X = (byte) (state >> 4);
+                target->cpu.Y = (byte) (state >> 12);
+                target->cpu.status = (byte) (state >> 20) & CPU::STATUS_MASK;
+            }
+
+            // When:
+            const CPU::Result expected = reference.execute(50);
+            const CPU::Result result = computer.execute(50);
+
+            // Then:
+            EXPECT_EQ(result.stop, expected.stop);
+            EXPECT_EQ(result.cycles, expected.cycles);
+            EXPECT_EQ(result.pc, expected.pc);
+            ExpectSameState();
+        }
+    }
+}
+
+TEST_F(JitTests, HotBlocksAreCompiled) {
+    // Given:
+    /*
+    * = $2000
+
+    loop:
+    inc $80
+    inx
+    jmp loop
+     */
+    const dword noBytes = 8;
+    const byte program[noBytes] = {0x00, 0x20, 0xE6, 0x80, 0xE8, 0x4C, 0x00, 0x20};
+    const int CYCLES_PER_LOOP = 5 + 2 + 3;
+    computer.jit.hotThreshold = 4;
+
+    // When:
+    LoadProgram(program, noBytes);
+    computer.run(CYCLES_PER_LOOP * 2);
+    const dword compiledCold = computer.jit.size();
+    computer.run(1000);
+
+    // Then:
+    EXPECT_EQ(compiledCold, 0);
+    EXPECT_EQ(computer.jit.size(), Jit::isSupported() ? 1 : 0);
+    reference.run(CYCLES_PER_LOOP * 2 + 1000);
+    ExpectSameState();
+}
+
+TEST_F(JitTests, CompiledBlocksOutliveClearedBlockCache) {
+    // Given:
+    /*
+    * = $2000
+
+    loop:
+    inc $80
+    inx
+    jmp loop
+     */
+    const dword noBytes = 8;
+    const byte program[noBytes] = {0x00, 0x20, 0xE6, 0x80, 0xE8, 0x4C, 0x00, 0x20};
+
+    // When: the blocks compiled are freed and translated again
+    LoadProgram(program, noBytes);
+    computer.run(1000);
+    computer.blockCache.clear();
+    computer.run(1000);
+    computer.blockCache.clear();
+    computer.run(1000);
+
+    // Then:
+    EXPECT_EQ(computer.jit.size(), Jit::isSupported() ? 1 : 0);
+    reference.run(3000);
+    ExpectSameState();
+}
+
+TEST_F(JitTests, SelfModifyingLoopMatchesInterpreter) {
+    // Given:
+    /*
+    * = $2000
+
+    ldx #$00
+    loop:
+    inx
+    stx $2007
+    lda #$00
+    sta $3000,X
+    bne loop
+    jmp *
+     */
+    const dword noBytes = 18;
+    const byte program[noBytes] = {0x00, 0x20, 0xA2, 0x00, 0xE8, 0x8E, 0x07, 0x20, 0xA9, 0x00,
+                                   0x9D, 0x00, 0x30, 0xD0, 0xF5, 0x4C, 0x0D, 0x20};
+
+    // When:
+    LoadProgram(program, noBytes);
+
+    // Then:
+    ExpectSameRuns({1, 13, 100, 2567, 10000});
+    EXPECT_EQ(computer.memory[0x3080], 0x80);
+}
+
+TEST_F(JitTests, StackInstructionsMatchInterpreter) {
+    // Given:
+    /*
+    * = $2000
+
+    loop:
+    pha
+    jsr sub
+    pla
+    adc #$07
+    php
+    plp
+    jmp loop
+    sub:
+    tsx
+    inx
+    rts
+     */
+    const dword noBytes = 18;
+    const byte program[noBytes] = {0x00, 0x20, 0x48, 0x20, 0x0C, 0x20, 0x68, 0x69, 0x07, 0x08,
+                                   0x28, 0x4C, 0x00, 0x20, 0xBA, 0xE8, 0x60, 0xEA};
+
+    // When:
+    LoadProgram(program, noBytes);
+
+    // Then:
+    ExpectSameRuns({1, 7, 100, 2567, 10000});
+}
@@ -130,3 +130,26 @@ TEST_F(JumpsAndSubroutinesTests, jsrAbs_rtsImp_CanJumpToNewLocationAndJumpBack)
     EXPECT_EQ(computer.cpu.SP, 0xFF);
     VerifyUnchangedFlags(cpuCopy);
 }
+
+// ================== //
+//       rtiImp       //
+// ================== //
+
+TEST_F(JumpsAndSubroutinesTests, rtiImp_RestoresStatusAndReturnAddress) {
+    // Given:
+    computer.cpu.SP = 0xFC;
+    computer.memory[0x01FD] = 0b11000011;
+    computer.memory[0x01FE] = 0x10;
+    computer.memory[0x01FF] = 0x30;
+    computer.memory[0x1000] = CPU::rtiImp;
+    const int EXPECTED_CYCLES = 6;
+
+    // When:
+    int cyclesExecuted = computer.run(EXPECTED_CYCLES);
+
+    // Then:
+    EXPECT_EQ(cyclesExecuted, EXPECTED_CYCLES);
+    EXPECT_EQ(computer.cpu.PC, 0x3010);
+    EXPECT_EQ(computer.cpu.SP, 0xFF);
+    EXPECT_EQ(computer.cpu.status & UNCHANGED_FLAGS, 0b11000011);
+}
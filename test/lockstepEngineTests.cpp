@@ -0,0 +1,251 @@
+#include <memory>
+#include <vector>
+#include "gtest/gtest.h"
+#include "../src/Computer.h"
+#include "../src/cpu/Opcodes.h"
+#include "../src/batch/LockstepEngine.h"
+
+class LockstepEngineTests : public ::testing::Test {
+public:
+    static const unsigned INSTANCES = 20; // More than LANES, so the last group is partly empty
+    std::vector<std::unique_ptr<Computer>> references;
+    std::vector<std::unique_ptr<Computer>> computers;
+    LockstepEngine engine;
+
+    void SetUp() override {
+        for (unsigned instance = 0; instance < INSTANCES; instance++) {
+            references.emplace_back(new Computer());
+            computers.emplace_back(new Computer());
+        }
+    }
+    void TearDown() override {}
+
+    std::vector<Computer*> Computers() const {
+        std::vector<Computer*> pointers;
+        for (const std::unique_ptr<Computer>& computer : computers) pointers.push_back(computer.get());
+        return pointers;
+    }
+
+    void ExpectSameState(unsigned instance) const {
+        const Computer& computer = *computers[instance];
+        const Computer& reference = *references[instance];
+        EXPECT_EQ(computer.cpu.PC, reference.cpu.PC);
+        EXPECT_EQ(computer.cpu.SP, reference.cpu.SP);
+        EXPECT_EQ(computer.cpu.A, reference.cpu.A);
+        EXPECT_EQ(computer.cpu.X, reference.cpu.X);
+        EXPECT_EQ(computer.cpu.Y, reference.cpu.Y);
+        EXPECT_EQ(computer.cpu.status, reference.cpu.status);
+        for (dword address = 0; address <= 0xFFFF; address++) {
+            if (computer.memory[address] != reference.memory[address]) {
+                ADD_FAILURE() << "Memory differs at 0x" << std::hex << address;
+                return;
+            }
+        }
+    }
+
+    /// @brief Runs every instance on the engine and alone on its cpu, expecting the same results.
+    void ExpectSameRuns(int cycles) {
+        const std::vector<CPU::Result> results = engine.execute(Computers(), cycles);
+        ASSERT_EQ(results.size(), (std::size_t) INSTANCES);
+        for (unsigned instance = 0; instance < INSTANCES; instance++) {
+            SCOPED_TRACE(::testing::Message() << "instance " << instance);
+            Computer& reference = *references[instance];
+            const CPU::Result expected = reference.cpu.execute(cycles, reference.memory);
+            EXPECT_EQ(results[instance].stop, expected.stop);
+            EXPECT_EQ(results[instance].cycles, expected.cycles);
+            EXPECT_EQ(results[instance].pc, expected.pc);
+            ExpectSameState(instance);
+        }
+    }
+};
+
+TEST_F(LockstepEngineTests, EveryOpcodeMatchesTheCpuOnDivergingInstances) {
+    for (int opcode = 0; opcode <= 0xFF; opcode++) {
+        const OpcodeInfo& info = opcodeTable[opcode];
+        if (!info.isLegal()) continue;
+        SCOPED_TRACE(info.mnemonic);
+        // Given: the opcode followed by a jump back to it, with different pseudo random memory and registers per instance
+        for (unsigned instance = 0; instance < INSTANCES; instance++) {
+            unsigned state = instance * 2654435761u + opcode;
+            for (Computer* target : {references[instance].get(), computers[instance].get()}) {
+                unsigned bytes = state;
+                for (dword address = 0; address < 0xFFFA; address++) {
+                    bytes = bytes * 1103515245u + 12345u;
+                    target->memory[address] = (byte) (bytes >> 16);
+                }
+                const word jump = 0x1000 + instructionLength(info.mode);
+                target->memory[0x1000] = opcode;
+                target->memory[jump] = CPU::jmpAbs;
+                target->memory.writeWord(0x1000, jump + 1);
+                target->cpu.PC = 0x1000;
+                target->cpu.SP = (byte) (bytes >> 24);
+                target->cpu.A = (byte) (bytes >> 8);
+                target->cpu.X = (byte) (bytes >> 4);
+                target->cpu.Y = (byte) (bytes >> 12);
+                target->cpu.status = (byte) (bytes >> 20) & CPU::STATUS_MASK;
+            }
+        }
+
+        // When / Then:
+        ExpectSameRuns(50);
+    }
+}
+
+TEST_F(LockstepEngineTests, DataDependentLoopsMatchTheCpu) {
+    // Given:
+    /*
+    * = $2000
+
+    ldx $80
+    loop:
+    inc $3000,X
+    dex
+    bne loop
+    lda $81
+    bmi negative
+    jsr sub
+    jmp done
+    negative:
+    adc $3000
+    done:
+    jmp *
+    sub:
+    sta $3100
+    rts
+     */
+    const dword noBytes = 32;
+    const byte program[noBytes] = {0x00, 0x20, 0xA6, 0x80, 0xFE, 0x00, 0x30, 0xCA, 0xD0, 0xFA,
+                                   0xA5, 0x81, 0x30, 0x06, 0x20, 0x18, 0x20, 0x4C, 0x15, 0x20,
+                                   0x6D, 0x00, 0x30, 0x4C, 0x15, 0x20, 0x8D, 0x00, 0x31, 0x60,
+                                   0xEA, 0xEA};
+    for (unsigned instance = 0; instance < INSTANCES; instance++) {
+        for (Computer* target : {references[instance].get(), computers[instance].get()}) {
+            target->loadProgram(program, noBytes);
+            target->resetPC();
+            target->memory[0x0080] = (byte) (instance * 3);
+            target->memory[0x0081] = (byte) (instance * 0x35);
+        }
+    }
+
+    // When / Then:
+    for (int cycles : {1, 10, 100, 1000}) {
+        ExpectSameRuns(cycles);
+    }
+}
+
+TEST_F(LockstepEngineTests, InstancesRunningTheSameCodeShareEveryStep) {
+    // Given:
+    /*
+    * = $2000
+
+    loop:
+    inc $80
+    inx
+    jmp loop
+     */
+    const dword noBytes = 8;
+    const byte program[noBytes] = {0x00, 0x20, 0xE6, 0x80, 0xE8, 0x4C, 0x00, 0x20};
+    for (unsigned instance = 0; instance < INSTANCES; instance++) {
+        computers[instance]->loadProgram(program, noBytes);
+        computers[instance]->resetPC();
+        computers[instance]->cpu.X = instance;
+    }
+
+    // When:
+    const std::vector<CPU::Result> results = engine.execute(Computers(), 100);
+
+    // Then:
+    for (unsigned instance = 0; instance < INSTANCES; instance++) {
+        const Memory& memory = computers[instance]->memory;
+        EXPECT_EQ(results[instance].cycles, 100);
+        EXPECT_EQ(memory[0x0080], 10);
+        EXPECT_EQ(computers[instance]->cpu.X, instance + 10);
+    }
+    if (LockstepEngine::isSupported()) {
+        EXPECT_EQ(engine.counters.laneSteps, 30 * INSTANCES);
+        EXPECT_EQ(engine.counters.steps, 30 * 2);
+    }
+}
+
+TEST_F(LockstepEngineTests, StoppingOpcodesOnlyStopTheirLane) {
+    // Given:
+    for (unsigned instance = 0; instance < 3; instance++) {
+        computers[instance]->memory[0x1000] = CPU::inxImp;
+        computers[instance]->memory[0x1001] = instance == 0 ? CPU::nop : instance == 1 ? 0x02 : 0x00;
+        computers[instance]->memory[0x1002] = CPU::jmpAbs;
+        computers[instance]->memory.writeWord(0x1000, 0x1003);
+        computers[instance]->cpu.PC = 0x1000;
+    }
+
+    // When:
+    const std::vector<CPU::Result> results =
+            engine.execute({computers[0].get(), computers[1].get(), computers[2].get()}, 20);
+
+    // Then:
+    EXPECT_EQ(results[0].stop, CPU::Stop::Budget);
+    EXPECT_EQ(results[0].cycles, 21);
+    EXPECT_EQ(results[1].stop, CPU::Stop::Halt);
+    EXPECT_EQ(results[2].stop, CPU::Stop::Breakpoint);
+    for (unsigned instance = 1; instance < 3; instance++) {
+        EXPECT_EQ(results[instance].cycles, 2);
+        EXPECT_EQ(results[instance].pc, 0x1001);
+        EXPECT_EQ(computers[instance]->cpu.PC, 0x1002);
+        EXPECT_EQ(computers[instance]->cpu.X, 1);
+    }
+}
+
+/// @brief Device reading as zero and ignoring what is written to it.
+class EmptyDevice : public Device {
+public:
+    byte read(word) override { return 0; }
+    void write(word, byte) override {}
+};
+
+TEST_F(LockstepEngineTests, ComputersThatCantBeLanesRunOnTheirCpu) {
+    // Given: the same loop everywhere, on a computer with a device and one charging static cycles too
+    const dword noBytes = 8;
+    const byte program[noBytes] = {0x00, 0x20, 0xE6, 0x80, 0xE8, 0x4C, 0x00, 0x20};
+    EmptyDevice device;
+    for (unsigned instance = 0; instance < 4; instance++) {
+        computers[instance]->loadProgram(program, noBytes);
+        computers[instance]->resetPC();
+    }
+    computers[1]->memory.map(0xD0, device);
+    computers[2]->cpu.staticCycles = true;
+
+    // When:
+    const std::vector<CPU::Result> results = engine.execute({computers[0].get(), computers[1].get(),
+                                                             computers[2].get(), computers[3].get()}, 100);
+
+    // Then:
+    for (unsigned instance = 0; instance < 4; instance++) {
+        const Memory& memory = computers[instance]->memory;
+        EXPECT_EQ(results[instance].cycles, 100);
+        EXPECT_EQ(memory[0x0080], 10);
+    }
+    if (LockstepEngine::isSupported()) {
+        EXPECT_EQ(engine.counters.laneSteps, 30 * 2);
+    }
+}
+
+TEST_F(LockstepEngineTests, OnlyTheWrittenPagesAreCopiedBack) {
+    // Given: computers sharing the image of the program
+    const dword noBytes = 8;
+    const byte program[noBytes] = {0x00, 0x20, 0xE6, 0x80, 0xE8, 0x4C, 0x00, 0x20};
+    computers[0]->loadProgram(program, noBytes);
+    const std::shared_ptr<const Memory::Image> image = computers[0]->memory.snapshot();
+    for (unsigned instance = 0; instance < INSTANCES; instance++) {
+        computers[instance]->memory.load(image);
+        computers[instance]->resetPC();
+    }
+
+    // When:
+    engine.execute(Computers(), 100);
+
+    // Then: only the zero page was copied
+    for (unsigned instance = 0; instance < INSTANCES; instance++) {
+        const Memory& memory = computers[instance]->memory;
+        EXPECT_EQ(memory[0x0080], 10);
+        EXPECT_EQ(memory.privatePageCount(), 1);
+    }
+}
@@ -0,0 +1,301 @@
+#include <memory>
+#include <vector>
+#include "gtest/gtest.h"
+#include "../src/Computer.h"
+#include "../src/memory/Memory.h"
+
+class MemoryTests : public ::testing::Test {
+public:
+    /*
+    * = $2000
+
+    loop:
+    inc $80
+    inx
+    jmp loop
+     */
+    static const dword noBytes = 8;
+    const byte program[noBytes] = {0x00, 0x20, 0xE6, 0x80, 0xE8, 0x4C, 0x00, 0x20};
+
+    /// @brief Image of a computer with the program loaded.
+    std::shared_ptr<const Memory::Image> ProgramImage() const {
+        std::unique_ptr<Computer> computer(new Computer());
+        computer->loadProgram(program, noBytes);
+        return computer->memory.snapshot();
+    }
+};
+
+TEST_F(MemoryTests, NewMemoryIsZeroAndOwnsNoPages) {
+    // Given:
+    const Memory memory;
+
+    // Then:
+    for (dword address = 0; address <= 0xFFFF; address++) {
+        ASSERT_EQ(memory[(word) address], 0) << address;
+    }
+    EXPECT_EQ(memory.privatePageCount(), 0);
+}
+
+TEST_F(MemoryTests, ImagesOnlyStoreNonZeroPages) {
+    // When:
+    const std::shared_ptr<const Memory::Image> image = ProgramImage();
+
+    // Then: the code page and the page of the vectors
+    EXPECT_EQ(image->storedPages(), 2);
+}
+
+TEST_F(MemoryTests, WritesOnlyCopyTheirPage) {
+    // Given:
+    const std::shared_ptr<const Memory::Image> image = ProgramImage();
+    Memory first(image);
+    Memory second(image);
+
+    // When:
+    first[0x2000] = 0xEA;
+    first[0x3000] = 0x42;
+
+    // Then:
+    const Memory& readFirst = first;
+    const Memory& readSecond = second;
+    EXPECT_EQ(readFirst[0x2000], 0xEA);
+    EXPECT_EQ(readFirst[0x2001], 0x80);
+    EXPECT_EQ(readFirst[0x3000], 0x42);
+    EXPECT_EQ(readFirst.readWord(0xFFFC), 0x2000);
+    EXPECT_EQ(first.privatePageCount(), 2);
+    EXPECT_EQ(readSecond[0x2000], 0xE6);
+    EXPECT_EQ(readSecond[0x3000], 0x00);
+    EXPECT_EQ(second.privatePageCount(), 0);
+}
+
+TEST_F(MemoryTests, ReadingThroughTheWritableReferenceLeavesThePageShared) {
+    // Given:
+    Memory memory(ProgramImage());
+    memory.markPageClean(0x20);
+
+    // When:
+    const byte opcode = memory[0x2000];
+
+    // Then:
+    EXPECT_EQ(opcode, 0xE6);
+    EXPECT_EQ(memory[0x2001], 0x80);
+    EXPECT_EQ(memory.privatePageCount(), 0);
+    EXPECT_FALSE(memory.isPageDirty(0x20));
+
+    // When:
+    memory[0x2001] = memory[0x2000];
+
+    // Then:
+    EXPECT_EQ(memory[0x2001], 0xE6);
+    EXPECT_EQ(memory.privatePageCount(), 1);
+    EXPECT_TRUE(memory.isPageDirty(0x20));
+}
+
+TEST_F(MemoryTests, WordsCanSpanTwoPages) {
+    // Given:
+    Memory memory;
+
+    // When:
+    memory.writeWord(0xBEEF, 0x12FF);
+
+    // Then:
+    const Memory& read = memory;
+    EXPECT_EQ(read[0x12FF], 0xEF);
+    EXPECT_EQ(read[0x1300], 0xBE);
+    EXPECT_EQ(read.readWord(0x12FF), 0xBEEF);
+    EXPECT_EQ(memory.privatePageCount(), 2);
+}
+
+TEST_F(MemoryTests, ClearKeepsOnlyTheVectors) {
+    // Given:
+    Memory memory(ProgramImage());
+    memory[0xFFF0] = 0x11;
+    memory[0x0080] = 0x22;
+
+    // When:
+    memory.clear();
+
+    // Then:
+    const Memory& read = memory;
+    EXPECT_EQ(read[0xFFF0], 0x00);
+    EXPECT_EQ(read[0x0080], 0x00);
+    EXPECT_EQ(read[0x2000], 0x00);
+    EXPECT_EQ(read.readWord(0xFFFC), 0x2000);
+    EXPECT_TRUE(read.isPageDirty(0x20));
+}
+
+TEST_F(MemoryTests, CopiesDontShareWrittenPages) {
+    // Given:
+    Memory memory(ProgramImage());
+    memory[0x0080] = 0x22;
+
+    // When:
+    Memory copy(memory);
+    copy[0x0080] = 0x33;
+
+    // Then:
+    const Memory& read = memory;
+    const Memory& readCopy = copy;
+    EXPECT_EQ(read[0x0080], 0x22);
+    EXPECT_EQ(readCopy[0x0080], 0x33);
+    EXPECT_EQ(readCopy[0x2000], 0xE6);
+}
+
+TEST_F(MemoryTests, ComputersSharingAnImageRunIndependently) {
+    // Given:
+    const std::shared_ptr<const Memory::Image> image = ProgramImage();
+    std::vector<std::unique_ptr<Computer>> computers;
+    for (int instance = 0; instance < 8; instance++) {
+        computers.emplace_back(new Computer());
+        computers.back()->memory.load(image);
+        computers.back()->resetPC();
+    }
+
+    // When:
+    for (int instance = 0; instance < 8; instance++) {
+        computers[instance]->run(10 * (instance + 1));
+    }
+
+    // Then: only the zero page was copied
+    for (int instance = 0; instance < 8; instance++) {
+        const Memory& memory = computers[instance]->memory;
+        EXPECT_EQ(memory[0x0080], instance + 1);
+        EXPECT_EQ(memory.privatePageCount(), 1);
+    }
+}
+
+TEST_F(MemoryTests, ResetOnlyRestoresTheWrittenPages) {
+    // Given:
+    Memory memory(ProgramImage());
+    for (dword page = 0; page < 256; page++) memory.markPageClean(page);
+    memory[0x0080] = 0x22;
+    memory[0x2000] = 0xEA;
+    memory.markPageClean(0x00);
+    memory.markPageClean(0x20);
+
+    // When:
+    memory.reset();
+
+    // Then:
+    const Memory& read = memory;
+    EXPECT_EQ(read[0x0080], 0x00);
+    EXPECT_EQ(read[0x2000], 0xE6);
+    EXPECT_EQ(read.readWord(0xFFFC), 0x2000);
+    EXPECT_EQ(memory.privatePageCount(), 0);
+    EXPECT_TRUE(read.isPageDirty(0x00));
+    EXPECT_TRUE(read.isPageDirty(0x20));
+    EXPECT_FALSE(read.isPageDirty(0x30));
+    EXPECT_FALSE(read.isPageDirty(0xFF));
+}
+
+TEST_F(MemoryTests, ResetRestoresTheSavedBaseline) {
+    // Given:
+    Memory memory;
+    memory[0x0080] = 0x11;
+    memory.saveBaseline();
+    memory[0x0080] = 0x22;
+    memory[0x4000] = 0x33;
+
+    // When:
+    memory.reset();
+
+    // Then:
+    const Memory& read = memory;
+    EXPECT_EQ(read[0x0080], 0x11);
+    EXPECT_EQ(read[0x4000], 0x00);
+    EXPECT_EQ(memory.privatePageCount(), 0);
+}
+
+TEST_F(MemoryTests, ClearOnlyTouchesTheWrittenPages) {
+    // Given:
+    Computer computer;
+    computer.loadProgram(program, noBytes);
+    for (dword page = 0; page < 256; page++) computer.memory.markPageClean(page);
+
+    // When:
+    computer.reset();
+
+    // Then:
+    const Memory& read = computer.memory;
+    EXPECT_EQ(read[0x2000], 0x00);
+    EXPECT_EQ(read.readWord(0xFFFC), 0x2000);
+    EXPECT_TRUE(read.isPageDirty(0x20));
+    EXPECT_FALSE(read.isPageDirty(0x30));
+    EXPECT_EQ(computer.memory.privatePageCount(), 1);
+}
+
+/// @brief Device counting up on every read and logging what is written to it.
+class CounterDevice : public Device {
+public:
+    byte next = 0;
+    std::vector<std::pair<word, byte>> writes;
+
+    byte read(word) override { return next++; }
+    void write(word address, byte value) override { writes.emplace_back(address, value); }
+};
+
+TEST_F(MemoryTests, MappedPagesGoToTheirDevice) {
+    // Given:
+    Memory memory;
+    CounterDevice device;
+    memory[0xD010] = 0x99;
+    memory.map(0xD0, device);
+
+    // When:
+    const Memory& read = memory;
+    const byte first = read[0xD000];
+    const byte second = read[0xD0FF];
+    memory.write(0xD010, 0x42);
+    memory.write(0xD100, 0x43);
+
+    // Then:
+    EXPECT_EQ(first, 0);
+    EXPECT_EQ(second, 1);
+    ASSERT_EQ(device.writes.size(), 1);
+    EXPECT_EQ(device.writes[0].first, 0xD010);
+    EXPECT_EQ(device.writes[0].second, 0x42);
+    EXPECT_EQ(read[0xD100], 0x43);
+
+    // When: the RAM under the device was left alone
+    memory.unmap(0xD0);
+
+    // Then:
+    EXPECT_EQ(read[0xD010], 0x99);
+}
+
+TEST_F(MemoryTests, EveryEngineGoesThroughDevices) {
+    /*
+    * = $2000
+
+    loop:
+    lda $D000
+    sta $D001
+    sta $0200,X
+    inx
+    jmp loop
+     */
+    const dword deviceBytes = 15;
+    const byte deviceProgram[deviceBytes] = {0x00, 0x20, 0xAD, 0x00, 0xD0, 0x8D, 0x01, 0xD0, 0x9D, 0x00, 0x02,
+                                             0xE8, 0x4C, 0x00, 0x20};
+    for (Computer::Engine engine : {Computer::Engine::Interpreter, Computer::Engine::Decoded, Computer::Engine::Blocks,
+                                    Computer::Engine::Jit, Computer::Engine::Tiered}) {
+        SCOPED_TRACE((int) engine);
+        // Given:
+        std::unique_ptr<Computer> computer(new Computer());
+        CounterDevice device;
+        computer->engine = engine;
+        computer->loadProgram(deviceProgram, deviceBytes);
+        computer->resetPC();
+        computer->memory.map(0xD0, device);
+
+        // When: enough loops for the hot code paths of every engine
+        computer->run(18 * 200);
+
+        // Then:
+        ASSERT_EQ(device.writes.size(), 200);
+        for (int loop = 0; loop < 200; loop++) {
+            EXPECT_EQ(device.writes[loop].first, 0xD001);
+            EXPECT_EQ(device.writes[loop].second, (byte) loop);
+            EXPECT_EQ(static_cast<const Memory&>(computer->memory)[0x0200 + loop], (byte) loop);
+        }
+    }
+}
@@ -0,0 +1,147 @@
+#include "gtest/gtest.h"
+#include "../src/Computer.h"
+#include "../src/cpu/Opcodes.h"
+#include "../src/cpu/Disassembler.h"
+
+class OpcodeTableTests : public ::testing::Test {
+public:
+    Computer computer;
+
+    void SetUp() override { computer.reset(); }
+    void TearDown() override {}
+
+    int RunOpcode(byte opcode, byte status) {
+        computer.reset();
+        computer.memory[0x1000] = opcode;
+        computer.cpu.status = status;
+        return computer.run(1);
+    }
+};
+
+// ================== //
+//       Cycles       //
+// ================== //
+
+TEST_F(OpcodeTableTests, LegalOpcodesTakeTheBaseCycles) {
+    for (int opcode = 0; opcode <= 0xFF; opcode++) {
+        const OpcodeInfo& info = opcodeTable[opcode];
+        if (!info.isLegal()) continue;
+        SCOPED_TRACE(info.mnemonic);
+        if (info.mode == AddressingMode::Relative) {
+            // Exactly one of the two status values takes the branch
+            int clear = RunOpcode(opcode, 0x00), set = RunOpcode(opcode, CPU::STATUS_MASK);
+            EXPECT_EQ(std::min(clear, set), info.cycles);
+            EXPECT_EQ(std::max(clear, set), info.cycles + 1);
+        } else {
+            EXPECT_EQ(RunOpcode(opcode, 0x00), info.cycles);
+        }
+    }
+}
+
+TEST_F(OpcodeTableTests, IndexedOpcodesTakeThePageCrossCycles) {
+    for (int opcode = 0; opcode <= 0xFF; opcode++) {
+        const OpcodeInfo& info = opcodeTable[opcode];
+        if (info.mode != AddressingMode::AbsoluteX && info.mode != AddressingMode::AbsoluteY
+            && info.mode != AddressingMode::IndirectY) continue;
+        SCOPED_TRACE(info.mnemonic);
+        computer.reset();
+        computer.memory[0x1000] = opcode;
+        computer.memory[0x1001] = 0x80;
+        computer.memory[0x1002] = 0x30;
+        computer.memory[0x0080] = 0x80;
+        computer.memory[0x0081] = 0x30;
+        computer.cpu.X = computer.cpu.Y = 0xFF;
+        EXPECT_EQ(computer.run(1), info.cycles + info.pageCrossCycles);
+    }
+}
+
+TEST_F(OpcodeTableTests, IllegalOpcodesAreNotExecuted) {
+    for (int opcode = 0; opcode <= 0xFF; opcode++) {
+        if (opcodeTable[opcode].isLegal()) continue;
+        SCOPED_TRACE(opcode);
+        computer.reset();
+        computer.memory[0x1000] = opcode;
+        const CPU::Result result = computer.execute(1);
+        EXPECT_NE(result.stop, CPU::Stop::Budget);
+        EXPECT_EQ(result.cycles, 0);
+        EXPECT_EQ(result.pc, 0x1000);
+    }
+}
+
+TEST_F(OpcodeTableTests, IllegalOpcodesStopWithTheirReason) {
+    const std::pair<byte, CPU::Stop> stops[] = {{0x00, CPU::Stop::Breakpoint}, {0x02, CPU::Stop::Halt},
+                                                {0x92, CPU::Stop::Halt}, {0x03, CPU::Stop::IllegalOpcode},
+                                                {0x82, CPU::Stop::IllegalOpcode}};
+    for (const auto& stop : stops) {
+        SCOPED_TRACE((int) stop.first);
+        // Given: two NOPs before it
+        computer.reset();
+        computer.memory[0x1000] = CPU::nop;
+        computer.memory[0x1001] = CPU::nop;
+        computer.memory[0x1002] = stop.first;
+
+        // When:
+        const CPU::Result result = computer.execute(100);
+
+        // Then:
+        EXPECT_EQ(result.stop, stop.second);
+        EXPECT_EQ(result.cycles, 4);
+        EXPECT_EQ(result.pc, 0x1002);
+    }
+}
+
+// ================== //
+//       Flags        //
+// ================== //
+
+TEST_F(OpcodeTableTests, OnlyWrittenFlagsChange) {
+    for (int opcode = 0; opcode <= 0xFF; opcode++) {
+        const OpcodeInfo& info = opcodeTable[opcode];
+        if (!info.isLegal()) continue;
+        SCOPED_TRACE(info.mnemonic);
+        for (byte status : {(byte) 0x00, CPU::STATUS_MASK}) {
+            for (byte value : {0x00, 0x7F, 0x80, 0xFF}) {
+                computer.reset();
+                computer.memory[0x1000] = opcode;
+                computer.memory[0x1001] = value;
+                computer.memory[0x01FF] = ~value;
+                computer.cpu.A = computer.cpu.X = computer.cpu.Y = value;
+                computer.cpu.status = status;
+                computer.run(1);
+                EXPECT_EQ((computer.cpu.status ^ status) & ~info.flagsWritten, 0);
+            }
+        }
+    }
+}
+
+// ================== //
+//    Disassembler    //
+// ================== //
+
+TEST_F(OpcodeTableTests, DisassemblesEveryAddressingMode) {
+    // Given:
+    const dword noBytes = 22;
+    const byte program[noBytes] = {0x00, 0x20,
+                                   0xA9, 0x10,       // lda #$10
+                                   0xB5, 0x80,       // lda $80,X
+                                   0xBE, 0x34, 0x12, // ldx $1234,Y
+                                   0x6C, 0xFC, 0xFF, // jmp ($FFFC)
+                                   0x91, 0x80,       // sta ($80),Y
+                                   0xD0, 0xFE,       // bne *
+                                   0xAA,             // tax
+                                   0x02,             // ???
+                                   0x20, 0x00, 0x20, // jsr $2000
+                                   0x60};            // rts
+
+    // When:
+    computer.loadProgram(program, noBytes);
+    std::vector<std::string> lines;
+    for (word address = 0x2000; address < 0x2000 + noBytes - 2; address = nextInstructionAddress(computer.memory, address)) {
+        lines.push_back(disassemble(computer.memory, address));
+    }
+
+    // Then:
+    const std::vector<std::string> expected = {"LDA #$10", "LDA $80,X", "LDX $1234,Y", "JMP ($FFFC)", "STA ($80),Y",
+                                               "BNE $200C", "TAX", "???", "JSR $2000", "RTS"};
+    EXPECT_EQ(lines, expected);
+}
@@ -0,0 +1,157 @@
+#include <memory>
+#include <vector>
+#include "gtest/gtest.h"
+#include "../src/Computer.h"
+#include "../src/cpu/Profiler.h"
+
+class ProfilerTests : public ::testing::Test {
+public:
+    /*
+    * = $2000
+
+    jsr outer
+    done:
+    jmp done
+    outer:
+    jsr inner
+    rts
+    inner:
+    ldx #$03
+    loop:
+    dex
+    bne loop
+    rts
+     */
+    static const dword noBytes = 18;
+    const byte program[noBytes] = {0x00, 0x20, 0x20, 0x06, 0x20, 0x4C, 0x03, 0x20, 0x20, 0x0A, 0x20, 0x60,
+                                   0xA2, 0x03, 0xCA, 0xD0, 0xFD, 0x60};
+};
+
+TEST_F(ProfilerTests, NestedCallsSplitTheirCycles) {
+    // Given:
+    Profiler profiler;
+
+    // When:
+    profiler.call(0x2100, 0xFF, 10);
+    profiler.call(0x2200, 0xFD, 30);
+    profiler.ret(0xFD, 50);
+    profiler.ret(0xFF, 60);
+
+    // Then:
+    const std::map<word, Profiler::Routine> routines = profiler.routines(100);
+    ASSERT_EQ(routines.size(), 2);
+    EXPECT_EQ(routines.at(0x2100).calls, 1);
+    EXPECT_EQ(routines.at(0x2100).inclusive, 50);
+    EXPECT_EQ(routines.at(0x2100).exclusive, 30);
+    EXPECT_EQ(routines.at(0x2200).calls, 1);
+    EXPECT_EQ(routines.at(0x2200).inclusive, 20);
+    EXPECT_EQ(routines.at(0x2200).exclusive, 20);
+    EXPECT_EQ(profiler.folded(100), "main 50\nmain;$2100 30\nmain;$2100;$2200 20\n");
+}
+
+TEST_F(ProfilerTests, RecursiveCallsCountOnceInclusive) {
+    // Given:
+    Profiler profiler;
+
+    // When:
+    profiler.call(0x2100, 0xFF, 0);
+    profiler.call(0x2100, 0xFD, 10);
+    profiler.ret(0xFD, 20);
+    profiler.ret(0xFF, 30);
+
+    // Then:
+    const Profiler::Routine routine = profiler.routines(30).at(0x2100);
+    EXPECT_EQ(routine.calls, 2);
+    EXPECT_EQ(routine.inclusive, 30);
+    EXPECT_EQ(routine.exclusive, 30);
+    EXPECT_EQ(profiler.folded(30), "main;$2100 20\nmain;$2100;$2100 10\n");
+}
+
+TEST_F(ProfilerTests, FramesEndWithTheirReturnAddress) {
+    // Given:
+    Profiler profiler;
+    profiler.call(0x2100, 0xFF, 0);
+    profiler.call(0x2200, 0xFD, 10);
+
+    // When: an rts to an address the routine pushed itself
+    profiler.ret(0xFB, 15);
+
+    // Then:
+    EXPECT_EQ(profiler.stack(), std::vector<word>({0x2100, 0x2200}));
+
+    // When: an rts past the inner return address (dropped with pla pla)
+    profiler.ret(0xFF, 20);
+
+    // Then:
+    EXPECT_TRUE(profiler.stack().empty());
+    EXPECT_EQ(profiler.routines(20).at(0x2200).inclusive, 10);
+    EXPECT_EQ(profiler.routines(20).at(0x2100).inclusive, 20);
+}
+
+TEST_F(ProfilerTests, OpenFramesCountUpToTheClock) {
+    // Given:
+    Profiler profiler;
+
+    // When:
+    profiler.call(0x2100, 0xFF, 10);
+
+    // Then:
+    EXPECT_EQ(profiler.stack(), std::vector<word>({0x2100}));
+    EXPECT_EQ(profiler.routines(40).at(0x2100).inclusive, 30);
+    EXPECT_EQ(profiler.routines(40).at(0x2100).exclusive, 30);
+    EXPECT_EQ(profiler.folded(40), "main 10\nmain;$2100 30\n");
+}
+
+#if CPU6502_STATS
+TEST_F(ProfilerTests, EveryEngineProfilesTheSame) {
+    for (Computer::Engine engine : {Computer::Engine::Interpreter, Computer::Engine::Decoded, Computer::Engine::Blocks,
+                                    Computer::Engine::Jit, Computer::Engine::Tiered}) {
+        SCOPED_TRACE((int) engine);
+        // Given:
+        std::unique_ptr<Computer> computer(new Computer());
+        computer->engine = engine;
+        computer->loadProgram(program, noBytes);
+        computer->resetPC();
+
+        // When: up to the first jmp
+        const int ran = computer->run(6 + 6 + (2 + 3 * 2 + 3 + 3 + 2 + 6) + 6 + 3);
+
+        // Then:
+        const CPU& cpu = computer->cpu;
+        EXPECT_EQ(cpu.stats.cycles, ran);
+        const std::map<word, Profiler::Routine> routines = cpu.profiler.routines(cpu.stats.cycles);
+        EXPECT_EQ(routines.at(0x2006).inclusive, 6 + 22 + 6);
+        EXPECT_EQ(routines.at(0x2006).exclusive, 6 + 6);
+        EXPECT_EQ(routines.at(0x200A).inclusive, 22);
+        EXPECT_EQ(cpu.profiler.folded(cpu.stats.cycles), "main 9\nmain;$2006 12\nmain;$2006;$200A 22\n");
+    }
+}
+
+TEST_F(ProfilerTests, InterruptsAreFramesOfTheirHandler) {
+    /*
+    * = $2000
+
+    loop:
+    jmp loop
+    handler:
+    rti
+     */
+    const dword interruptBytes = 6;
+    const byte interruptProgram[interruptBytes] = {0x00, 0x20, 0x4C, 0x00, 0x20, 0x40};
+    // Given:
+    std::unique_ptr<Computer> computer(new Computer());
+    computer->loadProgram(interruptProgram, interruptBytes);
+    computer->memory.writeWord(0x2003, CPU::NMI_ADRESS);
+    computer->resetPC();
+    computer->nmi();
+
+    // When:
+    const int ran = computer->run(CPU::INTERRUPT_CYCLES + 6 + 3);
+
+    // Then:
+    const CPU& cpu = computer->cpu;
+    EXPECT_EQ(cpu.stats.cycles, ran);
+    EXPECT_TRUE(cpu.profiler.stack().empty());
+    EXPECT_EQ(cpu.profiler.routines(cpu.stats.cycles).at(0x2003).inclusive, 6);
+}
+#endif
@@ -0,0 +1,270 @@
+// Generated by cpu6502-aot from 282 bytes at $2000, do not edit.
+#include "../src/aot/AotRuntime.h"
+
+namespace {
+
+void block2000(CPU& cpu, int& cycles, Memory& memory) {
+    const Memory& rom = memory;
+    cycles -= 2; cpu.X = 0x04; aotAssign(cpu, cpu.X); // $2000: LDX #$04
+    cycles -= 6; memory.write(rom.readWord((byte) (0x20 + cpu.X)), cpu.A); // $2002: STA ($20,X)
+    cycles -= 6; cpu.A = rom[rom.readWord((byte) (0x20 + cpu.X))]; aotAssign(cpu, cpu.A); // $2004: LDA ($20,X)
+    cycles -= 6; cpu.A = accumulate(Operation::And, cpu.A, rom[rom.readWord((byte) (0x20 + cpu.X))], cpu.status); aotAssign(cpu, cpu.A); // $2006: AND ($20,X)
+    cycles -= 6; cpu.A = accumulate(Operation::Ora, cpu.A, rom[rom.readWord((byte) (0x20 + cpu.X))], cpu.status); aotAssign(cpu, cpu.A); // $2008: ORA ($20,X)
+    cycles -= 6; cpu.A = accumulate(Operation::Eor, cpu.A, rom[rom.readWord((byte) (0x20 + cpu.X))], cpu.status); aotAssign(cpu, cpu.A); // $200A: EOR ($20,X)
+    cycles -= 6; cpu.A = accumulate(Operation::Adc, cpu.A, rom[rom.readWord((byte) (0x20 + cpu.X))], cpu.status); aotAssign(cpu, cpu.A); // $200C: ADC ($20,X)
+    cycles -= 2; cpu.Y = 0x10; aotAssign(cpu, cpu.Y); // $200E: LDY #$10
+    cycles -= 6; memory.write((word) (rom.readWord(0x22) + cpu.Y), cpu.A); // $2010: STA ($22),Y
+    cycles -= 5; cpu.A = rom[aotIndexed(rom.readWord(0x22), cpu.Y, cycles)]; aotAssign(cpu, cpu.A); // $2012: LDA ($22),Y
+    cycles -= 5; cpu.A = accumulate(Operation::And, cpu.A, rom[aotIndexed(rom.readWord(0x22), cpu.Y, cycles)], cpu.status); aotAssign(cpu, cpu.A); // $2014: AND ($22),Y
+    cycles -= 5; cpu.A = accumulate(Operation::Ora, cpu.A, rom[aotIndexed(rom.readWord(0x22), cpu.Y, cycles)], cpu.status); aotAssign(cpu, cpu.A); // $2016: ORA ($22),Y
+    cycles -= 5; cpu.A = accumulate(Operation::Eor, cpu.A, rom[aotIndexed(rom.readWord(0x22), cpu.Y, cycles)], cpu.status); aotAssign(cpu, cpu.A); // $2018: EOR ($22),Y
+    cycles -= 5; cpu.A = accumulate(Operation::Adc, cpu.A, rom[aotIndexed(rom.readWord(0x22), cpu.Y, cycles)], cpu.status); aotAssign(cpu, cpu.A); // $201A: ADC ($22),Y
+    cycles -= 2; cpu.X = 0xF0; aotAssign(cpu, cpu.X); // $201C: LDX #$F0
+    cycles -= 4; cpu.A = rom[aotIndexed(0x30F0, cpu.X, cycles)]; aotAssign(cpu, cpu.A); // $201E: LDA $30F0,X
+    cycles -= 4; cpu.Y = rom[aotIndexed(0x30F0, cpu.X, cycles)]; aotAssign(cpu, cpu.Y); // $2021: LDY $30F0,X
+    cycles -= 4; cpu.A = accumulate(Operation::And, cpu.A, rom[aotIndexed(0x30F0, cpu.X, cycles)], cpu.status); aotAssign(cpu, cpu.A); // $2024: AND $30F0,X
+    cycles -= 4; cpu.A = accumulate(Operation::Ora, cpu.A, rom[aotIndexed(0x30F0, cpu.X, cycles)], cpu.status); aotAssign(cpu, cpu.A); // $2027: ORA $30F0,X
+    cycles -= 4; cpu.A = accumulate(Operation::Eor, cpu.A, rom[aotIndexed(0x30F0, cpu.X, cycles)], cpu.status); aotAssign(cpu, cpu.A); // $202A: EOR $30F0,X
+    cycles -= 4; cpu.A = accumulate(Operation::Adc, cpu.A, rom[aotIndexed(0x30F0, cpu.X, cycles)], cpu.status); aotAssign(cpu, cpu.A); // $202D: ADC $30F0,X
+    cycles -= 2; cpu.Y = 0xE0; aotAssign(cpu, cpu.Y); // $2030: LDY #$E0
+    cycles -= 4; cpu.A = rom[aotIndexed(0x30F0, cpu.Y, cycles)]; aotAssign(cpu, cpu.A); // $2032: LDA $30F0,Y
+    cycles -= 4; cpu.X = rom[aotIndexed(0x30F0, cpu.Y, cycles)]; aotAssign(cpu, cpu.X); // $2035: LDX $30F0,Y
+    cycles -= 4; cpu.A = accumulate(Operation::And, cpu.A, rom[aotIndexed(0x30F0, cpu.Y, cycles)], cpu.status); aotAssign(cpu, cpu.A); // $2038: AND $30F0,Y
+    cycles -= 4; cpu.A = accumulate(Operation::Ora, cpu.A, rom[aotIndexed(0x30F0, cpu.Y, cycles)], cpu.status); aotAssign(cpu, cpu.A); // $203B: ORA $30F0,Y
+    cycles -= 4; cpu.A = accumulate(Operation::Eor, cpu.A, rom[aotIndexed(0x30F0, cpu.Y, cycles)], cpu.status); aotAssign(cpu, cpu.A); // $203E: EOR $30F0,Y
+    cycles -= 4; cpu.A = accumulate(Operation::Adc, cpu.A, rom[aotIndexed(0x30F0, cpu.Y, cycles)], cpu.status); aotAssign(cpu, cpu.A); // $2041: ADC $30F0,Y
+    cycles -= 2; cpu.X = 0x05; aotAssign(cpu, cpu.X); // $2044: LDX #$05
+    cycles -= 2; cpu.Y = 0x06; aotAssign(cpu, cpu.Y); // $2046: LDY #$06
+    cycles -= 4; memory.write((byte) (0xF0 + cpu.X), cpu.A); // $2048: STA $F0,X
+    cycles -= 4; memory.write((byte) (0xF0 + cpu.X), cpu.Y); // $204A: STY $F0,X
+    cycles -= 4; memory.write((byte) (0xF0 + cpu.Y), cpu.X); // $204C: STX $F0,Y
+    cycles -= 4; cpu.A = rom[(byte) (0xF0 + cpu.X)]; aotAssign(cpu, cpu.A); // $204E: LDA $F0,X
+    cycles -= 4; cpu.Y = rom[(byte) (0xF0 + cpu.X)]; aotAssign(cpu, cpu.Y); // $2050: LDY $F0,X
+    cycles -= 4; cpu.X = rom[(byte) (0xF0 + cpu.Y)]; aotAssign(cpu, cpu.X); // $2052: LDX $F0,Y
+    cycles -= 2; cpu.X = 0x05; aotAssign(cpu, cpu.X); // $2054: LDX #$05
+    cycles -= 4; cpu.A = accumulate(Operation::And, cpu.A, rom[(byte) (0xF0 + cpu.X)], cpu.status); aotAssign(cpu, cpu.A); // $2056: AND $F0,X
+    cycles -= 4; cpu.A = accumulate(Operation::Ora, cpu.A, rom[(byte) (0xF0 + cpu.X)], cpu.status); aotAssign(cpu, cpu.A); // $2058: ORA $F0,X
+    cycles -= 4; cpu.A = accumulate(Operation::Eor, cpu.A, rom[(byte) (0xF0 + cpu.X)], cpu.status); aotAssign(cpu, cpu.A); // $205A: EOR $F0,X
+    cycles -= 4; cpu.A = accumulate(Operation::Adc, cpu.A, rom[(byte) (0xF0 + cpu.X)], cpu.status); aotAssign(cpu, cpu.A); // $205C: ADC $F0,X
+    cycles -= 6; { const word address = (byte) (0xF0 + cpu.X); const byte value = step(Operation::Inc, rom[address]); memory.write(address, value); aotAssign(cpu, value); } // $205E: INC $F0,X
+    cycles -= 6; { const word address = (byte) (0xF0 + cpu.X); const byte value = step(Operation::Dec, rom[address]); memory.write(address, value); aotAssign(cpu, value); } // $2060: DEC $F0,X
+    cycles -= 5; { const word address = 0xF2; const byte value = step(Operation::Inc, rom[address]); memory.write(address, value); aotAssign(cpu, value); } // $2062: INC $F2
+    cycles -= 5; { const word address = 0xF3; const byte value = step(Operation::Dec, rom[address]); memory.write(address, value); aotAssign(cpu, value); } // $2064: DEC $F3
+    cycles -= 6; { const word address = 0x3100; const byte value = step(Operation::Inc, rom[address]); memory.write(address, value); aotAssign(cpu, value); } // $2066: INC $3100
+    cycles -= 6; { const word address = 0x3101; const byte value = step(Operation::Dec, rom[address]); memory.write(address, value); aotAssign(cpu, value); } // $2069: DEC $3101
+    cycles -= 7; { const word address = (word) (0x3100 + cpu.X); const byte value = step(Operation::Inc, rom[address]); memory.write(address, value); aotAssign(cpu, value); } // $206C: INC $3100,X
+    cycles -= 7; { const word address = (word) (0x3100 + cpu.X); const byte value = step(Operation::Dec, rom[address]); memory.write(address, value); aotAssign(cpu, value); } // $206F: DEC $3100,X
+    cycles -= 4; memory.write(0x3000, cpu.A); // $2072: STA $3000
+    cycles -= 4; memory.write(0x3001, cpu.X); // $2075: STX $3001
+    cycles -= 4; memory.write(0x3002, cpu.Y); // $2078: STY $3002
+    cycles -= 5; memory.write((word) (0x3000 + cpu.X), cpu.A); // $207B: STA $3000,X
+    cycles -= 5; memory.write((word) (0x3000 + cpu.Y), cpu.A); // $207E: STA $3000,Y
+    cycles -= 4; cpu.A = rom[0x3000]; aotAssign(cpu, cpu.A); // $2081: LDA $3000
+    cycles -= 4; cpu.X = rom[0x3001]; aotAssign(cpu, cpu.X); // $2084: LDX $3001
+    cycles -= 4; cpu.Y = rom[0x3002]; aotAssign(cpu, cpu.Y); // $2087: LDY $3002
+    cycles -= 4; cpu.A = accumulate(Operation::And, cpu.A, rom[0x3000], cpu.status); aotAssign(cpu, cpu.A); // $208A: AND $3000
+    cycles -= 4; cpu.A = accumulate(Operation::Ora, cpu.A, rom[0x3000], cpu.status); aotAssign(cpu, cpu.A); // $208D: ORA $3000
+    cycles -= 4; cpu.A = accumulate(Operation::Eor, cpu.A, rom[0x3000], cpu.status); aotAssign(cpu, cpu.A); // $2090: EOR $3000
+    cycles -= 4; cpu.A = accumulate(Operation::Adc, cpu.A, rom[0x3000], cpu.status); aotAssign(cpu, cpu.A); // $2093: ADC $3000
+    cycles -= 4; bitTest(cpu.A, rom[0x3000], cpu.status); // $2096: BIT $3000
+    cycles -= 3; memory.write(0xF4, cpu.A); // $2099: STA $F4
+    cycles -= 3; memory.write(0xF5, cpu.X); // $209B: STX $F5
+    cycles -= 3; memory.write(0xF6, cpu.Y); // $209D: STY $F6
+    cycles -= 3; cpu.A = rom[0xF4]; aotAssign(cpu, cpu.A); // $209F: LDA $F4
+    cycles -= 3; cpu.X = rom[0xF5]; aotAssign(cpu, cpu.X); // $20A1: LDX $F5
+    cycles -= 3; cpu.Y = rom[0xF6]; aotAssign(cpu, cpu.Y); // $20A3: LDY $F6
+    cycles -= 3; cpu.A = accumulate(Operation::And, cpu.A, rom[0xF4], cpu.status); aotAssign(cpu, cpu.A); // $20A5: AND $F4
+    cycles -= 3; cpu.A = accumulate(Operation::Ora, cpu.A, rom[0xF4], cpu.status); aotAssign(cpu, cpu.A); // $20A7: ORA $F4
+    cycles -= 3; cpu.A = accumulate(Operation::Eor, cpu.A, rom[0xF4], cpu.status); aotAssign(cpu, cpu.A); // $20A9: EOR $F4
+    cycles -= 3; cpu.A = accumulate(Operation::Adc, cpu.A, rom[0xF4], cpu.status); aotAssign(cpu, cpu.A); // $20AB: ADC $F4
+    cycles -= 3; bitTest(cpu.A, rom[0xF4], cpu.status); // $20AD: BIT $F4
+    cycles -= 3; cpu.A = rom[0xF7]; aotAssign(cpu, cpu.A); // $20AF: LDA $F7
+    cycles -= 2; cpu.X = 0x12; aotAssign(cpu, cpu.X); // $20B1: LDX #$12
+    cycles -= 2; cpu.Y = 0x34; aotAssign(cpu, cpu.Y); // $20B3: LDY #$34
+    cycles -= 2; cpu.A = 0xC3; aotAssign(cpu, cpu.A); // $20B5: LDA #$C3
+    cycles -= 2; cpu.A = accumulate(Operation::And, cpu.A, 0xF0, cpu.status); aotAssign(cpu, cpu.A); // $20B7: AND #$F0
+    cycles -= 2; cpu.A = accumulate(Operation::Ora, cpu.A, 0x0F, cpu.status); aotAssign(cpu, cpu.A); // $20B9: ORA #$0F
+    cycles -= 2; cpu.A = accumulate(Operation::Eor, cpu.A, 0xAA, cpu.status); aotAssign(cpu, cpu.A); // $20BB: EOR #$AA
+    cycles -= 2; cpu.A = accumulate(Operation::Adc, cpu.A, 0x33, cpu.status); aotAssign(cpu, cpu.A); // $20BD: ADC #$33
+    cycles -= 2; cpu.X = cpu.A; aotAssign(cpu, cpu.X); // $20BF: TAX
+    cycles -= 2; cpu.Y = cpu.A; aotAssign(cpu, cpu.Y); // $20C0: TAY
+    cycles -= 2; cpu.A = cpu.X; aotAssign(cpu, cpu.A); // $20C1: TXA
+    cycles -= 2; cpu.A = cpu.Y; aotAssign(cpu, cpu.A); // $20C2: TYA
+    cycles -= 2; cpu.X = cpu.SP; aotAssign(cpu, cpu.X); // $20C3: TSX
+    cycles -= 2; cpu.SP = cpu.X; // $20C4: TXS
+    cycles -= 2; cpu.X = step(Operation::Inx, cpu.X); aotAssign(cpu, cpu.X); // $20C5: INX
+    cycles -= 2; cpu.Y = step(Operation::Iny, cpu.Y); aotAssign(cpu, cpu.Y); // $20C6: INY
+    cycles -= 2; cpu.X = step(Operation::Dex, cpu.X); aotAssign(cpu, cpu.X); // $20C7: DEX
+    cycles -= 2; cpu.Y = step(Operation::Dey, cpu.Y); aotAssign(cpu, cpu.Y); // $20C8: DEY
+    cycles -= 2; cpu.status = changeFlag(opcodeTable[0x18], cpu.status); // $20C9: CLC
+    cycles -= 2; cpu.status = changeFlag(opcodeTable[0x38], cpu.status); // $20CA: SEC
+    cycles -= 2; cpu.status = changeFlag(opcodeTable[0xD8], cpu.status); // $20CB: CLD
+    cycles -= 2; cpu.status = changeFlag(opcodeTable[0xF8], cpu.status); // $20CC: SED
+    cycles -= 2; cpu.status = changeFlag(opcodeTable[0x58], cpu.status); // $20CD: CLI
+    cycles -= 2; cpu.status = changeFlag(opcodeTable[0x78], cpu.status); // $20CE: SEI
+    cycles -= 2; cpu.status = changeFlag(opcodeTable[0xB8], cpu.status); // $20CF: CLV
+    cycles -= 2; // $20D0: NOP
+    cycles -= 6; aotPushWord(cpu, memory, 0x20D3); cpu.PC = 0x210E; return; // $20D1: JSR $210E
+}
+
+void block20D4(CPU& cpu, int& cycles, Memory& memory) {
+    const Memory& rom = memory;
+    cycles -= 3; aotPush(cpu, memory, cpu.A); // $20D4: PHA
+    cycles -= 3; aotPush(cpu, memory, pushedStatus(cpu.status)); // $20D5: PHP
+    cycles -= 4; cpu.A = aotPull(cpu, rom); // $20D6: PLA
+    cycles -= 4; cpu.status = pulledStatus(cpu.status, aotPull(cpu, rom)); // $20D7: PLP
+    cycles -= 2; if (branchTaken(Operation::Bcc, (cpu.status & 0x01) != 0)) { cycles -= 1; cpu.PC = 0x20DB; return; } cpu.PC = 0x20DA; return; // $20D8: BCC $20DB
+}
+
+void block20DA(CPU& cpu, int& cycles, Memory&) {
+    cycles -= 2; // $20DA: NOP
+    cpu.PC = 0x20DB;
+}
+
+void block20DB(CPU& cpu, int& cycles, Memory&) {
+    cycles -= 2; if (branchTaken(Operation::Bcs, (cpu.status & 0x01) != 0)) { cycles -= 1; cpu.PC = 0x20DE; return; } cpu.PC = 0x20DD; return; // $20DB: BCS $20DE
+}
+
+void block20DD(CPU& cpu, int& cycles, Memory&) {
+    cycles -= 2; // $20DD: NOP
+    cpu.PC = 0x20DE;
+}
+
+void block20DE(CPU& cpu, int& cycles, Memory&) {
+    cycles -= 2; if (branchTaken(Operation::Beq, (cpu.status & 0x02) != 0)) { cycles -= 1; cpu.PC = 0x20E1; return; } cpu.PC = 0x20E0; return; // $20DE: BEQ $20E1
+}
+
+void block20E0(CPU& cpu, int& cycles, Memory&) {
+    cycles -= 2; // $20E0: NOP
+    cpu.PC = 0x20E1;
+}
+
+void block20E1(CPU& cpu, int& cycles, Memory&) {
+    cycles -= 2; if (branchTaken(Operation::Bne, (cpu.status & 0x02) != 0)) { cycles -= 1; cpu.PC = 0x20E4; return; } cpu.PC = 0x20E3; return; // $20E1: BNE $20E4
+}
+
+void block20E3(CPU& cpu, int& cycles, Memory&) {
+    cycles -= 2; // $20E3: NOP
+    cpu.PC = 0x20E4;
+}
+
+void block20E4(CPU& cpu, int& cycles, Memory&) {
+    cycles -= 2; if (branchTaken(Operation::Bmi, (cpu.status & 0x80) != 0)) { cycles -= 1; cpu.PC = 0x20E7; return; } cpu.PC = 0x20E6; return; // $20E4: BMI $20E7
+}
+
+void block20E6(CPU& cpu, int& cycles, Memory&) {
+    cycles -= 2; // $20E6: NOP
+    cpu.PC = 0x20E7;
+}
+
+void block20E7(CPU& cpu, int& cycles, Memory&) {
+    cycles -= 2; if (branchTaken(Operation::Bpl, (cpu.status & 0x80) != 0)) { cycles -= 1; cpu.PC = 0x20EA; return; } cpu.PC = 0x20E9; return; // $20E7: BPL $20EA
+}
+
+void block20E9(CPU& cpu, int& cycles, Memory&) {
+    cycles -= 2; // $20E9: NOP
+    cpu.PC = 0x20EA;
+}
+
+void block20EA(CPU& cpu, int& cycles, Memory&) {
+    cycles -= 2; if (branchTaken(Operation::Bvc, (cpu.status & 0x40) != 0)) { cycles -= 1; cpu.PC = 0x20ED; return; } cpu.PC = 0x20EC; return; // $20EA: BVC $20ED
+}
+
+void block20EC(CPU& cpu, int& cycles, Memory&) {
+    cycles -= 2; // $20EC: NOP
+    cpu.PC = 0x20ED;
+}
+
+void block20ED(CPU& cpu, int& cycles, Memory&) {
+    cycles -= 2; if (branchTaken(Operation::Bvs, (cpu.status & 0x40) != 0)) { cycles -= 1; cpu.PC = 0x20F0; return; } cpu.PC = 0x20EF; return; // $20ED: BVS $20F0
+}
+
+void block20EF(CPU& cpu, int& cycles, Memory&) {
+    cycles -= 2; // $20EF: NOP
+    cpu.PC = 0x20F0;
+}
+
+void block20F0(CPU& cpu, int& cycles, Memory&) {
+    cycles -= 2; cpu.X = 0x08; aotAssign(cpu, cpu.X); // $20F0: LDX #$08
+    cycles -= 2; // $20F2: NOP
+    cycles -= 2; // $20F3: NOP
+    cycles -= 2; // $20F4: NOP
+    cycles -= 2; // $20F5: NOP
+    cycles -= 2; // $20F6: NOP
+    cycles -= 2; // $20F7: NOP
+    cycles -= 2; // $20F8: NOP
+    cycles -= 2; // $20F9: NOP
+    cycles -= 2; // $20FA: NOP
+    cycles -= 2; // $20FB: NOP
+    cycles -= 2; // $20FC: NOP
+    cpu.PC = 0x20FD;
+}
+
+void block20FD(CPU& cpu, int& cycles, Memory&) {
+entry:
+    cycles -= 2; cpu.X = step(Operation::Dex, cpu.X); aotAssign(cpu, cpu.X); // $20FD: DEX
+    cycles -= 2; if (branchTaken(Operation::Bne, (cpu.status & 0x02) != 0)) { cycles -= 2; if (cycles > 2) goto entry; cpu.PC = 0x20FD; return; } cpu.PC = 0x2100; return; // $20FE: BNE $20FD
+}
+
+void block2100(CPU& cpu, int& cycles, Memory& memory) {
+    const Memory& rom = memory;
+    cycles -= 5; { const word address = 0xF7; const byte value = step(Operation::Inc, rom[address]); memory.write(address, value); aotAssign(cpu, value); } // $2100: INC $F7
+    cycles -= 3; cpu.A = rom[0xF7]; aotAssign(cpu, cpu.A); // $2102: LDA $F7
+    cycles -= 2; cpu.A = accumulate(Operation::And, cpu.A, 0x03, cpu.status); aotAssign(cpu, cpu.A); // $2104: AND #$03
+    cycles -= 2; if (branchTaken(Operation::Beq, (cpu.status & 0x02) != 0)) { cycles -= 1; cpu.PC = 0x210B; return; } cpu.PC = 0x2108; return; // $2106: BEQ $210B
+}
+
+void block2108(CPU& cpu, int& cycles, Memory&) {
+    cycles -= 3; cpu.PC = 0x2000; return; // $2108: JMP $2000
+}
+
+void block210B(CPU& cpu, int& cycles, Memory& memory) {
+    const Memory& rom = memory;
+    cycles -= 5; cpu.PC = rom.readWord(0x2118); return; // $210B: JMP ($2118)
+}
+
+void block210E(CPU& cpu, int& cycles, Memory& memory) {
+    const Memory& rom = memory;
+    cycles -= 3; cpu.A = rom[0xF8]; aotAssign(cpu, cpu.A); // $210E: LDA $F8
+    cycles -= 2; cpu.A = accumulate(Operation::Adc, cpu.A, 0x01, cpu.status); aotAssign(cpu, cpu.A); // $2110: ADC #$01
+    cycles -= 6; cpu.PC = aotPullWord(cpu, rom) + 1; return; // $2112: RTS
+}
+
+}
+
+CPU::Result runRecompiledTestProgram(CPU& cpu, int cycles, Memory& memory) {
+    int remaining = cycles;
+    while (remaining > 0) {
+        switch (cpu.PC) {
+            case 0x2000: if (remaining > 374) { block2000(cpu, remaining, memory); continue; } break;
+            case 0x20D4: if (remaining > 14) { block20D4(cpu, remaining, memory); continue; } break;
+            case 0x20DA: if (remaining > 0) { block20DA(cpu, remaining, memory); continue; } break;
+            case 0x20DB: if (remaining > 0) { block20DB(cpu, remaining, memory); continue; } break;
+            case 0x20DD: if (remaining > 0) { block20DD(cpu, remaining, memory); continue; } break;
+            case 0x20DE: if (remaining > 0) { block20DE(cpu, remaining, memory); continue; } break;
+            case 0x20E0: if (remaining > 0) { block20E0(cpu, remaining, memory); continue; } break;
+            case 0x20E1: if (remaining > 0) { block20E1(cpu, remaining, memory); continue; } break;
+            case 0x20E3: if (remaining > 0) { block20E3(cpu, remaining, memory); continue; } break;
+            case 0x20E4: if (remaining > 0) { block20E4(cpu, remaining, memory); continue; } break;
+            case 0x20E6: if (remaining > 0) { block20E6(cpu, remaining, memory); continue; } break;
+            case 0x20E7: if (remaining > 0) { block20E7(cpu, remaining, memory); continue; } break;
+            case 0x20E9: if (remaining > 0) { block20E9(cpu, remaining, memory); continue; } break;
+            case 0x20EA: if (remaining > 0) { block20EA(cpu, remaining, memory); continue; } break;
+            case 0x20EC: if (remaining > 0) { block20EC(cpu, remaining, memory); continue; } break;
+            case 0x20ED: if (remaining > 0) { block20ED(cpu, remaining, memory); continue; } break;
+            case 0x20EF: if (remaining > 0) { block20EF(cpu, remaining, memory); continue; } break;
+            case 0x20F0: if (remaining > 22) { block20F0(cpu, remaining, memory); continue; } break;
+            case 0x20FD: if (remaining > 2) { block20FD(cpu, remaining, memory); continue; } break;
+            case 0x2100: if (remaining > 10) { block2100(cpu, remaining, memory); continue; } break;
+            case 0x2108: if (remaining > 0) { block2108(cpu, remaining, memory); continue; } break;
+            case 0x210B: if (remaining > 0) { block210B(cpu, remaining, memory); continue; } break;
+            case 0x210E: if (remaining > 5) { block210E(cpu, remaining, memory); continue; } break;
+            default: break;
+        }
+        // Not discovered ahead of time, or the block could outlast the budget
+        const CPU::Result step = cpu.execute(1, memory);
+        remaining -= step.cycles;
+        if (step.stop != CPU::Stop::Budget) return {step.stop, cycles - remaining, step.pc};
+    }
+    return {CPU::Stop::Budget, cycles - remaining, cpu.PC};
+}
@@ -0,0 +1,166 @@
+#include <memory>
+#include <vector>
+#include "gtest/gtest.h"
+#include "../src/Computer.h"
+#include "../src/state/RewindBuffer.h"
+
+class RewindBufferTests : public ::testing::Test {
+public:
+    /*
+    * = $2000
+
+    loop:
+    inc $80
+    ldy $80
+    sta $4000,Y
+    adc #$03
+    tax
+    inc $5000,X
+    jmp loop
+     */
+    static const dword noBytes = 19;
+    const byte program[noBytes] = {0x00, 0x20, 0xE6, 0x80, 0xA4, 0x80, 0x99, 0x00, 0x40, 0x69, 0x03,
+                                   0xAA, 0xFE, 0x00, 0x50, 0x4C, 0x00, 0x20, 0xEA};
+
+    std::unique_ptr<Computer> computer{new Computer()};
+
+    void SetUp() override {
+        computer->loadProgram(program, noBytes);
+        computer->resetPC();
+    }
+
+    /// @brief A new computer run straight to the cycle given.
+    std::unique_ptr<Computer> RunTo(int cycles) const {
+        std::unique_ptr<Computer> reference(new Computer());
+        reference->loadProgram(program, noBytes);
+        reference->resetPC();
+        reference->run(cycles);
+        return reference;
+    }
+
+    void ExpectSameState(const Computer& reference) const {
+        EXPECT_EQ(computer->cpu.PC, reference.cpu.PC);
+        EXPECT_EQ(computer->cpu.SP, reference.cpu.SP);
+        EXPECT_EQ(computer->cpu.A, reference.cpu.A);
+        EXPECT_EQ(computer->cpu.X, reference.cpu.X);
+        EXPECT_EQ(computer->cpu.Y, reference.cpu.Y);
+        EXPECT_EQ(computer->cpu.status, reference.cpu.status);
+        EXPECT_EQ(computer->saveState(), reference.saveState());
+    }
+};
+
+TEST_F(RewindBufferTests, SteppingBackReturnsToTheStateOfTheRun) {
+    // Given:
+    RewindBuffer rewind(*computer, 1000, 1 << 16);
+    rewind.run(20000);
+    ASSERT_GE(rewind.clock(), 20000);
+
+    // When / Then: within the newest interval, across several and back to the start
+    for (std::uint64_t target : {19500, 15321, 4000, 0}) {
+        SCOPED_TRACE(target);
+        ASSERT_TRUE(rewind.stepBack(rewind.clock() - target));
+        std::unique_ptr<Computer> reference = RunTo((int) target);
+        ExpectSameState(*reference);
+    }
+}
+
+TEST_F(RewindBufferTests, RunningAgainAfterSteppingBackRedoesTheSameRun) {
+    // Given:
+    RewindBuffer rewind(*computer, 700, 1 << 16);
+    rewind.run(10000);
+    ASSERT_TRUE(rewind.stepBack(6000));
+
+    // When:
+    rewind.run(6000);
+
+    // Then:
+    std::unique_ptr<Computer> reference = RunTo((int) rewind.clock());
+    ExpectSameState(*reference);
+}
+
+TEST_F(RewindBufferTests, DeltasOnlyHoldWhatChanged) {
+    // Given:
+    RewindBuffer rewind(*computer, 1000, 1 << 16);
+
+    // When:
+    rewind.run(10000);
+
+    // Then: a few bytes written per interval (checkpoints land on the instruction ending past it), far from 64 KiB each
+    EXPECT_GE(rewind.checkpoints(), 9);
+    EXPECT_LT(rewind.usedBytes(), 10 * 1000);
+}
+
+TEST_F(RewindBufferTests, OldestCheckpointsAreDroppedToFit) {
+    // Given:
+    RewindBuffer rewind(*computer, 100, 2000);
+
+    // When:
+    rewind.run(100000);
+
+    // Then:
+    EXPECT_LT(rewind.checkpoints(), 1000);
+    EXPECT_LE(rewind.usedBytes(), 2000);
+    EXPECT_FALSE(rewind.stepBack(90000));
+    ASSERT_TRUE(rewind.stepBack(150));
+    std::unique_ptr<Computer> reference = RunTo((int) rewind.clock());
+    ExpectSameState(*reference);
+}
+
+TEST_F(RewindBufferTests, SteppingBackReplaysTheScheduledEvents) {
+    // Given: an event writing to memory at cycle 50, which the run went past
+    auto writeAt50 = [](Computer& target) {
+        target.scheduler.schedule(50, [&target](std::uint64_t) { target.memory.write(0x0200, 0x42); });
+    };
+    writeAt50(*computer);
+    RewindBuffer rewind(*computer, 20, 1 << 16);
+    rewind.run(100);
+    const std::uint64_t end = rewind.clock();
+
+    // When: back before the event, then forward to where the run was
+    ASSERT_TRUE(rewind.stepBack(end - 23));
+    ASSERT_LT(computer->clock, 50);
+    EXPECT_EQ(computer->scheduler.size(), 1);
+    rewind.run((int) (end - rewind.clock()));
+
+    // Then: the event fired again, at the clock of the run
+    std::unique_ptr<Computer> reference(new Computer());
+    reference->loadProgram(program, noBytes);
+    reference->resetPC();
+    writeAt50(*reference);
+    reference->run((int) end);
+    EXPECT_EQ(rewind.clock(), end);
+    EXPECT_EQ(computer->clock, reference->clock);
+    EXPECT_EQ(static_cast<const Memory&>(computer->memory)[0x0200], 0x42);
+    EXPECT_EQ(computer->scheduler.size(), 0);
+    ExpectSameState(*reference);
+}
+
+TEST_F(RewindBufferTests, RunStopsAtUnimplementedOpcodes) {
+    // Given:
+    computer->memory[0x2000] = CPU::nop;
+    computer->memory[0x2001] = 0x02; // JAM
+    RewindBuffer rewind(*computer, 100, 1 << 16);
+
+    // When:
+    const int cyclesExecuted = rewind.run(1000);
+
+    // Then: PC is left past the JAM
+    EXPECT_EQ(cyclesExecuted, 2);
+    EXPECT_EQ(rewind.clock(), 2);
+    EXPECT_EQ(computer->cpu.PC, 0x2002);
+}
+
+TEST_F(RewindBufferTests, ExecuteTellsWhyItStopped) {
+    // Given:
+    computer->memory[0x2000] = CPU::nop;
+    computer->memory[0x2001] = 0x02; // JAM
+    RewindBuffer rewind(*computer, 100, 1 << 16);
+
+    // When:
+    const CPU::Result result = rewind.execute(1000);
+
+    // Then:
+    EXPECT_EQ(result.stop, CPU::Stop::Halt);
+    EXPECT_EQ(result.cycles, 2);
+    EXPECT_EQ(result.pc, 0x2001);
+}
@@ -0,0 +1,122 @@
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "../src/Computer.h"
+
+class SaveStateTests : public ::testing::Test {
+public:
+    /*
+    * = $2000
+
+    loop:
+    inc $80
+    ldy $80
+    sta $4000,Y
+    adc #$03
+    jmp loop
+     */
+    static const dword noBytes = 15;
+    const byte program[noBytes] = {0x00, 0x20, 0xE6, 0x80, 0xA4, 0x80, 0x99, 0x00, 0x40, 0x69, 0x03, 0x4C, 0x00, 0x20, 0xEA};
+
+    std::unique_ptr<Computer> original{new Computer()};
+    std::unique_ptr<Computer> restored{new Computer()};
+    std::string path;
+
+    void SetUp() override {
+        original->loadProgram(program, noBytes);
+        original->resetPC();
+        original->run(1000);
+        path = ::testing::TempDir() + "saveStateTests.state";
+    }
+    void TearDown() override { std::remove(path.c_str()); }
+
+    /// @brief Both computers run on and end up in the same state.
+    void ExpectSameRuns() {
+        EXPECT_EQ(restored->cpu.PC, original->cpu.PC);
+        EXPECT_EQ(restored->cpu.status, original->cpu.status);
+        EXPECT_EQ(restored->run(5000), original->run(5000));
+        EXPECT_EQ(restored->cpu.PC, original->cpu.PC);
+        EXPECT_EQ(restored->cpu.SP, original->cpu.SP);
+        EXPECT_EQ(restored->cpu.A, original->cpu.A);
+        EXPECT_EQ(restored->cpu.X, original->cpu.X);
+        EXPECT_EQ(restored->cpu.Y, original->cpu.Y);
+        EXPECT_EQ(restored->cpu.status, original->cpu.status);
+        EXPECT_EQ(restored->saveState(), original->saveState());
+    }
+};
+
+TEST_F(SaveStateTests, StatesOnlyHoldTheNonZeroPages) {
+    // When:
+    const std::vector<byte> state = original->saveState();
+
+    // Then: zero page, code, data and vectors
+    EXPECT_EQ(state.size(), 13 + 32 + 4 * 256);
+    EXPECT_EQ(state[4] | (state[5] << 8), Computer::STATE_VERSION);
+}
+
+TEST_F(SaveStateTests, RestoredComputersRunOnTheSame) {
+    // When:
+    ASSERT_TRUE(restored->loadState(original->saveState()));
+
+    // Then:
+    ExpectSameRuns();
+}
+
+TEST_F(SaveStateTests, FilesAreRestoredInPlace) {
+    // Given:
+    ASSERT_TRUE(original->saveState(path));
+    std::unique_ptr<Computer> other(new Computer());
+
+    // When:
+    ASSERT_TRUE(restored->loadState(path));
+    ASSERT_TRUE(other->loadState(path));
+
+    // Then: nothing copied before the first writes
+    EXPECT_EQ(restored->memory.privatePageCount(), 0);
+    EXPECT_EQ(other->memory.privatePageCount(), 0);
+    ExpectSameRuns();
+}
+
+TEST_F(SaveStateTests, SnapshotsAlsoRestoreTheClockAndEvents) {
+    // Given:
+    int fired = 0;
+    original->scheduler.schedule(1500, [&](std::uint64_t) { fired++; });
+    const std::vector<byte> state = original->saveState();
+    const Computer::Snapshot snapshot = original->snapshot(nullptr);
+    original->run(1000);
+    ASSERT_EQ(fired, 1);
+
+    // When:
+    original->restore(snapshot);
+
+    // Then: back to the same state and clock, with the event to fire again
+    EXPECT_EQ(original->saveState(), state);
+    EXPECT_EQ(original->clock, snapshot.clock);
+    EXPECT_EQ(original->scheduler.size(), 1);
+    original->run(1000);
+    EXPECT_EQ(fired, 2);
+}
+
+TEST_F(SaveStateTests, InvalidStatesAreRejected) {
+    // Given:
+    const std::vector<byte> state = original->saveState();
+    std::vector<byte> version = state;
+    version[4]++;
+    std::vector<byte> magic = state;
+    magic[0] = 'X';
+    std::vector<byte> truncated(state.begin(), state.end() - 1);
+    std::vector<byte> longer = state;
+    longer.push_back(0);
+    restored->cpu.A = 0x42;
+
+    // When / Then:
+    EXPECT_FALSE(restored->loadState(version));
+    EXPECT_FALSE(restored->loadState(magic));
+    EXPECT_FALSE(restored->loadState(truncated));
+    EXPECT_FALSE(restored->loadState(longer));
+    EXPECT_FALSE(restored->loadState(std::vector<byte>()));
+    EXPECT_FALSE(restored->loadState(path + ".missing"));
+    EXPECT_EQ(restored->cpu.A, 0x42);
+}
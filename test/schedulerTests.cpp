@@ -0,0 +1,259 @@
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "gtest/gtest.h"
+#include "../src/Computer.h"
+#include "../src/events/Scheduler.h"
+
+class SchedulerTests : public ::testing::Test {
+public:
+    /*
+    * = $2000
+
+    cli
+    loop:
+    inc $80
+    jmp loop
+
+    handler:
+    inc $90
+    sta $D000 ; acknowledges the IRQ
+    rti
+     */
+    static const dword noBytes = 14;
+    const byte program[noBytes] = {0x00, 0x20, 0x58, 0xE6, 0x80, 0x4C, 0x01, 0x20,
+                                   0xE6, 0x90, 0x8D, 0x00, 0xD0, 0x40};
+    static const word HANDLER = 0x2006;
+
+    /// @brief Drops the IRQ line when written to.
+    class AcknowledgeDevice : public Device {
+    public:
+        Computer& computer;
+
+        explicit AcknowledgeDevice(Computer& computer) : computer(computer) {}
+        byte read(word) override { return 0; }
+        void write(word, byte) override { computer.irq(false); }
+    };
+
+    std::unique_ptr<Computer> Load(const byte* bytes, dword size, word handler) const {
+        std::unique_ptr<Computer> computer(new Computer());
+        computer->loadProgram(bytes, size);
+        computer->memory.writeWord(handler, CPU::IRQ_ADRESS);
+        computer->memory.writeWord(handler, CPU::NMI_ADRESS);
+        computer->resetPC();
+        return computer;
+    }
+};
+
+TEST_F(SchedulerTests, EventsRunByTimeThenInTheOrderScheduled) {
+    // Given:
+    Scheduler scheduler;
+    std::vector<int> order;
+    scheduler.schedule(20, [&](std::uint64_t) { order.push_back(3); });
+    scheduler.schedule(10, [&](std::uint64_t) { order.push_back(1); });
+    scheduler.schedule(10, [&](std::uint64_t) { order.push_back(2); });
+    scheduler.schedule(30, [&](std::uint64_t) { order.push_back(4); });
+
+    // When:
+    scheduler.runDue(25);
+
+    // Then:
+    EXPECT_EQ(order, std::vector<int>({1, 2, 3}));
+    EXPECT_EQ(scheduler.next(), 30);
+    EXPECT_EQ(scheduler.size(), 1);
+}
+
+TEST_F(SchedulerTests, CancelledEventsDontRun) {
+    // Given:
+    Scheduler scheduler;
+    int runs = 0;
+    const std::uint64_t first = scheduler.schedule(10, [&](std::uint64_t) { runs++; });
+    scheduler.schedule(20, [&](std::uint64_t) { runs++; });
+
+    // When:
+    const bool cancelled = scheduler.cancel(first);
+
+    // Then:
+    EXPECT_TRUE(cancelled);
+    EXPECT_FALSE(scheduler.cancel(first));
+    EXPECT_EQ(scheduler.next(), 20);
+    scheduler.runDue(100);
+    EXPECT_EQ(runs, 1);
+    EXPECT_EQ(scheduler.next(), Scheduler::NEVER);
+}
+
+TEST_F(SchedulerTests, EventsFireAtTheFirstInstructionBoundaryPastTheirTime) {
+    // Given:
+    std::unique_ptr<Computer> computer = Load(program, noBytes, HANDLER);
+    std::unique_ptr<Computer> reference = Load(program, noBytes, HANDLER);
+    std::vector<std::uint64_t> fired;
+    for (std::uint64_t time : {1, 100, 101, 555}) {
+        computer->scheduler.schedule(time, [&](std::uint64_t due) {
+            EXPECT_GE(computer->clock, due);
+            fired.push_back(computer->clock);
+        });
+    }
+
+    // When:
+    const int cycles = computer->run(1000);
+
+    // Then: the events didn't change the run
+    ASSERT_EQ(fired.size(), 4);
+    EXPECT_LT(fired[0], 1 + 5);
+    EXPECT_LT(fired[1], 100 + 5);
+    EXPECT_LT(fired[3], 555 + 5);
+    EXPECT_EQ(cycles, reference->run(1000));
+    EXPECT_EQ(computer->clock, (std::uint64_t) cycles);
+    EXPECT_EQ(computer->cpu.PC, reference->cpu.PC);
+    EXPECT_EQ(static_cast<const Memory&>(computer->memory)[0x80], static_cast<const Memory&>(reference->memory)[0x80]);
+}
+
+TEST_F(SchedulerTests, TimerInterruptsEveryEngine) {
+    for (Computer::Engine engine : {Computer::Engine::Interpreter, Computer::Engine::Decoded, Computer::Engine::Blocks,
+                                    Computer::Engine::Jit, Computer::Engine::Tiered}) {
+        SCOPED_TRACE((int) engine);
+        // Given: a timer raising the IRQ every 1000 cycles
+        std::unique_ptr<Computer> computer = Load(program, noBytes, HANDLER);
+        AcknowledgeDevice device(*computer);
+        computer->engine = engine;
+        computer->memory.map(0xD0, device);
+        std::function<void(std::uint64_t)> tick = [&](std::uint64_t time) {
+            computer->irq(true);
+            computer->scheduler.schedule(time + 1000, tick);
+        };
+        computer->scheduler.schedule(1000, tick);
+
+        // When:
+        computer->run(10500);
+
+        // Then: every handler ran once and returned where it interrupted
+        const Memory& memory = computer->memory;
+        EXPECT_EQ(memory[0x90], 10);
+        EXPECT_EQ(computer->cpu.SP, 0xFF);
+        EXPECT_FALSE(computer->cpu.flag.I);
+        EXPECT_GE(computer->cpu.PC, 0x2001);
+        EXPECT_LT(computer->cpu.PC, (word) HANDLER);
+        // Each interrupt takes 7 + 5 + 4 + 6 cycles off the 8 cycle loop
+        EXPECT_EQ(memory[0x80], (byte) ((10500 - 10 * 22) / 8));
+    }
+}
+
+TEST_F(SchedulerTests, MaskedIrqWaitsForCli) {
+    /*
+    * = $2000
+
+    sei
+    ldx #$20
+    wait:
+    dex
+    bne wait
+    cli
+    loop:
+    inc $80
+    jmp loop
+
+    handler:
+    inc $90
+    lda $80
+    sta $91
+    sta $D000 ; acknowledges the IRQ
+    rti
+     */
+    const dword maskedBytes = 24;
+    const byte masked[maskedBytes] = {0x00, 0x20, 0x78, 0xA2, 0x20, 0xCA, 0xD0, 0xFD, 0x58, 0xE6, 0x80, 0x4C, 0x07, 0x20,
+                                      0xE6, 0x90, 0xA5, 0x80, 0x85, 0x91, 0x8D, 0x00, 0xD0, 0x40};
+    // Given:
+    std::unique_ptr<Computer> computer = Load(masked, maskedBytes, 0x200C);
+    AcknowledgeDevice device(*computer);
+    computer->memory.map(0xD0, device);
+    computer->scheduler.schedule(10, [&](std::uint64_t) { computer->irq(true); });
+
+    // When:
+    computer->run(1000);
+
+    // Then: taken once, right after the CLI
+    const Memory& memory = computer->memory;
+    EXPECT_EQ(memory[0x90], 1);
+    EXPECT_EQ(memory[0x91], 0);
+    EXPECT_GT(memory[0x80], 0);
+}
+
+TEST_F(SchedulerTests, MaskedIrqKeepsWholeSlices) {
+    /*
+    * = $2000
+
+    sei
+    loop:
+    inc $80
+    jmp loop
+
+    handler:
+    inc $90
+    rti
+     */
+    const dword maskedBytes = 11;
+    const byte masked[maskedBytes] = {0x00, 0x20, 0x78, 0xE6, 0x80, 0x4C, 0x01, 0x20, 0xE6, 0x90, 0x40};
+    // Given: an IRQ held for good while I is set
+    std::unique_ptr<Computer> computer = Load(masked, maskedBytes, 0x2006);
+    std::unique_ptr<Computer> reference = Load(masked, maskedBytes, 0x2006);
+    computer->engine = Computer::Engine::Blocks;
+    reference->engine = Computer::Engine::Interpreter;
+    computer->scheduler.schedule(10, [&](std::uint64_t) { computer->irq(true); });
+    reference->scheduler.schedule(10, [&](std::uint64_t) { reference->irq(true); });
+
+    // When:
+    const int cycles = computer->run(100000);
+
+    // Then: never taken, and the loop still ran whole blocks (sei, then inc and jmp) rather than an instruction at a time
+    const Memory& memory = computer->memory;
+    EXPECT_EQ(cycles, reference->run(100000));
+    EXPECT_EQ(memory[0x90], 0);
+    EXPECT_EQ(memory[0x80], static_cast<const Memory&>(reference->memory)[0x80]);
+    EXPECT_EQ(computer->blockCache.size(), 2);
+}
+
+TEST_F(SchedulerTests, NmiIgnoresTheInterruptMask) {
+    /*
+    * = $2000
+
+    sei
+    loop:
+    inc $80
+    jmp loop
+
+    handler:
+    inc $90
+    rti
+     */
+    const dword nmiBytes = 11;
+    const byte nmiProgram[nmiBytes] = {0x00, 0x20, 0x78, 0xE6, 0x80, 0x4C, 0x01, 0x20, 0xE6, 0x90, 0x40};
+    // Given:
+    std::unique_ptr<Computer> computer = Load(nmiProgram, nmiBytes, 0x2006);
+    computer->scheduler.schedule(100, [&](std::uint64_t) { computer->nmi(); });
+
+    // When:
+    computer->run(1000);
+
+    // Then: the handler ran once and RTI restored I
+    const Memory& memory = computer->memory;
+    EXPECT_EQ(memory[0x90], 1);
+    EXPECT_TRUE(computer->cpu.flag.I);
+    EXPECT_EQ(computer->cpu.SP, 0xFF);
+}
+
+TEST_F(SchedulerTests, CancelStopsAtTheNextCheck) {
+    // Given:
+    std::unique_ptr<Computer> computer = Load(program, noBytes, HANDLER);
+    computer->scheduler.schedule(500, [&](std::uint64_t) { computer->cancel(); });
+
+    // When:
+    const CPU::Result result = computer->execute(100000);
+
+    // Then: right after the event, and only that run
+    EXPECT_EQ(result.stop, CPU::Stop::Cancelled);
+    EXPECT_GE(result.cycles, 500);
+    EXPECT_LT(result.cycles, 505);
+    EXPECT_EQ(result.pc, computer->cpu.PC);
+    EXPECT_EQ(computer->execute(100).stop, CPU::Stop::Budget);
+}
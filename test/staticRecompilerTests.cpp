@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include "gtest/gtest.h"
+#include "../src/Computer.h"
+#include "../src/aot/StaticRecompiler.h"
+
+/// Generated by cpu6502-aot from StaticRecompilerTests::image into recompiledTestProgram.cpp
+CPU::Result runRecompiledTestProgram(CPU& cpu, int cycles, Memory& memory);
+
+class StaticRecompilerTests : public ::testing::Test {
+public:
+    Computer reference;
+    Computer computer;
+
+    void SetUp() override {
+        reference.reset();
+        computer.reset();
+        reference.engine = Computer::Engine::Interpreter;
+    }
+    void TearDown() override {}
+
+    /*
+    * = $2000
+
+    Every legal opcode once, with the stores kept away from the code and the zero page pointers,
+    an inner loop whose branch crosses a page, a subroutine and an indirect jump to code
+    reached from nowhere else (see recompiledTestProgram.cpp for the disassembly)
+     */
+    static const dword noBytes = 284;
+    const byte image[noBytes] = {
+        0x00, 0x20, 0xA2, 0x04, 0x81, 0x20, 0xA1, 0x20, 0x21, 0x20, 0x01, 0x20, 0x41, 0x20, 0x61, 0x20,
+        0xA0, 0x10, 0x91, 0x22, 0xB1, 0x22, 0x31, 0x22, 0x11, 0x22, 0x51, 0x22, 0x71, 0x22, 0xA2, 0xF0,
+        0xBD, 0xF0, 0x30, 0xBC, 0xF0, 0x30, 0x3D, 0xF0, 0x30, 0x1D, 0xF0, 0x30, 0x5D, 0xF0, 0x30, 0x7D,
+        0xF0, 0x30, 0xA0, 0xE0, 0xB9, 0xF0, 0x30, 0xBE, 0xF0, 0x30, 0x39, 0xF0, 0x30, 0x19, 0xF0, 0x30,
+        0x59, 0xF0, 0x30, 0x79, 0xF0, 0x30, 0xA2, 0x05, 0xA0, 0x06, 0x95, 0xF0, 0x94, 0xF0, 0x96, 0xF0,
+        0xB5, 0xF0, 0xB4, 0xF0, 0xB6, 0xF0, 0xA2, 0x05, 0x35, 0xF0, 0x15, 0xF0, 0x55, 0xF0, 0x75, 0xF0,
+        0xF6, 0xF0, 0xD6, 0xF0, 0xE6, 0xF2, 0xC6, 0xF3, 0xEE, 0x00, 0x31, 0xCE, 0x01, 0x31, 0xFE, 0x00,
+        0x31, 0xDE, 0x00, 0x31, 0x8D, 0x00, 0x30, 0x8E, 0x01, 0x30, 0x8C, 0x02, 0x30, 0x9D, 0x00, 0x30,
+        0x99, 0x00, 0x30, 0xAD, 0x00, 0x30, 0xAE, 0x01, 0x30, 0xAC, 0x02, 0x30, 0x2D, 0x00, 0x30, 0x0D,
+        0x00, 0x30, 0x4D, 0x00, 0x30, 0x6D, 0x00, 0x30, 0x2C, 0x00, 0x30, 0x85, 0xF4, 0x86, 0xF5, 0x84,
+        0xF6, 0xA5, 0xF4, 0xA6, 0xF5, 0xA4, 0xF6, 0x25, 0xF4, 0x05, 0xF4, 0x45, 0xF4, 0x65, 0xF4, 0x24,
+        0xF4, 0xA5, 0xF7, 0xA2, 0x12, 0xA0, 0x34, 0xA9, 0xC3, 0x29, 0xF0, 0x09, 0x0F, 0x49, 0xAA, 0x69,
+        0x33, 0xAA, 0xA8, 0x8A, 0x98, 0xBA, 0x9A, 0xE8, 0xC8, 0xCA, 0x88, 0x18, 0x38, 0xD8, 0xF8, 0x58,
+        0x78, 0xB8, 0xEA, 0x20, 0x0E, 0x21, 0x48, 0x08, 0x68, 0x28, 0x90, 0x01, 0xEA, 0xB0, 0x01, 0xEA,
+        0xF0, 0x01, 0xEA, 0xD0, 0x01, 0xEA, 0x30, 0x01, 0xEA, 0x10, 0x01, 0xEA, 0x50, 0x01, 0xEA, 0x70,
+        0x01, 0xEA, 0xA2, 0x08, 0xEA, 0xEA, 0xEA, 0xEA, 0xEA, 0xEA, 0xEA, 0xEA, 0xEA, 0xEA, 0xEA, 0xCA,
+        0xD0, 0xFD, 0xE6, 0xF7, 0xA5, 0xF7, 0x29, 0x03, 0xF0, 0x03, 0x4C, 0x00, 0x20, 0x6C, 0x18, 0x21,
+        0xA5, 0xF8, 0x69, 0x01, 0x60, 0xE6, 0xF8, 0x4C, 0x00, 0x20, 0x13, 0x21};
+
+    /// @brief Pseudo random memory and registers, with the zero page pointing the indirect stores at $4040.
+    void LoadImage(unsigned seed) {
+        unsigned state = seed * 2654435761u;
+        for (dword address = 0; address < 0xFFFA; address++) {
+            state = state * 1103515245u + 12345u;
+            reference.memory[address] = computer.memory[address] = address < 0x100 ? 0x40 : (byte) (state >> 16);
+        }
+        for (Computer* target : {&reference, &computer}) {
+            target->loadProgram(image, noBytes);
+            target->resetPC();
+            target->cpu.SP = (byte) (state >> 24);
+            target->cpu.A = (byte) (state >> 8);
+            target->cpu.X = (byte) (state >> 4);
+            target->cpu.Y = (byte) (state >> 12);
+            target->cpu.status = (byte) (state >> 20) & CPU::STATUS_MASK;
+        }
+    }
+
+    void ExpectSameState() const {
+        EXPECT_EQ(computer.cpu.PC, reference.cpu.PC);
+        EXPECT_EQ(computer.cpu.SP, reference.cpu.SP);
+        EXPECT_EQ(computer.cpu.A, reference.cpu.A);
+        EXPECT_EQ(computer.cpu.X, reference.cpu.X);
+        EXPECT_EQ(computer.cpu.Y, reference.cpu.Y);
+        EXPECT_EQ(computer.cpu.status, reference.cpu.status);
+        for (dword address = 0; address <= 0xFFFF; address++) {
+            if (computer.memory[address] != reference.memory[address]) {
+                ADD_FAILURE() << "Memory differs at 0x" << std::hex << address;
+                return;
+            }
+        }
+    }
+};
+
+TEST_F(StaticRecompilerTests, DiscoversTheBlocksReachableFromTheResetVector) {
+    // When:
+    StaticRecompiler recompiler(image, noBytes);
+
+    // Then:
+    const std::vector<StaticRecompiler::Block>& blocks = recompiler.blocks();
+    ASSERT_EQ(blocks.size(), 23);
+    EXPECT_EQ(blocks.front().start, 0x2000);
+    EXPECT_EQ(blocks.front().end, 0x20D4); // Ends at jsr, the return address starts the next block
+    auto loop = std::find_if(blocks.begin(), blocks.end(), [](const StaticRecompiler::Block& block) { return block.start == 0x20FD; });
+    ASSERT_NE(loop, blocks.end());
+    EXPECT_EQ(loop->instructions, std::vector<word>({0x20FD, 0x20FE}));
+    EXPECT_EQ(loop->worstCycles, 2);
+    for (const StaticRecompiler::Block& block : blocks) {
+        EXPECT_NE(block.start, 0x2113); // Only reached through the vector of jmp ($2118)
+    }
+}
+
+TEST_F(StaticRecompilerTests, GeneratedSourceIsUpToDate) {
+    // Given:
+    StaticRecompiler recompiler(image, noBytes);
+    recompiler.functionName = "runRecompiledTestProgram";
+    recompiler.runtimeHeader = "../src/aot/AotRuntime.h";
+    std::string path = __FILE__;
+    path = path.substr(0, path.find_last_of("/\\") + 1) + "recompiledTestProgram.cpp";
+    std::ifstream file(path, std::ios::binary);
+    ASSERT_TRUE(file.good()) << path;
+
+    // When:
+    std::string generated((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    generated.erase(std::remove(generated.begin(), generated.end(), '\r'), generated.end());
+
+    // Then:
+    EXPECT_EQ(generated, recompiler.translate());
+}
+
+TEST_F(StaticRecompilerTests, RecompiledProgramMatchesInterpreter) {
+    for (unsigned seed = 0; seed < 4; seed++) {
+        SCOPED_TRACE(::testing::Message() << "seed " << seed);
+        // Given:
+        LoadImage(seed);
+
+        // When / Then:
+        for (int cycles : {1, 7, 100, 2567, 10000, 100000}) {
+            EXPECT_EQ(runRecompiledTestProgram(computer.cpu, cycles, computer.memory).cycles, reference.run(cycles));
+            ExpectSameState();
+        }
+    }
+}
+
+TEST_F(StaticRecompilerTests, IndirectJumpsFallBackToTheInterpreter) {
+    // Given:
+    LoadImage(0);
+    const byte entries = computer.memory[0x00F8];
+
+    // When:
+    int cyclesExecuted = runRecompiledTestProgram(computer.cpu, 20000, computer.memory).cycles;
+
+    // Then: the code only reached through the vector ran
+    EXPECT_EQ(cyclesExecuted, reference.run(20000));
+    EXPECT_NE(computer.memory[0x00F8], entries);
+    ExpectSameState();
+}
@@ -0,0 +1,78 @@
+#include <memory>
+#include <type_traits>
+#include "gtest/gtest.h"
+#include "../src/Computer.h"
+#include "../src/cpu/Opcodes.h"
+#include "../src/cpu/Stats.h"
+
+class StatsTests : public ::testing::Test {
+public:
+    /*
+    * = $2000
+
+    ldx #$08
+    loop:
+    lda $20FF,X ; crosses a page
+    pha
+    dex
+    bne loop
+    jsr done
+    done:
+    jmp done
+     */
+    static const dword noBytes = 17;
+    const byte program[noBytes] = {0x00, 0x20, 0xA2, 0x08, 0xBD, 0xFF, 0x20, 0x48, 0xCA, 0xD0, 0xF9,
+                                   0x20, 0x0C, 0x20, 0x4C, 0x0C, 0x20};
+};
+
+TEST_F(StatsTests, DisabledStatsTakeNoSpace) {
+    EXPECT_TRUE(std::is_empty<StatsPolicy<false>>::value);
+}
+
+TEST_F(StatsTests, TotalsComeFromTheOpcodeCounts) {
+    // Given:
+    Stats stats;
+    stats.opcodes[CPU::ldaAbX] = 5;
+    stats.opcodes[CPU::ldaAbs] = 2;
+    stats.opcodes[CPU::bneRel] = 7;
+    stats.opcodes[CPU::beqRel] = 3;
+    stats.opcodes[0x02] = 1;
+    stats.branchesTaken = 6;
+    stats.lowestSP = 0xF0;
+
+    // Then:
+    EXPECT_EQ(stats.executions(AddressingMode::AbsoluteX), 5);
+    EXPECT_EQ(stats.executions(AddressingMode::Absolute), 2);
+    EXPECT_EQ(stats.instructions(), 17);
+    EXPECT_EQ(stats.branches(), 10);
+    EXPECT_EQ(stats.branchesNotTaken(), 4);
+    EXPECT_EQ(stats.maxStackDepth(), 0x0F);
+}
+
+#if CPU6502_STATS
+TEST_F(StatsTests, EveryEngineCountsTheSame) {
+    for (Computer::Engine engine : {Computer::Engine::Interpreter, Computer::Engine::Decoded, Computer::Engine::Blocks,
+                                    Computer::Engine::Jit, Computer::Engine::Tiered}) {
+        SCOPED_TRACE((int) engine);
+        // Given:
+        std::unique_ptr<Computer> computer(new Computer());
+        computer->engine = engine;
+        computer->loadProgram(program, noBytes);
+        computer->resetPC();
+
+        // When: up to the first jmp
+        const int ran = computer->run(2 + 7 * 13 + 12 + 6 + 3);
+
+        // Then:
+        const Stats& stats = computer->cpu.stats;
+        EXPECT_EQ(stats.opcodes[CPU::ldaAbX], 8);
+        EXPECT_EQ(stats.opcodes[CPU::jmpAbs], 1);
+        EXPECT_EQ(stats.instructions(), 1 + 8 * 4 + 2);
+        EXPECT_EQ(stats.pageCrossings, 8);
+        EXPECT_EQ(stats.branchesTaken, 7);
+        EXPECT_EQ(stats.branchesNotTaken(), 1);
+        EXPECT_EQ(stats.maxStackDepth(), 8 + 2);
+        EXPECT_EQ(stats.cycles, ran);
+    }
+}
+#endif
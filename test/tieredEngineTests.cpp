@@ -0,0 +1,120 @@
+#include "gtest/gtest.h"
+#include "../src/Computer.h"
+
+class TieredEngineTests : public ::testing::Test {
+public:
+    Computer computer;
+
+    void SetUp() override {
+        computer.reset();
+        computer.engine = Computer::Engine::Tiered;
+    }
+    void TearDown() override {}
+
+    /*
+    * = $2000
+
+    ldx #$00
+    loop:
+    inc $80
+    inx
+    bne loop
+    jmp *
+     */
+    static const dword noBytes = 12;
+    const byte program[noBytes] = {0x00, 0x20, 0xA2, 0x00, 0xE6, 0x80, 0xE8, 0xD0, 0xFB, 0x4C, 0x09, 0x20};
+    static const int CYCLES_PER_LOOP = 5 + 2 + 3;
+};
+
+TEST_F(TieredEngineTests, ColdCodeStaysInTheInterpreter) {
+    // Given:
+    computer.memory[0x1000] = CPU::ldaImm;
+    computer.memory[0x1001] = 0x01;
+    computer.memory[0x1002] = CPU::ldxImm;
+    computer.memory[0x1003] = 0x02;
+
+    // When:
+    int cyclesExecuted = computer.run(4);
+
+    // Then:
+    EXPECT_EQ(cyclesExecuted, 4);
+    EXPECT_EQ(computer.cpu.X, 0x02);
+    EXPECT_EQ(computer.tiered.counters.interpreted, 2);
+    EXPECT_EQ(computer.tiered.counters.blockRuns, 0);
+    EXPECT_EQ(computer.blockCache.size(), 0);
+}
+
+TEST_F(TieredEngineTests, ColdCodeStopsAtUnimplementedOpcodes) {
+    // Given:
+    computer.memory[0x1000] = CPU::ldaImm;
+    computer.memory[0x1001] = 0x01;
+    computer.memory[0x1002] = 0x02; // JAM
+
+    // When:
+    const CPU::Result result = computer.execute(1000);
+
+    // Then:
+    EXPECT_EQ(result.stop, CPU::Stop::Halt);
+    EXPECT_EQ(result.cycles, 2);
+    EXPECT_EQ(result.pc, 0x1002);
+    EXPECT_EQ(computer.cpu.A, 0x01);
+    EXPECT_EQ(computer.tiered.counters.interpreted, 1);
+}
+
+TEST_F(TieredEngineTests, WarmCodeMovesToTheBlockCache) {
+    // Given:
+    computer.tiered.warmThreshold = 2;
+    computer.tiered.hotThreshold = 1000;
+
+    // When:
+    computer.loadProgram(program, noBytes);
+    computer.resetPC();
+    int cyclesExecuted = computer.run(2 + CYCLES_PER_LOOP * 10);
+
+    // Then:
+    EXPECT_EQ(cyclesExecuted, 2 + CYCLES_PER_LOOP * 10);
+    EXPECT_EQ(computer.memory[0x0080], 10);
+    // The first two passes are interpreted, the first one along with ldx
+    EXPECT_EQ(computer.tiered.heat(0x2002), 9);
+    EXPECT_EQ(computer.tiered.counters.interpreted, 4 + 3);
+    EXPECT_EQ(computer.tiered.counters.blockRuns, 8);
+    EXPECT_EQ(computer.tiered.counters.nativeRuns, 0);
+    EXPECT_EQ(computer.jit.size(), 0);
+}
+
+TEST_F(TieredEngineTests, HotCodeIsCompiled) {
+    // Given:
+    computer.tiered.warmThreshold = 2;
+    computer.tiered.hotThreshold = 4;
+
+    // When:
+    computer.loadProgram(program, noBytes);
+    computer.resetPC();
+    int cyclesExecuted = computer.run(2 + CYCLES_PER_LOOP * 0x100);
+
+    // Then:
+    // The last bne isn't taken and the budget left starts the jmp
+    EXPECT_EQ(cyclesExecuted, 2 + CYCLES_PER_LOOP * 0x100 - 1 + 3);
+    EXPECT_EQ(computer.memory[0x0080], 0x00);
+    EXPECT_EQ(computer.cpu.PC, 0x2009);
+    if (Jit::isSupported()) {
+        EXPECT_GT(computer.tiered.counters.nativeRuns, 0);
+        EXPECT_EQ(computer.jit.size(), 1);
+    } else {
+        EXPECT_EQ(computer.tiered.counters.nativeRuns, 0);
+    }
+}
+
+TEST_F(TieredEngineTests, ClearingStartsOverCold) {
+    // Given:
+    computer.loadProgram(program, noBytes);
+    computer.resetPC();
+    computer.run(CYCLES_PER_LOOP * 10);
+
+    // When:
+    computer.tiered.clear();
+
+    // Then:
+    EXPECT_EQ(computer.tiered.heat(0x2002), 0);
+    EXPECT_EQ(computer.tiered.counters.interpreted, 0);
+}
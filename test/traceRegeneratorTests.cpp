@@ -0,0 +1,221 @@
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "../src/Computer.h"
+#include "../src/trace/Checkpoints.h"
+#include "../src/trace/Trace.h"
+#include "../src/trace/TraceRecorder.h"
+#include "../src/trace/TraceRegenerator.h"
+
+class TraceRegeneratorTests : public ::testing::Test {
+public:
+    /*
+    * = $2000
+
+    loop:
+    inx
+    txa
+    sta $0300,X
+    adc #$07
+    sta $0400,Y
+    iny
+    jmp loop
+     */
+    static const dword noBytes = 16;
+    const byte program[noBytes] = {0x00, 0x20, 0xE8, 0x8A, 0x9D, 0x00, 0x03, 0x69, 0x07, 0x99, 0x00, 0x04,
+                                   0xC8, 0x4C, 0x00, 0x20};
+    std::string path;
+    std::unique_ptr<Computer> computer;
+
+    void SetUp() override {
+        path = ::testing::TempDir() + "traceRegeneratorTests";
+        computer.reset(new Computer());
+        computer->loadProgram(program, noBytes);
+        computer->resetPC();
+    }
+
+    void TearDown() override {
+        std::remove(path.c_str());
+        std::remove((path + ".live").c_str());
+    }
+
+    static std::vector<TraceRecord> read(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        TraceReader reader(file);
+        EXPECT_TRUE(reader.isValid());
+        std::vector<TraceRecord> records;
+        TraceRecord record;
+        while (reader.next(record)) records.push_back(record);
+        return records;
+    }
+
+    static bool same(const TraceRecord& first, const TraceRecord& second) {
+        return first.kind == second.kind && first.value == second.value && first.address == second.address &&
+               first.A == second.A && first.X == second.X && first.Y == second.Y && first.SP == second.SP &&
+               first.status == second.status && first.lost == second.lost;
+    }
+};
+
+TEST_F(TraceRegeneratorTests, CheckpointsComeEveryInterval) {
+    // Given:
+    CheckpointRecorder recorder(*computer, 1000);
+
+    // When: instructions run past every due clock, by less than the longest one
+    const int ran = recorder.run(10000);
+
+    // Then:
+    const std::vector<Checkpoint>& checkpoints = recorder.checkpoints();
+    ASSERT_EQ(checkpoints.size(), 10);
+    EXPECT_EQ(checkpoints[0].clock, 0);
+    EXPECT_EQ(checkpoints[0].PC, 0x2000);
+    for (std::size_t index = 1; index < checkpoints.size(); index++) {
+        EXPECT_GE(checkpoints[index].clock, checkpoints[index - 1].clock + 1000);
+        EXPECT_LT(checkpoints[index].clock, checkpoints[index - 1].clock + 1000 + 7);
+    }
+    EXPECT_LT(checkpoints.back().clock, (std::uint64_t) ran);
+
+    // When: the rest of the run
+    recorder.checkpoint();
+
+    // Then:
+    ASSERT_EQ(checkpoints.size(), 11);
+    EXPECT_EQ(checkpoints.back().clock, (std::uint64_t) ran);
+    EXPECT_TRUE(checkpoints.back().matches(*computer));
+    EXPECT_FALSE(checkpoints[5].matches(*computer));
+}
+
+TEST_F(TraceRegeneratorTests, RestoredCheckpointsRunLikeTheOriginal) {
+    // Given:
+    CheckpointRecorder recorder(*computer, 1000);
+    recorder.run(5000);
+    const std::vector<Checkpoint>& checkpoints = recorder.checkpoints();
+    std::unique_ptr<Computer> other(new Computer());
+
+    // When:
+    checkpoints[2].restore(*other);
+    other->run((int) (checkpoints[3].clock - checkpoints[2].clock));
+
+    // Then:
+    EXPECT_TRUE(checkpoints[3].matches(*other));
+}
+
+TEST_F(TraceRegeneratorTests, SavedCheckpointsLoadBack) {
+    // Given:
+    CheckpointRecorder recorder(*computer, 1000);
+    recorder.run(5000);
+    const std::vector<Checkpoint>& checkpoints = recorder.checkpoints();
+    ASSERT_TRUE(saveCheckpoints(path, checkpoints));
+
+    // When:
+    std::vector<Checkpoint> loaded;
+    ASSERT_TRUE(loadCheckpoints(path, loaded));
+
+    // Then:
+    ASSERT_EQ(loaded.size(), checkpoints.size());
+    std::unique_ptr<Computer> other(new Computer());
+    for (std::size_t index = 0; index < loaded.size(); index++) {
+        SCOPED_TRACE(index);
+        EXPECT_EQ(loaded[index].clock, checkpoints[index].clock);
+        checkpoints[index].restore(*other);
+        EXPECT_TRUE(loaded[index].matches(*other));
+    }
+    EXPECT_FALSE(loadCheckpoints(path + ".missing", loaded));
+    EXPECT_EQ(loaded.size(), checkpoints.size());
+}
+
+TEST_F(TraceRegeneratorTests, CheckpointsOnlyKeepTheirOwnPages) {
+    // Given: more checkpoints than a chain of images could free recursively
+    std::weak_ptr<const Memory::Image> first;
+    std::shared_ptr<const Memory::Image> last;
+    {
+        CheckpointRecorder recorder(*computer, 10);
+        while (recorder.checkpoints().size() < 100000) recorder.run(10000);
+        first = recorder.checkpoints().front().memory;
+        last = recorder.checkpoints().back().memory;
+
+        // When: the recorder and every checkpoint but the last go
+    }
+
+    // Then: the last image doesn't keep the ones before alive, and still holds its pages
+    EXPECT_TRUE(first.expired());
+    std::unique_ptr<Computer> other(new Computer());
+    other->memory.load(last);
+    EXPECT_EQ(static_cast<const Memory&>(other->memory)[0x2000], 0xE8);
+    EXPECT_EQ(last->storedPages(), 4);
+}
+
+#if CPU6502_TRACE
+TEST_F(TraceRegeneratorTests, RegeneratedTracesAreTheLiveOne) {
+    // Given: a run traced live and checkpointed
+    TraceRecorder live(path + ".live", TraceRecorder::DEFAULT_CAPACITY, true);
+    computer->cpu.tracer = &live;
+    CheckpointRecorder recorder(*computer, 1000);
+    recorder.run(20000);
+    recorder.checkpoint();
+    computer->cpu.tracer = nullptr;
+    ASSERT_TRUE(live.close());
+    TraceRegenerator regenerator(recorder.checkpoints(), 4);
+
+    // When:
+    ASSERT_TRUE(regenerator.regenerate(path));
+
+    // Then:
+    const std::vector<TraceRecord> expected = read(path + ".live");
+    const std::vector<TraceRecord> regenerated = read(path);
+    EXPECT_TRUE(regenerator.diverged().empty());
+    ASSERT_EQ(regenerated.size(), expected.size());
+    for (std::size_t index = 0; index < expected.size(); index++) {
+        ASSERT_TRUE(same(expected[index], regenerated[index])) << index;
+    }
+}
+
+TEST_F(TraceRegeneratorTests, WindowsOnlyRegenerateTheirIntervals) {
+    // Given:
+    CheckpointRecorder recorder(*computer, 1000);
+    recorder.run(10000);
+    const std::vector<Checkpoint> checkpoints = recorder.checkpoints();
+    TraceRegenerator regenerator(checkpoints, 2);
+
+    // When: from the middle of the 4th interval to the middle of the 6th
+    ASSERT_TRUE(regenerator.regenerateWindow(path, checkpoints[3].clock + 500, checkpoints[5].clock + 500));
+
+    // Then:
+    const std::vector<TraceRecord> records = read(path);
+    ASSERT_FALSE(records.empty());
+    EXPECT_EQ(records.front().kind, TraceRecord::Kind::Instruction);
+    EXPECT_EQ(records.front().address, checkpoints[3].PC);
+    EXPECT_EQ(records.front().X, checkpoints[3].X);
+    std::size_t instructions = 0;
+    for (const TraceRecord& record : records) instructions += record.kind == TraceRecord::Kind::Instruction;
+    // 7 instructions, 21 cycles a loop
+    EXPECT_NEAR(instructions, 3000 / 3, 7);
+}
+
+TEST_F(TraceRegeneratorTests, IntervalsWithEventsDiverge) {
+    // Given: an event the checkpoints don't capture
+    computer->scheduler.schedule(2500, [this](std::uint64_t) { computer->memory[0x0500] = 0x42; });
+    CheckpointRecorder recorder(*computer, 1000);
+    recorder.run(5000);
+    TraceRegenerator regenerator(recorder.checkpoints(), 2);
+
+    // When:
+    ASSERT_TRUE(regenerator.regenerate(path));
+
+    // Then:
+    EXPECT_EQ(regenerator.diverged(), std::vector<std::size_t>({2}));
+}
+#else
+TEST_F(TraceRegeneratorTests, OnlyTraceBuildsRegenerate) {
+    // Given:
+    CheckpointRecorder recorder(*computer, 1000);
+    recorder.run(5000);
+    TraceRegenerator regenerator(recorder.checkpoints(), 2);
+
+    // Then:
+    EXPECT_FALSE(TraceRegenerator::isSupported());
+    EXPECT_FALSE(regenerator.regenerate(path));
+}
+#endif
@@ -0,0 +1,183 @@
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "../src/Computer.h"
+#include "../src/trace/Trace.h"
+#include "../src/trace/TraceRecorder.h"
+
+class TraceTests : public ::testing::Test {
+public:
+    /*
+    * = $2000
+
+    ldx #$03
+    loop:
+    txa
+    sta $0200,X
+    pha
+    dex
+    bne loop
+    jsr sub
+    done:
+    jmp done
+    sub:
+    rts
+     */
+    static const dword noBytes = 19;
+    const byte program[noBytes] = {0x00, 0x20, 0xA2, 0x03, 0x8A, 0x9D, 0x00, 0x02, 0x48, 0xCA, 0xD0, 0xF8,
+                                   0x20, 0x10, 0x20, 0x4C, 0x0D, 0x20, 0x60};
+    std::string path;
+
+    void SetUp() override {
+        path = ::testing::TempDir() + "traceTests.trace";
+    }
+
+    void TearDown() override { std::remove(path.c_str()); }
+
+    static std::vector<TraceRecord> read(std::istream& input) {
+        TraceReader reader(input);
+        EXPECT_TRUE(reader.isValid());
+        std::vector<TraceRecord> records;
+        TraceRecord record;
+        while (reader.next(record)) records.push_back(record);
+        return records;
+    }
+
+    static void expectSame(const TraceRecord& expected, const TraceRecord& actual) {
+        EXPECT_EQ(expected.kind, actual.kind);
+        EXPECT_EQ(expected.value, actual.value);
+        EXPECT_EQ(expected.address, actual.address);
+        EXPECT_EQ(expected.A, actual.A);
+        EXPECT_EQ(expected.X, actual.X);
+        EXPECT_EQ(expected.Y, actual.Y);
+        EXPECT_EQ(expected.SP, actual.SP);
+        EXPECT_EQ(expected.status, actual.status);
+        EXPECT_EQ(expected.lost, actual.lost);
+    }
+};
+
+TEST_F(TraceTests, RecordsSurviveTheFileFormat) {
+    // Given:
+    using Kind = TraceRecord::Kind;
+    const std::vector<TraceRecord> records = {
+            {Kind::Instruction, 0xA2, 0x2000, 0x00, 0x00, 0x00, 0xFF, 0x20, 0},
+            {Kind::Instruction, 0x9D, 0x2002, 0x00, 0x03, 0x00, 0xFF, 0x20, 0},
+            {Kind::Write,       0x00, 0x0203, 0, 0, 0, 0, 0, 0},
+            {Kind::Instruction, 0xD0, 0x2005, 0x00, 0x03, 0x00, 0xFF, 0x20, 0},
+            {Kind::Instruction, 0x9D, 0x2002, 0x00, 0x02, 0x00, 0xFF, 0x20, 0},
+            {Kind::Write,       0x00, 0x0202, 0, 0, 0, 0, 0, 0},
+            {Kind::Interrupt,   0x00, 0x2005, 0x00, 0x02, 0x00, 0xFF, 0x20, 0},
+            {Kind::Write,       0x20, 0x01FE, 0, 0, 0, 0, 0, 0},
+            {Kind::Write,       0x05, 0x01FF, 0, 0, 0, 0, 0, 0},
+            {Kind::Gap,         0x00, 0x0000, 0, 0, 0, 0, 0, 1000},
+            {Kind::Instruction, 0x40, 0x3000, 0x11, 0x22, 0x33, 0xFC, 0x24, 0},
+    };
+
+    // When:
+    std::vector<byte> bytes;
+    TraceWriter writer;
+    TraceWriter::header(bytes);
+    for (const TraceRecord& record : records) writer.encode(record, bytes);
+    std::istringstream input(std::string(bytes.begin(), bytes.end()));
+
+    // Then:
+    const std::vector<TraceRecord> decoded = read(input);
+    ASSERT_EQ(decoded.size(), records.size());
+    for (std::size_t index = 0; index < records.size(); index++) {
+        SCOPED_TRACE(index);
+        expectSame(records[index], decoded[index]);
+    }
+}
+
+TEST_F(TraceTests, StraightLineCodeTakesTwoBytesAnInstruction) {
+    // Given:
+    std::vector<byte> bytes;
+    TraceWriter writer;
+
+    // When: NOPs, one after the other
+    for (word pc = 0x2000; pc < 0x2100; pc++) {
+        writer.encode({TraceRecord::Kind::Instruction, CPU::nop, pc, 0, 0, 0, 0, 0, 0}, bytes);
+    }
+
+    // Then: the first one jumped there
+    EXPECT_EQ(bytes.size(), 0x100 * 2 + 3);
+}
+
+TEST_F(TraceTests, FullRingsDropRecordsInsteadOfWaiting) {
+    // Given:
+    const dword pushed = 200000;
+    std::unique_ptr<TraceRecorder> recorder(new TraceRecorder(path, 16));
+    ASSERT_TRUE(recorder->isOpen());
+
+    // When:
+    for (dword index = 0; index < pushed; index++) recorder->instruction((word) index, CPU::nop, 0, 0, 0, 0, 0);
+    const std::uint64_t dropped = recorder->droppedRecords();
+    ASSERT_TRUE(recorder->close());
+
+    // Then: every record pushed is in the file, in order, or counted in a gap
+    std::ifstream file(path, std::ios::binary);
+    const std::vector<TraceRecord> records = read(file);
+    std::uint64_t instructions = 0, lost = 0;
+    dword expected = 0;
+    for (const TraceRecord& record : records) {
+        if (record.kind == TraceRecord::Kind::Gap) {
+            lost += record.lost;
+            expected += record.lost;
+        } else {
+            ASSERT_EQ(record.address, (word) expected);
+            instructions++;
+            expected++;
+        }
+    }
+    EXPECT_EQ(instructions + lost, pushed);
+    EXPECT_EQ(lost, dropped);
+}
+
+TEST_F(TraceTests, FilesThatCantBeCreatedArentOpen) {
+    // When:
+    TraceRecorder recorder(path + ".missing/trace");
+
+    // Then:
+    EXPECT_FALSE(recorder.isOpen());
+    EXPECT_FALSE(recorder.close());
+}
+
+#if CPU6502_TRACE
+TEST_F(TraceTests, EveryEngineTracesTheSame) {
+    std::vector<TraceRecord> first;
+    for (Computer::Engine engine : {Computer::Engine::Interpreter, Computer::Engine::Decoded, Computer::Engine::Blocks,
+                                    Computer::Engine::Jit, Computer::Engine::Tiered}) {
+        SCOPED_TRACE((int) engine);
+        // Given:
+        std::unique_ptr<Computer> computer(new Computer());
+        computer->engine = engine;
+        computer->loadProgram(program, noBytes);
+        computer->resetPC();
+        TraceRecorder recorder(path);
+        computer->cpu.tracer = &recorder;
+
+        // When: up to the first jmp
+        computer->run(2 + 15 * 2 + 14 + 6 + 6 + 3);
+        ASSERT_TRUE(recorder.close());
+
+        // Then:
+        std::ifstream file(path, std::ios::binary);
+        const std::vector<TraceRecord> records = read(file);
+        ASSERT_EQ(records.size(), 19 + 3 + 3 + 2);
+        expectSame({TraceRecord::Kind::Instruction, CPU::ldxImm, 0x2000, 0, 0, 0, 0xFF, 0, 0}, records[0]);
+        expectSame({TraceRecord::Kind::Instruction, CPU::staAbX, 0x2003, 3, 3, 0, 0xFF, 0, 0}, records[2]);
+        expectSame({TraceRecord::Kind::Write, 3, 0x0203, 0, 0, 0, 0, 0, 0}, records[3]);
+        expectSame({TraceRecord::Kind::Write, 3, 0x01FF, 0, 0, 0, 0, 0, 0}, records[5]);
+        expectSame({TraceRecord::Kind::Instruction, CPU::jmpAbs, 0x200D, 1, 0, 0, 0xFC, CPU::FLAG_Z, 0}, records.back());
+        if (first.empty()) first = records;
+        for (std::size_t index = 0; index < records.size(); index++) {
+            SCOPED_TRACE(index);
+            expectSame(first[index], records[index]);
+        }
+    }
+}
+#endif